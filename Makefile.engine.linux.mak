@@ -3,11 +3,22 @@ OBJ_DIR := obj
 
 ASSEMBLY := engine
 EXTENSION := .so
-COMPILER_FLAGS := -g -Werror=vla -Wno-missing-braces -Wno-format-security -fdeclspec -fPIC --std=c++17
+COMPILER_FLAGS := -g -pthread -Werror=vla -Wno-missing-braces -Wno-format-security -fdeclspec -fPIC --std=c++17
 INCLUDE_FLAGS := -Iengine/source -I$(VULKAN_SDK)/include
-LINKER_FLAGS := -g -shared -lvulkan -lxcb -lX11 -lX11-xcb -lxkbcommon -L$(VULKAN_SDK)/lib -L/usr/X11R6/lib
+LINKER_FLAGS := -g -shared -pthread -lvulkan -lxcb -lX11 -lX11-xcb -lxkbcommon -L$(VULKAN_SDK)/lib -L/usr/X11R6/lib
 DEFINES := -DMEXPORT
 
+# make RAW_MOUSE_INPUT=1 reads unaccelerated mouse motion through XInput2
+ifeq ($(RAW_MOUSE_INPUT),1)
+DEFINES += -DMLOK_RAW_MOUSE_INPUT
+LINKER_FLAGS += -lxcb-xinput
+endif
+
+# make PROFILE=1 compiles in the MLOK_PROFILE_* zones and writes a Chrome trace on exit
+ifeq ($(PROFILE),1)
+DEFINES += -DMLOK_PROFILE
+endif
+
 # Make does not offer a recursive wildcard function, so here's one:
 #rwildcard=$(wildcard $1$2) $(foreach d,$(wildcard $1*),$(call rwildcard,$d/,$2))
 
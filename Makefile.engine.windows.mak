@@ -9,6 +9,16 @@ INCLUDE_FLAGS := -Iengine\source -I$(VULKAN_SDK)\include
 LINKER_FLAGS := -g -shared -luser32 -lvulkan-1 -L$(VULKAN_SDK)\Lib -L$(OBJ_DIR)\engine
 DEFINES := -DMEXPORT -D_CRT_SECURE_NO_WARNINGS
 
+# make RAW_MOUSE_INPUT=1 reads unaccelerated mouse motion through WM_INPUT
+ifeq ($(RAW_MOUSE_INPUT),1)
+DEFINES += -DMLOK_RAW_MOUSE_INPUT
+endif
+
+# make PROFILE=1 compiles in the MLOK_PROFILE_* zones and writes a Chrome trace on exit
+ifeq ($(PROFILE),1)
+DEFINES += -DMLOK_PROFILE
+endif
+
 # Make does not offer a recursive wildcard function, so here's one:
 rwildcard=$(wildcard $1$2) $(foreach d,$(wildcard $1*),$(call rwildcard,$d/,$2))
 
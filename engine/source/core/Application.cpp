@@ -4,11 +4,13 @@
 #include "core/Event.h"
 #include "core/Logger.h"
 #include "core/Input.h"
+#include "core/StartupGraph.h"
+#include "core/JobBenchmark.h"
+#include "core/Task.h"
 
 #include "renderer/RendererFrontend.h"
 
 bool ApplicationOnEvent(uint16_t Code, void* Sender, void* ListenerInst, EventContext Context);
-bool ApplicationOnKey(uint16_t Code, void* Sender, void* ListenerInst, EventContext Context);
 bool ApplicationOnResized(uint16_t Code, void* Sender, void* ListenerInst, EventContext Context);
 
 bool Application::Create(const ApplicationConfig& Config)
@@ -16,48 +18,198 @@ bool Application::Create(const ApplicationConfig& Config)
     State.bIsRunning = false;
     State.bIsSuspended = false;
 
-    const uint64_t SystemAllocatorTotalSize = 32 * 1024 * 1024; // Should be more than enough
-    SubsystemsAllocator = std::make_unique<MlokLinearAllocator>(nullptr, SystemAllocatorTotalSize, MEMORY_TAG_LINEAR_ALLOCATOR);
+    if (Config.TickRate == 0)
+    {
+        MlokError("Application tick rate can't be 0! Shutting down...");
+        return false;
+    }
+
+    State.FixedDeltaTime = 1.0 / Config.TickRate;
+    State.Accumulator = 0.0;
+    State.SimulationTick = 0;
+    State.MaxTicksPerFrame = Config.MaxTicksPerFrame > 0 ? Config.MaxTicksPerFrame : 1;
+    State.OnFixedUpdate = Config.OnFixedUpdate;
+    State.UserData = Config.UserData;
+    State.FrameIndex = 0;
+    State.MaxFrames = Config.MaxFrames;
 
     AppClock = std::make_unique<MlokClock>();
 
-    size_t EventSystemMemoryRequirement = 0;
-    EventSystem::Initialize(&EventSystemMemoryRequirement, nullptr);
-    EventSystem::Initialize(&EventSystemMemoryRequirement, SubsystemsAllocator->Allocate(EventSystemMemoryRequirement));
+    Pacer = std::make_unique<FramePacer>();
+    Pacer->Initialize(Config.PacerConfig);
+
+    // Window creation and the renderer backend steps run as one graph, independent steps overlap
+    StartupGraph Startup;
+    StartupStepId WindowStep = STARTUP_GRAPH_INVALID_STEP;
+
+    // Initialize callbacks only run inside Create, so they may capture its locals
+    Subsystems = std::make_unique<SubsystemRegistry>();
+
+    Subsystems->Register("EventSystem",
+        [this](size_t* outMemReq, void* Ptr)
+        {
+            EventSystem::Initialize(outMemReq, Ptr);
+            if (Ptr)
+            {
+                EventSystem::Get()->RegisterEvent(EVENT_CODE_APPLICATION_QUIT, this, ApplicationOnEvent);
+                EventSystem::Get()->RegisterEvent(EVENT_CODE_RESIZED, this, ApplicationOnResized);
+            }
+            return true;
+        },
+        [this]()
+        {
+            EventSystem::Get()->UnregisterEvent(EVENT_CODE_APPLICATION_QUIT, this, ApplicationOnEvent);
+            EventSystem::Get()->UnregisterEvent(EVENT_CODE_RESIZED, this, ApplicationOnResized);
+            EventSystem::Shutdown();
+        });
+
+    Subsystems->Register("Logger",
+        [&Config](size_t* outMemReq, void* Ptr) { return Logger::Initialize(outMemReq, Ptr, Config.LogConfig); },
+        []() { Logger::Shutdown(); });
+
+    Subsystems->Register("FrameStats",
+        [&Config](size_t* outMemReq, void* Ptr) { return FrameStats::Initialize(outMemReq, Ptr, Config.StatsConfig); },
+        []() { FrameStats::Shutdown(); },
+        { "Logger" });
+
+    // Every thread that records is stopped before the profiler writes its trace, so the systems that own
+    // threads depend on it
+    Subsystems->Register("Profiler",
+        [&Config](size_t* outMemReq, void* Ptr) { return Profiler::Initialize(outMemReq, Ptr, Config.ProfileConfig); },
+        []() { Profiler::Shutdown(); },
+        { "Logger" });
+
+    Subsystems->Register("JobSystem",
+        [&Config](size_t* outMemReq, void* Ptr) { return JobSystem::Initialize(outMemReq, Ptr, Config.JobsConfig); },
+        []() { JobSystem::Shutdown(); },
+        { "Logger", "Profiler" });
+
+    Subsystems->Register("TaskScheduler",
+        [](size_t* outMemReq, void* Ptr) { return TaskScheduler::Initialize(outMemReq, Ptr); },
+        []() { TaskScheduler::Shutdown(); },
+        { "JobSystem" });
+
+    Subsystems->Register("InputSystem",
+        [this, &Config](size_t* outMemReq, void* Ptr)
+        {
+            InputSystem::Initialize(outMemReq, Ptr);
+            if (Ptr == nullptr)
+            {
+                return true;
+            }
+
+            InputMappingConfig Mapping = Config.InputMapping;
+            bool bHasQuitAction = false;
+            for (const InputActionDesc& Action : Mapping.Actions)
+            {
+                bHasQuitAction |= Action.Name == INPUT_ACTION_QUIT;
+            }
+            if (!bHasQuitAction)
+            {
+                Mapping.Actions.push_back({ INPUT_ACTION_QUIT, { { InputBindingSource::INPUT_BINDING_KEY, KEY_ESCAPE } } });
+            }
+
+            if (!InputSystem::Get()->LoadMapping(Mapping))
+            {
+                MlokError("Failed to load input mapping! Shutting down...");
+                InputSystem::Shutdown();
+                return false;
+            }
+            State.QuitAction = InputSystem::Get()->FindAction(INPUT_ACTION_QUIT);
+            return true;
+        },
+        []() { InputSystem::Shutdown(); },
+        { "EventSystem", "Logger" });
+
+    Subsystems->Register("Platform",
+        [&Config, &Startup, &WindowStep](size_t* outMemReq, void* Ptr)
+        {
+            if (Ptr == nullptr)
+            {
+                return Platform::Startup(outMemReq, nullptr, std::string(), 0, 0, 0, 0);
+            }
 
-    EventSystem::Get()->RegisterEvent(EVENT_CODE_APPLICATION_QUIT, this, ApplicationOnEvent);
-    EventSystem::Get()->RegisterEvent(EVENT_CODE_KEY_PRESSED, this, ApplicationOnKey);
-    EventSystem::Get()->RegisterEvent(EVENT_CODE_KEY_RELEASED, this, ApplicationOnKey);
-    EventSystem::Get()->RegisterEvent(EVENT_CODE_RESIZED, this, ApplicationOnResized);
+            // The window is created when the startup graph runs
+            WindowStep = Startup.AddStep("Platform", [&Config, Ptr]()
+            {
+                size_t PlatformMemoryRequirement = 0;
+                if (!Platform::Startup(&PlatformMemoryRequirement, Ptr, 
+                                       Config.Name, Config.StartPosX, Config.StartPosY, Config.StartWidth, Config.StartHeight, Config.bHeadless))
+                {
+                    MlokError("Failed to initialize Platform! Shutting down...");
+                    return false;
+                }
+                return true;
+            }, {}, StartupThread::STARTUP_THREAD_MAIN);
+            return true;
+        },
+        []() { Platform::Shutdown(); },
+        { "EventSystem", "InputSystem" });
+
+    Subsystems->Register("RenderStats",
+        [&Config](size_t* outMemReq, void* Ptr) { return RenderStats::Initialize(outMemReq, Ptr, Config.RenderCountersConfig); },
+        []() { RenderStats::Shutdown(); },
+        { "Logger" });
+
+    const RendererBackendType BackendType = Config.bHeadless ? RendererBackendType::RENDERER_BACKEND_NULL : RendererBackendType::RENDERER_BACKEND_VULKAN;
+    Subsystems->Register("Renderer",
+        [this, &Config, &Startup, &WindowStep, BackendType](size_t* outMemReq, void* Ptr)
+        {
+            return Renderer::Initialize(outMemReq, Ptr, Config.Name, State.Width, State.Height, BackendType, &Startup, WindowStep);
+        },
+        [this]()
+        {
+            if (RenderWorker)
+            {
+                RenderWorker->Stop();
+            }
+            Renderer::Shutdown();
+        },
+        { "Platform", "FrameStats", "RenderStats", "TaskScheduler" });
 
-    size_t LoggerMemoryRequirement = 0;
-    Logger::Initialize(&LoggerMemoryRequirement, nullptr);
-    if (!Logger::Initialize(&LoggerMemoryRequirement, SubsystemsAllocator->Allocate(LoggerMemoryRequirement)))
+    // From here on every failure shuts the subsystems down, ShutdownAll skips the ones that didn't initialize
+    // and each Shutdown copes with a startup graph that stopped halfway
+    if (!Subsystems->InitializeAll())
     {
-        MlokError("Failed to initialize Logger! Shutting down...");
+        MlokFatal("Failed to initialize subsystems. Shutting down...");
+        Subsystems->ShutdownAll();
         return false;
     }
 
-    size_t InputSystemMemoryRequirement = 0;
-    InputSystem::Initialize(&InputSystemMemoryRequirement, nullptr);
-    InputSystem::Initialize(&InputSystemMemoryRequirement, SubsystemsAllocator->Allocate(InputSystemMemoryRequirement));
+    MLOK_PROFILE_THREAD("Mlok Main");
 
-    size_t PlatformMemoryRequirement = 0;
-    Platform::Startup(&PlatformMemoryRequirement, nullptr, std::string(), 0, 0, 0, 0);
-    if (!Platform::Startup(&PlatformMemoryRequirement, SubsystemsAllocator->Allocate(PlatformMemoryRequirement), 
-                           Config.Name, Config.StartPosX, Config.StartPosY, Config.StartWidth, Config.StartHeight))
+    if (!Startup.Run())
     {
-        MlokError("Failed to initialize Platform! Shutting down...");
+        MlokFatal("Startup failed. Shutting down...");
+        Subsystems->ShutdownAll();
         return false;
     }
 
-    size_t RendererMemoryRequirement = 0;
-    Renderer::Initialize(&RendererMemoryRequirement, nullptr, std::string(), 0, 0);
-    if (!Renderer::Get()->Initialize(&RendererMemoryRequirement, SubsystemsAllocator->Allocate(RendererMemoryRequirement), 
-                                     Config.Name, State.Width, State.Height))
+    if (Config.bRunJobBenchmark)
     {
-        MlokFatal("Failed to initialize Renderer. Shutting down...");
-        return false;
+        RunJobSystemBenchmark();
+    }
+
+    if (!Config.InputReplayPath.empty())
+    {
+        Replay = std::make_unique<InputReplay>();
+        if (!Replay->Load(Config.InputReplayPath))
+        {
+            MlokError("Failed to load input replay! Shutting down...");
+            Subsystems->ShutdownAll();
+            return false;
+        }
+    }
+
+    if (Config.bRenderThread)
+    {
+        RenderWorker = std::make_unique<RenderThread>();
+        if (!RenderWorker->Start(Config.MaxQueuedFrames))
+        {
+            MlokError("Failed to start the render thread! Shutting down...");
+            Subsystems->ShutdownAll();
+            return false;
+        }
     }
 
     return true;
@@ -69,65 +221,113 @@ bool Application::Run()
 
     AppClock->Start();
     AppClock->Update();
-    State.LastTime = AppClock->GetElapsed();
-
-    double TargetFrameSeconds = 1.f / 60; // TODO: move to config
+    State.LastTimeNs = AppClock->GetElapsedNs();
 
     while (State.bIsRunning)
     {
         if (!State.bIsSuspended)
         {
-            if (!Platform::Get()->PumpMessages())
+            MLOK_PROFILE_FRAME(State.FrameIndex);
+            MLOK_PROFILE_SCOPE("Application::Run frame");
+
+            FrameStats::Get()->BeginFrame(Platform::Get()->GetAbsoluteTimeNs());
+
             {
-                State.bIsRunning = false;
+                MLOK_PROFILE_SCOPE("Pump messages");
+                if (!Platform::Get()->PumpMessages())
+                {
+                    State.bIsRunning = false;
+                }
+            }
+
+            // Continuations of async loads that asked for the main thread
+            {
+                MLOK_PROFILE_SCOPE("Main thread tasks");
+                TaskScheduler::Get()->RunMainThreadTasks();
+            }
+
+            if (Replay)
+            {
+                Replay->Play(State.FrameIndex, Platform::Get()->GetAbsoluteTime());
             }
             
             AppClock->Update();
-            double CurrentTime = AppClock->GetElapsed();
-            double DeltaTime = CurrentTime - State.LastTime;
-            double FrameStartTime = Platform::Get()->GetAbsoluteTime();
+            uint64_t FrameTimeNs = AppClock->GetElapsedNs();
+            double DeltaTime = static_cast<double>(FrameTimeNs - State.LastTimeNs) * 1e-9;
 
-            RenderPacket Packet;
-            Packet.DeltaTime = DeltaTime;
-            Renderer::Get()->DrawFrame(&Packet);
-
-            double FrameEndTime = Platform::Get()->GetAbsoluteTime();
-            double FrameElapsedTime = FrameEndTime - FrameStartTime;
-            double RemainingSeconds = TargetFrameSeconds - FrameElapsedTime;
+            InputSystem::Get()->Update(DeltaTime);
 
-            if (RemainingSeconds > 0.f)
+            if (InputSystem::Get()->IsActionPressed(State.QuitAction))
             {
-                uint64_t RemainingMs = RemainingSeconds * 1000;
+                EventContext Data {};
+                EventSystem::Get()->FireEvent(EVENT_CODE_APPLICATION_QUIT, nullptr, Data);
+            }
+
+            State.Accumulator += DeltaTime;
 
-                bool bLimitFrames = false; // TODO: move to config
-                if (bLimitFrames && RemainingMs > 0.f)
+            {
+                MLOK_PROFILE_SCOPE("Simulation");
+                uint32_t TickCount = 0;
+                while (State.Accumulator >= State.FixedDeltaTime && TickCount < State.MaxTicksPerFrame)
                 {
-                    Platform::Get()->PlatformSleep(RemainingMs - 1);
+                    if (State.OnFixedUpdate)
+                    {
+                        State.OnFixedUpdate(this, State.FixedDeltaTime, State.UserData);
+                    }
+
+                    State.Accumulator -= State.FixedDeltaTime;
+                    ++State.SimulationTick;
+                    ++TickCount;
                 }
+                MLOK_PROFILE_COUNTER("Fixed ticks", TickCount);
             }
 
-            InputSystem::Get()->Update(DeltaTime);
+            // Can't catch up, let the simulation run slower than real time instead of spiraling
+            if (State.Accumulator >= State.FixedDeltaTime)
+            {
+                const uint64_t DroppedTicks = static_cast<uint64_t>(State.Accumulator / State.FixedDeltaTime);
+                MlokDeferredDebug("Simulation fell behind, dropped %llu ticks", DroppedTicks);
+                State.Accumulator -= DroppedTicks * State.FixedDeltaTime;
+            }
 
-            State.LastTime = CurrentTime;
-        }
-    }
-    
-    State.bIsRunning = false;
+            RenderPacket Packet;
+            Packet.DeltaTime = DeltaTime;
+            Packet.InterpolationAlpha = static_cast<float>(State.Accumulator / State.FixedDeltaTime);
+            Packet.SimulationTick = State.SimulationTick;
+            Packet.FrameIndex = State.FrameIndex;
+            if (RenderWorker)
+            {
+                MLOK_PROFILE_SCOPE("Submit render packet");
+                FrameStats::Get()->AddMainBlockedTime(RenderWorker->Submit(Packet));
+            }
+            else
+            {
+                Renderer::Get()->DrawFrame(&Packet);
+            }
 
-    Renderer::Shutdown();
+            FrameStats::Get()->EndFrame(Platform::Get()->GetAbsoluteTimeNs());
 
-    Platform::Shutdown();
+            {
+                MLOK_PROFILE_SCOPE("Frame pacing");
+                Pacer->Wait();
+            }
 
-    InputSystem::Shutdown();
+            Logger::Get()->ProcessDeferred();
 
-    Logger::Shutdown();
+            State.LastTimeNs = FrameTimeNs;
 
-    EventSystem::Get()->UnregisterEvent(EVENT_CODE_APPLICATION_QUIT, this, ApplicationOnEvent);
-    EventSystem::Get()->UnregisterEvent(EVENT_CODE_KEY_PRESSED, this, ApplicationOnKey);
-    EventSystem::Get()->UnregisterEvent(EVENT_CODE_KEY_RELEASED, this, ApplicationOnKey);
-    EventSystem::Get()->UnregisterEvent(EVENT_CODE_RESIZED, this, ApplicationOnResized);
+            ++State.FrameIndex;
+            if (State.MaxFrames > 0 && State.FrameIndex >= State.MaxFrames)
+            {
+                MlokInfo("Reached the frame limit of %llu, shutting down the Application...", State.MaxFrames);
+                State.bIsRunning = false;
+            }
+        }
+    }
+    
+    State.bIsRunning = false;
 
-    EventSystem::Shutdown();
+    Subsystems->ShutdownAll();
 
     return true;
 }
@@ -164,6 +364,16 @@ void Application::SetSuspended(const bool bValue)
     State.bIsSuspended = bValue;
 }
 
+uint64_t Application::GetSimulationTick() const
+{
+    return State.SimulationTick;
+}
+
+FramePacer* Application::GetFramePacer() const
+{
+    return Pacer.get();
+}
+
 bool ApplicationOnEvent(uint16_t Code, void* Sender, void* ListenerInst, EventContext Context)
 {
     switch (Code)
@@ -177,23 +387,6 @@ bool ApplicationOnEvent(uint16_t Code, void* Sender, void* ListenerInst, EventCo
     return false;
 }
 
-bool ApplicationOnKey(uint16_t Code, void* Sender, void* ListenerInst, EventContext Context)
-{
-    if (Code == EVENT_CODE_KEY_PRESSED)
-    {
-        uint16_t KeyCode = Context.Data.u16[0];
-        if (KeyCode == KEY_ESCAPE)
-        {
-            EventContext Data {};
-            EventSystem::Get()->FireEvent(EVENT_CODE_APPLICATION_QUIT, nullptr, Data);
-
-            return true;
-        }
-    }
-    
-    return false;
-}
-
 bool ApplicationOnResized(uint16_t Code, void* Sender, void* ListenerInst, EventContext Context)
 {
     if (Code == EVENT_CODE_RESIZED)
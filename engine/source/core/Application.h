@@ -3,10 +3,26 @@
 #include "Defines.h"
 
 #include "MlokClock.h"
+#include "FramePacer.h"
+#include "FrameStats.h"
+#include "Profiler.h"
+#include "InputReplay.h"
 #include "MlokMemory.h"
+#include "Logger.h"
+#include "InputMapping.h"
+#include "JobSystem.h"
+#include "SubsystemRegistry.h"
+
+#include "renderer/RenderThread.h"
+#include "renderer/RenderStats.h"
 
 #include <memory>
 
+class Application;
+
+// Called at a fixed rate with the fixed step, any number of times per frame (including zero)
+typedef void (*PFN_OnFixedUpdate)(Application* App, double FixedDeltaTime, void* UserData);
+
 typedef struct ApplicationConfig
 {
     int16_t StartPosX;
@@ -14,6 +30,31 @@ typedef struct ApplicationConfig
     int16_t StartWidth;
     int16_t StartHeight;
     std::string Name;
+
+    LoggerConfig LogConfig;
+    InputMappingConfig InputMapping;
+
+    // Simulation
+    uint32_t TickRate = 60;             // Fixed updates per second
+    uint32_t MaxTicksPerFrame = 5;      // Simulation time beyond it is dropped, so a slow frame can't snowball
+    PFN_OnFixedUpdate OnFixedUpdate = nullptr;
+    void* UserData = nullptr;
+
+    FramePacerConfig PacerConfig;
+    FrameStatsConfig StatsConfig;
+    ProfilerConfig ProfileConfig;   // Only used when the engine is built with MLOK_PROFILE
+    RenderStatsConfig RenderCountersConfig;
+    JobSystemConfig JobsConfig;
+    bool bRunJobBenchmark = false;  // Logs how the job system scales with thread count after startup
+
+    // Draws on a dedicated thread while the main thread simulates the next frame
+    bool bRenderThread = true;
+    uint32_t MaxQueuedFrames = 1;   // 1 adds a frame of latency (double buffering), 2 adds two (triple buffering)
+
+    // Headless runs without a window or display connection and renders through the null backend
+    bool bHeadless = false;
+    std::string InputReplayPath;    // Input script played instead of (or on top of) platform input
+    uint64_t MaxFrames = 0;         // Stops after this many frames, 0 runs until quit
 } ApplicationConfig;
 
 class MAPI Application
@@ -31,6 +72,10 @@ class MAPI Application
         bool IsSuspended() const;
         void SetSuspended(const bool bValue);
 
+        uint64_t GetSimulationTick() const;
+
+        FramePacer* GetFramePacer() const;
+
     private:
         struct AppState
         {
@@ -38,10 +83,23 @@ class MAPI Application
             bool bIsSuspended;
             int16_t Width;
             int16_t Height;
-            double LastTime;
+            uint64_t LastTimeNs;
+            InputActionId QuitAction;
+
+            double FixedDeltaTime;
+            double Accumulator;
+            uint64_t SimulationTick;
+            uint64_t FrameIndex;
+            uint64_t MaxFrames;
+            uint32_t MaxTicksPerFrame;
+            PFN_OnFixedUpdate OnFixedUpdate;
+            void* UserData;
         } State;
 
-        std::unique_ptr<MlokLinearAllocator> SubsystemsAllocator;
+        std::unique_ptr<SubsystemRegistry> Subsystems;
 
         std::unique_ptr<MlokClock> AppClock;
+        std::unique_ptr<FramePacer> Pacer;
+        std::unique_ptr<InputReplay> Replay;
+        std::unique_ptr<RenderThread> RenderWorker;
 };
\ No newline at end of file
@@ -1,3 +1,5 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_EVENT
+
 #include "Event.h"
 #include "Logger.h"
 
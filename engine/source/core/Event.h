@@ -69,7 +69,7 @@ typedef enum SystemEventCode
      */
     EVENT_CODE_MOUSE_BUTTON_RELEASED = 0x05,
 
-    // Mouse moved.
+    // Mouse moved, fired once per frame with the latest cursor position.
     /* Context usage:
      * u16 x = data.data.u16[0];
      * u16 y = data.data.u16[1];
@@ -0,0 +1,114 @@
+#include "FramePacer.h"
+
+#include "Logger.h"
+#include "platform/Platform.h"
+
+#include <algorithm>
+
+#define FRAME_PACER_MIN_SLEEP_MARGIN 100000ull      // 0.1 ms
+#define FRAME_PACER_MAX_SLEEP_MARGIN 4000000ull     // 4 ms
+#define FRAME_PACER_REPORT_INTERVAL 5000000000ull   // 5 s
+
+void FramePacer::Initialize(const FramePacerConfig& Config)
+{
+    SleepMargin = std::clamp<uint64_t>(static_cast<uint64_t>(Config.InitialSleepMargin * 1e9), FRAME_PACER_MIN_SLEEP_MARGIN, FRAME_PACER_MAX_SLEEP_MARGIN);
+    MissedDeadlineCount = 0;
+
+    ReportStart = 0;
+    ReportFrames = 0;
+    ReportMissed = 0;
+    ReportWorstLateness = 0;
+
+    SetTargetFrameRate(Config.TargetFrameRate);
+}
+
+void FramePacer::SetTargetFrameRate(double FrameRate)
+{
+    FrameDuration = FrameRate > 0.0 ? static_cast<uint64_t>(1e9 / FrameRate) : 0;
+    NextDeadline = 0;
+}
+
+double FramePacer::GetTargetFrameRate() const
+{
+    return FrameDuration > 0 ? 1e9 / FrameDuration : 0.0;
+}
+
+void FramePacer::Wait()
+{
+    if (FrameDuration == 0)
+    {
+        return;
+    }
+
+    Platform* PlatformInst = Platform::Get();
+    uint64_t Now = PlatformInst->GetAbsoluteTimeNs();
+
+    if (NextDeadline == 0)
+    {
+        NextDeadline = Now + FrameDuration;
+        ReportStart = Now;
+    }
+
+    if (Now > NextDeadline)
+    {
+        ++MissedDeadlineCount;
+        ++ReportMissed;
+        ReportWorstLateness = std::max(ReportWorstLateness, Now - NextDeadline);
+
+        // Keep the cadence after a small miss, restart it after a long stall instead of rushing frames to catch up
+        NextDeadline += FrameDuration;
+        if (NextDeadline <= Now)
+        {
+            NextDeadline = Now + FrameDuration;
+        }
+    }
+    else
+    {
+        if (NextDeadline - Now > SleepMargin)
+        {
+            const uint64_t WakeTarget = NextDeadline - SleepMargin;
+            PlatformInst->SleepUntilNs(WakeTarget);
+            Now = PlatformInst->GetAbsoluteTimeNs();
+
+            // The margin follows the worst recent oversleep and slowly decays (1% a frame) when the scheduler behaves
+            const uint64_t Oversleep = Now > WakeTarget ? Now - WakeTarget : 0;
+            SleepMargin = std::clamp<uint64_t>(std::max(SleepMargin - SleepMargin / 100, Oversleep + Oversleep / 4),
+                                     FRAME_PACER_MIN_SLEEP_MARGIN, FRAME_PACER_MAX_SLEEP_MARGIN);
+        }
+
+        while (Now < NextDeadline)
+        {
+            Platform::SpinPause();
+            Now = PlatformInst->GetAbsoluteTimeNs();
+        }
+
+        NextDeadline += FrameDuration;
+    }
+
+    ++ReportFrames;
+    ReportMissedDeadlines(Now);
+}
+
+uint64_t FramePacer::GetMissedDeadlineCount() const
+{
+    return MissedDeadlineCount;
+}
+
+void FramePacer::ReportMissedDeadlines(uint64_t Now)
+{
+    if (Now - ReportStart < FRAME_PACER_REPORT_INTERVAL)
+    {
+        return;
+    }
+
+    if (ReportMissed > 0)
+    {
+        MlokDeferredDebug("Frame pacer missed %u of %u deadlines in %.1f s, worst by %.2f ms (sleep margin %.3f ms)",
+                          ReportMissed, ReportFrames, (Now - ReportStart) * 1e-9, ReportWorstLateness * 1e-6, SleepMargin * 1e-6);
+    }
+
+    ReportStart = Now;
+    ReportFrames = 0;
+    ReportMissed = 0;
+    ReportWorstLateness = 0;
+}
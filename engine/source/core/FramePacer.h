@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Defines.h"
+
+typedef struct FramePacerConfig
+{
+    double TargetFrameRate = 0.0;       // Frames per second, 0 runs unlimited
+    double InitialSleepMargin = 0.002;  // Seconds left to spin after the coarse sleep, calibrated at runtime
+} FramePacerConfig;
+
+// Holds frames to a fixed cadence of absolute deadlines. Most of the wait is a coarse OS sleep,
+// the last fraction (the observed scheduler oversleep) is spent spinning for precision.
+class MAPI FramePacer
+{
+    public:
+        void Initialize(const FramePacerConfig& Config);
+
+        void SetTargetFrameRate(double FrameRate);
+        double GetTargetFrameRate() const;
+
+        // Blocks until the deadline of the current frame and schedules the next one
+        void Wait();
+
+        uint64_t GetMissedDeadlineCount() const;
+
+    private:
+        void ReportMissedDeadlines(uint64_t Now);
+
+        uint64_t FrameDuration;     // Nanoseconds, 0 when pacing is off
+        uint64_t NextDeadline;      // 0 until the first frame
+        uint64_t SleepMargin;
+
+        uint64_t MissedDeadlineCount;
+
+        uint64_t ReportStart;
+        uint32_t ReportFrames;
+        uint32_t ReportMissed;
+        uint64_t ReportWorstLateness;
+};
@@ -0,0 +1,284 @@
+#include "FrameStats.h"
+
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#define FRAME_STATS_AVERAGE_WEIGHT 0.05 // Of the newest frame in the running average used for hitch detection
+
+FrameStats* FrameStats::Instance = nullptr;
+
+static const char* MetricNames[] = { "Frame", "CPU", "GPU", "MainBlocked", "RenderBlocked" };
+
+FrameStats* FrameStats::Get()
+{
+    return Instance;
+}
+
+bool FrameStats::Initialize(size_t* outMemReq, void* Ptr, const FrameStatsConfig& Config)
+{
+    *outMemReq = sizeof(FrameStats);
+    if (Ptr == nullptr)
+    {
+        return true;
+    }
+
+    Instance = static_cast<FrameStats*>(Ptr);
+    Instance->bEnabled = Config.bEnabled;
+    Instance->bLogReport = Config.bLogReport;
+    Instance->ReportInterval = static_cast<uint64_t>(Config.ReportIntervalSeconds * 1e9);
+    Instance->HitchFactor = Config.HitchFactor;
+    Instance->HitchMinimum = static_cast<uint64_t>(Config.HitchMinimumMs * 1e6);
+    Instance->FrameStart = 0;
+    Instance->MainBlockedTime = 0;
+    Instance->RenderFrameIndex = 0;
+    Instance->RenderBlockedTime = 0;
+    for (std::atomic<uint64_t>& Slot : Instance->RenderBlockedSlots)
+    {
+        Slot.store(0, std::memory_order_relaxed);
+    }
+    Instance->GpuTime.store(0, std::memory_order_relaxed);
+    Instance->AverageFrameNs = 0.0;
+    Instance->TotalFrames = 0;
+    Instance->TotalHitches = 0;
+    Instance->CsvFile = nullptr;
+
+    if (Instance->bEnabled && !Config.CsvPath.empty())
+    {
+        // Kept across runs so they can be compared, the header is only written to a new file. Time is since startup,
+        // rows of a run share its wall clock start
+        Instance->RunStart = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+
+        FILE* Csv = std::fopen(Config.CsvPath.c_str(), "a");
+        if (!Csv)
+        {
+            MlokWarning("Failed to open frame stats CSV file %s", Config.CsvPath.c_str());
+        }
+        else
+        {
+            std::fseek(Csv, 0, SEEK_END);
+            if (std::ftell(Csv) == 0)
+            {
+                std::fputs("run_start_ms,time_s,frames,hitches", Csv);
+                for (const char* Name : MetricNames)
+                {
+                    std::fprintf(Csv, ",%s_p50_ms,%s_p95_ms,%s_p99_ms,%s_max_ms", Name, Name, Name, Name);
+                }
+                std::fputc('\n', Csv);
+            }
+            Instance->CsvFile = Csv;
+        }
+    }
+
+    Instance->ResetWindow(0);
+
+    return true;
+}
+
+void FrameStats::Shutdown()
+{
+    if (Instance && Instance->CsvFile)
+    {
+        std::fclose(static_cast<FILE*>(Instance->CsvFile));
+        Instance->CsvFile = nullptr;
+    }
+
+    if (Instance && Instance->bEnabled)
+    {
+        MlokInfo("Frame stats: %llu frames, %llu hitches", Instance->TotalFrames, Instance->TotalHitches);
+    }
+
+    Instance = nullptr;
+}
+
+void FrameStats::BeginFrame(uint64_t NowNs)
+{
+    if (!bEnabled)
+    {
+        return;
+    }
+
+    if (FrameStart != 0)
+    {
+        const uint64_t FrameTime = NowNs - FrameStart;
+        Record(FrameStatsMetric::FRAME_STATS_FRAME, FrameTime);
+        ++TotalFrames;
+
+        if (AverageFrameNs > 0.0 && FrameTime > HitchMinimum && FrameTime > AverageFrameNs * HitchFactor)
+        {
+            ++HitchCount;
+            ++TotalHitches;
+            MlokDeferredDebug("Hitch: frame took %.2f ms, average is %.2f ms", FrameTime * 1e-6, AverageFrameNs * 1e-6);
+        }
+
+        AverageFrameNs = AverageFrameNs > 0.0 ? AverageFrameNs + (FrameTime - AverageFrameNs) * FRAME_STATS_AVERAGE_WEIGHT
+                                              : static_cast<double>(FrameTime);
+    }
+    else
+    {
+        WindowStart = NowNs;
+    }
+
+    if (ReportInterval > 0 && NowNs - WindowStart >= ReportInterval)
+    {
+        Report(NowNs);
+        ResetWindow(NowNs);
+    }
+
+    FrameStart = NowNs;
+    MainBlockedTime = 0;
+}
+
+void FrameStats::EndFrame(uint64_t NowNs)
+{
+    if (!bEnabled || FrameStart == 0)
+    {
+        return;
+    }
+
+    const uint64_t FrameTime = NowNs - FrameStart;
+    Record(FrameStatsMetric::FRAME_STATS_CPU, FrameTime - std::min(MainBlockedTime, FrameTime));
+    Record(FrameStatsMetric::FRAME_STATS_MAIN_BLOCKED, MainBlockedTime);
+
+    // Each finished render packet once, whichever main frame it belonged to
+    for (std::atomic<uint64_t>& Slot : RenderBlockedSlots)
+    {
+        if (const uint64_t Blocked = Slot.exchange(0, std::memory_order_relaxed))
+        {
+            Record(FrameStatsMetric::FRAME_STATS_RENDER_BLOCKED, Blocked - 1);
+        }
+    }
+
+    if (const uint64_t Gpu = GpuTime.exchange(0, std::memory_order_relaxed))
+    {
+        Record(FrameStatsMetric::FRAME_STATS_GPU, Gpu);
+    }
+}
+
+void FrameStats::AddMainBlockedTime(uint64_t DurationNs)
+{
+    MainBlockedTime += DurationNs;
+}
+
+void FrameStats::BeginRenderFrame(uint64_t FrameIndex)
+{
+    RenderFrameIndex = FrameIndex;
+    RenderBlockedTime = 0;
+}
+
+void FrameStats::AddRenderBlockedTime(uint64_t DurationNs)
+{
+    RenderBlockedTime += DurationNs;
+}
+
+void FrameStats::EndRenderFrame()
+{
+    if (bEnabled)
+    {
+        RenderBlockedSlots[RenderFrameIndex % FRAME_STATS_RENDER_SLOT_COUNT].store(RenderBlockedTime + 1, std::memory_order_relaxed);
+    }
+}
+
+void FrameStats::SetGpuFrameTime(uint64_t DurationNs)
+{
+    // Histograms are only touched by the main thread, the value is recorded on the next EndFrame
+    GpuTime.store(DurationNs, std::memory_order_relaxed);
+}
+
+void FrameStats::GetSummary(FrameStatsMetric Metric, FrameStatsSummary* OutSummary) const
+{
+    const Histogram& Hist = Histograms[static_cast<size_t>(Metric)];
+
+    std::memset(OutSummary, 0, sizeof(FrameStatsSummary));
+    OutSummary->SampleCount = Hist.SampleCount;
+    if (Hist.SampleCount == 0)
+    {
+        return;
+    }
+
+    OutSummary->MaxMs = Hist.MaxNs * 1e-6;
+    OutSummary->AverageMs = Hist.SumNs * 1e-6 / Hist.SampleCount;
+
+    // Nearest rank on the bucket upper edges, the overflow bucket reports the exact max
+    const uint32_t Ranks[3] = { (Hist.SampleCount * 50 + 99) / 100, (Hist.SampleCount * 95 + 99) / 100, (Hist.SampleCount * 99 + 99) / 100 };
+    double* Results[3] = { &OutSummary->P50Ms, &OutSummary->P95Ms, &OutSummary->P99Ms };
+
+    uint32_t Cumulative = 0;
+    uint32_t RankIdx = 0;
+    for (uint32_t Bucket = 0; Bucket <= FRAME_STATS_BUCKET_COUNT && RankIdx < 3; ++Bucket)
+    {
+        Cumulative += Hist.Counts[Bucket];
+        while (RankIdx < 3 && Cumulative >= std::max(Ranks[RankIdx], 1u))
+        {
+            const double UpperEdgeMs = (Bucket + 1) * FRAME_STATS_BUCKET_WIDTH_NS * 1e-6;
+            *Results[RankIdx++] = Bucket == FRAME_STATS_BUCKET_COUNT ? OutSummary->MaxMs : std::min(UpperEdgeMs, OutSummary->MaxMs);
+        }
+    }
+}
+
+uint32_t FrameStats::GetHitchCount() const
+{
+    return HitchCount;
+}
+
+void FrameStats::Record(FrameStatsMetric Metric, uint64_t DurationNs)
+{
+    Histogram& Hist = Histograms[static_cast<size_t>(Metric)];
+
+    const uint64_t Bucket = std::min<uint64_t>(DurationNs / FRAME_STATS_BUCKET_WIDTH_NS, FRAME_STATS_BUCKET_COUNT);
+    ++Hist.Counts[Bucket];
+    ++Hist.SampleCount;
+    Hist.MaxNs = std::max(Hist.MaxNs, DurationNs);
+    Hist.SumNs += DurationNs;
+}
+
+void FrameStats::Report(uint64_t NowNs)
+{
+    FrameStatsSummary Summaries[static_cast<size_t>(FrameStatsMetric::FRAME_STATS_METRIC_MAX)];
+    for (size_t i = 0; i < static_cast<size_t>(FrameStatsMetric::FRAME_STATS_METRIC_MAX); ++i)
+    {
+        GetSummary(static_cast<FrameStatsMetric>(i), &Summaries[i]);
+    }
+
+    const FrameStatsSummary& Frame = Summaries[static_cast<size_t>(FrameStatsMetric::FRAME_STATS_FRAME)];
+    const double WindowSeconds = (NowNs - WindowStart) * 1e-9;
+
+    if (bLogReport)
+    {
+        MlokInfo("Frame stats over %.1f s: %u frames (%.1f fps), %u hitches", WindowSeconds, Frame.SampleCount,
+                 Frame.SampleCount / WindowSeconds, HitchCount);
+
+        for (size_t i = 0; i < static_cast<size_t>(FrameStatsMetric::FRAME_STATS_METRIC_MAX); ++i)
+        {
+            const FrameStatsSummary& Summary = Summaries[i];
+            if (Summary.SampleCount > 0)
+            {
+                MlokInfo("    %-8s avg %6.2f  p50 %6.2f  p95 %6.2f  p99 %6.2f  max %6.2f ms", MetricNames[i],
+                         Summary.AverageMs, Summary.P50Ms, Summary.P95Ms, Summary.P99Ms, Summary.MaxMs);
+            }
+        }
+    }
+
+    if (CsvFile)
+    {
+        FILE* Csv = static_cast<FILE*>(CsvFile);
+        std::fprintf(Csv, "%llu,%.3f,%u,%u", static_cast<unsigned long long>(RunStart), NowNs * 1e-9, Frame.SampleCount, HitchCount);
+        for (const FrameStatsSummary& Summary : Summaries)
+        {
+            std::fprintf(Csv, ",%.3f,%.3f,%.3f,%.3f", Summary.P50Ms, Summary.P95Ms, Summary.P99Ms, Summary.MaxMs);
+        }
+        std::fputc('\n', Csv);
+        std::fflush(Csv);
+    }
+}
+
+void FrameStats::ResetWindow(uint64_t NowNs)
+{
+    std::memset(Histograms, 0, sizeof(Histograms));
+    WindowStart = NowNs;
+    HitchCount = 0;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Defines.h"
+
+#include <atomic>
+
+#define FRAME_STATS_BUCKET_COUNT 1024
+#define FRAME_STATS_BUCKET_WIDTH_NS 100000ull // 0.1 ms, the histogram covers 102.4 ms and keeps the rest in an overflow bucket
+#define FRAME_STATS_RENDER_SLOT_COUNT 8         // Render frames finished but not yet recorded, more than the render thread can lag
+
+enum class FrameStatsMetric
+{
+    FRAME_STATS_FRAME,      // Interval between frame starts, what the user sees
+    FRAME_STATS_CPU,        // Frame start to the end of the renderer submission, without pacing or main thread blocking
+    FRAME_STATS_GPU,        // Only recorded when the renderer provides it
+    FRAME_STATS_MAIN_BLOCKED,   // Main thread waiting for a free render thread slot
+    FRAME_STATS_RENDER_BLOCKED, // Renderer waiting on fences, swapchain acquire and present, per render packet
+    FRAME_STATS_METRIC_MAX
+};
+
+typedef struct FrameStatsConfig
+{
+    bool bEnabled = true;
+    double ReportIntervalSeconds = 10.0;    // Length of the rolling window, 0 never reports
+    float HitchFactor = 2.f;                // A frame this many times longer than the running average is a hitch
+    double HitchMinimumMs = 8.0;            // And at least this long
+    bool bLogReport = true;
+    std::string CsvPath;                    // A row per window is appended when set, earlier runs are kept
+} FrameStatsConfig;
+
+typedef struct FrameStatsSummary
+{
+    uint32_t SampleCount;
+    double P50Ms;
+    double P95Ms;
+    double P99Ms;
+    double MaxMs;
+    double AverageMs;
+} FrameStatsSummary;
+
+// Rolling frame time statistics. Each window collects fixed-size histograms, percentiles come from
+// a cumulative scan, so recording a frame is a few increments.
+class MAPI FrameStats
+{
+    public:
+        static FrameStats* Get();
+
+        static bool Initialize(size_t* outMemReq, void* Ptr, const FrameStatsConfig& Config = FrameStatsConfig());
+        static void Shutdown();
+
+        void BeginFrame(uint64_t NowNs);
+        void EndFrame(uint64_t NowNs);
+
+        // Main thread only
+        void AddMainBlockedTime(uint64_t DurationNs);
+
+        // Called by whichever thread draws, around the packet of main frame FrameIndex. The render waits in
+        // between are recorded for that frame, not for the main frame open when they happen
+        void BeginRenderFrame(uint64_t FrameIndex);
+        void AddRenderBlockedTime(uint64_t DurationNs);
+        void EndRenderFrame();
+
+        // Can be called from the render thread
+        void SetGpuFrameTime(uint64_t DurationNs);
+
+        // Of the current window
+        void GetSummary(FrameStatsMetric Metric, FrameStatsSummary* OutSummary) const;
+        uint32_t GetHitchCount() const;
+
+    private:
+        typedef struct Histogram
+        {
+            uint32_t Counts[FRAME_STATS_BUCKET_COUNT + 1]; // The last one is the overflow
+            uint32_t SampleCount;
+            uint64_t MaxNs;
+            uint64_t SumNs;
+        } Histogram;
+
+        void Record(FrameStatsMetric Metric, uint64_t DurationNs);
+        void Report(uint64_t NowNs);
+        void ResetWindow(uint64_t NowNs);
+
+        Histogram Histograms[static_cast<size_t>(FrameStatsMetric::FRAME_STATS_METRIC_MAX)];
+
+        uint64_t WindowStart;
+        uint64_t ReportInterval;
+        uint32_t HitchCount;
+        uint64_t TotalFrames;
+        uint64_t TotalHitches;
+
+        uint64_t FrameStart;        // 0 before the first frame
+        uint64_t MainBlockedTime;   // Since BeginFrame
+
+        uint64_t RenderFrameIndex;  // Of the packet being drawn, only touched by the drawing thread
+        uint64_t RenderBlockedTime;
+        std::atomic<uint64_t> RenderBlockedSlots[FRAME_STATS_RENDER_SLOT_COUNT];  // Blocked time + 1 by frame index, 0 if empty
+        std::atomic<uint64_t> GpuTime;          // Latest unrecorded GPU frame time, 0 if none
+        double AverageFrameNs;
+        float HitchFactor;
+        uint64_t HitchMinimum;
+
+        bool bEnabled;
+        bool bLogReport;
+        void* CsvFile;              // FILE*, nullptr when the CSV dump is off
+        uint64_t RunStart;          // Unix time in ms, the first CSV column
+
+        static FrameStats* Instance;
+};
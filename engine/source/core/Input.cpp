@@ -1,6 +1,54 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_INPUT
+
 #include "Input.h"
 
 #include "Event.h"
+#include "Logger.h"
+
+MINLINE uint8_t GetMouseButtonMask(const uint16_t* Buttons)
+{
+    uint8_t Mask = 0;
+    for (size_t i = 0; i < static_cast<size_t>(MouseButton::MOUSE_BUTTON_MAX); ++i)
+    {
+        Mask |= (Buttons[i] ? 1 : 0) << i;
+    }
+    return Mask;
+}
+
+MINLINE bool KeyMaskIntersects(const KeyMask& A, const KeyMask& B)
+{
+    uint64_t Hit = 0;
+    for (uint32_t i = 0; i < KEY_MASK_WORD_COUNT; ++i)
+    {
+        Hit |= A.Words[i] & B.Words[i];
+    }
+    return Hit != 0;
+}
+
+MINLINE bool CopyMappingName(char* Dest, const std::string& Name)
+{
+    if (Name.empty() || Name.length() >= INPUT_MAPPING_NAME_LENGTH)
+    {
+        MlokError("Input mapping name '%s' is empty or longer than %u characters", Name.c_str(), INPUT_MAPPING_NAME_LENGTH - 1);
+        return false;
+    }
+
+    std::memcpy(Dest, Name.c_str(), Name.length() + 1);
+    return true;
+}
+
+MINLINE bool IsDigitalBindingValid(const InputBinding& Binding)
+{
+    if (Binding.Source == InputBindingSource::INPUT_BINDING_KEY)
+    {
+        return Binding.Code < KEYS_MAX_KEYS;
+    }
+    if (Binding.Source == InputBindingSource::INPUT_BINDING_MOUSE_BUTTON)
+    {
+        return Binding.Code < static_cast<uint16_t>(MouseButton::MOUSE_BUTTON_MAX);
+    }
+    return true;
+}
 
 InputSystem* InputSystem::Instance = nullptr;
 
@@ -29,26 +77,256 @@ void InputSystem::Update(double DeltaTime)
 {
     KeyboardPreviousState = KeyboardCurrentState;
     MousePreviousState = MouseCurrentState;
+
+    KeyboardCurrentState = KeyboardLiveState;
+    MouseCurrentState = MouseLiveState;
+    std::memset(&KeyboardLiveState.Pressed, 0, sizeof(KeyMask));
+    std::memset(&KeyboardLiveState.Released, 0, sizeof(KeyMask));
+    MouseLiveState.WheelDelta = 0;
+    MouseLiveState.RawDeltaX = 0.f;
+    MouseLiveState.RawDeltaY = 0.f;
+
+    // Every motion sample of the frame is coalesced into a single event
+    if (MouseCurrentState.XPos != MousePreviousState.XPos || MouseCurrentState.YPos != MousePreviousState.YPos)
+    {
+        EventContext Context;
+        Context.Data.u16[0] = MouseCurrentState.XPos;
+        Context.Data.u16[1] = MouseCurrentState.YPos;
+        EventSystem::Get()->FireEvent(EVENT_CODE_MOUSE_MOVED, this, Context);
+    }
+
+    PendingBufferIndex ^= 1;
+    EventCounts[PendingBufferIndex] = 0;
+
+    if (DroppedEventCount > 0)
+    {
+        MlokWarning("Input event buffer overflowed, %u events were dropped", DroppedEventCount);
+        DroppedEventCount = 0;
+    }
+
+    ResolveMapping();
+}
+
+uint32_t InputSystem::GetFrameEvents(const InputEvent** OutEvents) const
+{
+    const uint32_t FrameBufferIndex = PendingBufferIndex ^ 1;
+    *OutEvents = EventBuffers[FrameBufferIndex];
+    return EventCounts[FrameBufferIndex];
+}
+
+InputEvent* InputSystem::PushEvent(InputEventType Type, double Timestamp)
+{
+    uint32_t& Count = EventCounts[PendingBufferIndex];
+    if (Count >= INPUT_EVENT_BUFFER_SIZE)
+    {
+        ++DroppedEventCount;
+        return nullptr;
+    }
+
+    InputEvent* Event = &EventBuffers[PendingBufferIndex][Count++];
+    std::memset(Event, 0, sizeof(InputEvent));
+    Event->Timestamp = Timestamp;
+    Event->Type = Type;
+    return Event;
+}
+
+bool InputSystem::LoadMapping(const InputMappingConfig& Config)
+{
+    if (Config.Actions.size() > INPUT_MAX_ACTIONS || Config.Axes.size() > INPUT_MAX_AXES)
+    {
+        MlokError("Input mapping has %zu actions and %zu axes, at most %u and %u are supported",
+                  Config.Actions.size(), Config.Axes.size(), INPUT_MAX_ACTIONS, INPUT_MAX_AXES);
+        return false;
+    }
+
+    ActionCount = 0;
+    AxisCount = 0;
+    std::memset(Actions, 0, sizeof(Actions));
+    std::memset(Axes, 0, sizeof(Axes));
+    std::memset(ActionsCurrent, 0, sizeof(ActionsCurrent));
+    std::memset(ActionsPrevious, 0, sizeof(ActionsPrevious));
+    std::memset(AxisValues, 0, sizeof(AxisValues));
+
+    for (size_t i = 0; i < Config.Actions.size(); ++i)
+    {
+        const InputActionDesc& Desc = Config.Actions[i];
+        if (!CopyMappingName(ActionNames[i], Desc.Name))
+        {
+            return false;
+        }
+
+        ActionEntry& Entry = Actions[i];
+        for (const InputBinding& Binding : Desc.Bindings)
+        {
+            if (!IsDigitalBindingValid(Binding))
+            {
+                MlokError("Input action '%s' has an invalid binding code %u", Desc.Name.c_str(), Binding.Code);
+                return false;
+            }
+
+            switch (Binding.Source)
+            {
+                case InputBindingSource::INPUT_BINDING_KEY:
+                    KeyMaskSet(Entry.Keys, Binding.Code, true);
+                    break;
+                case InputBindingSource::INPUT_BINDING_MOUSE_BUTTON:
+                    Entry.Buttons |= 1 << Binding.Code;
+                    break;
+                default:
+                    MlokWarning("Input action '%s' ignores a mouse axis binding", Desc.Name.c_str());
+                    break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < Config.Axes.size(); ++i)
+    {
+        const InputAxisDesc& Desc = Config.Axes[i];
+        if (!CopyMappingName(AxisNames[i], Desc.Name))
+        {
+            return false;
+        }
+
+        AxisEntry& Entry = Axes[i];
+        for (const InputBinding& Binding : Desc.Bindings)
+        {
+            if (!IsDigitalBindingValid(Binding))
+            {
+                MlokError("Input axis '%s' has an invalid binding code %u", Desc.Name.c_str(), Binding.Code);
+                return false;
+            }
+
+            const bool bPositive = Binding.Scale >= 0.f;
+            switch (Binding.Source)
+            {
+                case InputBindingSource::INPUT_BINDING_KEY:
+                    KeyMaskSet(bPositive ? Entry.PositiveKeys : Entry.NegativeKeys, Binding.Code, true);
+                    break;
+                case InputBindingSource::INPUT_BINDING_MOUSE_BUTTON:
+                    (bPositive ? Entry.PositiveButtons : Entry.NegativeButtons) |= 1 << Binding.Code;
+                    break;
+                case InputBindingSource::INPUT_BINDING_MOUSE_X:
+                    Entry.MouseXScale += Binding.Scale;
+                    break;
+                case InputBindingSource::INPUT_BINDING_MOUSE_Y:
+                    Entry.MouseYScale += Binding.Scale;
+                    break;
+                case InputBindingSource::INPUT_BINDING_MOUSE_WHEEL:
+                    Entry.WheelScale += Binding.Scale;
+                    break;
+            }
+        }
+    }
+
+    ActionCount = static_cast<uint16_t>(Config.Actions.size());
+    AxisCount = static_cast<uint16_t>(Config.Axes.size());
+
+    MlokInfo("Input mapping loaded: %u actions, %u axes", ActionCount, AxisCount);
+
+    return true;
+}
+
+InputActionId InputSystem::FindAction(const char* Name) const
+{
+    for (uint16_t i = 0; i < ActionCount; ++i)
+    {
+        if (std::strcmp(ActionNames[i], Name) == 0)
+        {
+            return i;
+        }
+    }
+    return INPUT_INVALID_ID;
+}
+
+InputAxisId InputSystem::FindAxis(const char* Name) const
+{
+    for (uint16_t i = 0; i < AxisCount; ++i)
+    {
+        if (std::strcmp(AxisNames[i], Name) == 0)
+        {
+            return i;
+        }
+    }
+    return INPUT_INVALID_ID;
+}
+
+bool InputSystem::IsActionDown(InputActionId Action) const
+{
+    return Action < ActionCount && ((ActionsCurrent[Action >> 6] >> (Action & 63)) & 1);
+}
+
+bool InputSystem::IsActionPressed(InputActionId Action) const
+{
+    return Action < ActionCount && (((ActionsCurrent[Action >> 6] & ~ActionsPrevious[Action >> 6]) >> (Action & 63)) & 1);
+}
+
+bool InputSystem::IsActionReleased(InputActionId Action) const
+{
+    return Action < ActionCount && (((~ActionsCurrent[Action >> 6] & ActionsPrevious[Action >> 6]) >> (Action & 63)) & 1);
+}
+
+float InputSystem::GetAxisValue(InputAxisId Axis) const
+{
+    return Axis < AxisCount ? AxisValues[Axis] : 0.f;
+}
+
+void InputSystem::ResolveMapping()
+{
+    // A key tapped within the frame is down for the actions, so the tap isn't lost
+    KeyMask Keys;
+    for (uint32_t i = 0; i < KEY_MASK_WORD_COUNT; ++i)
+    {
+        Keys.Words[i] = KeyboardCurrentState.Keys.Words[i] | KeyboardCurrentState.Pressed.Words[i];
+    }
+    const uint8_t Buttons = GetMouseButtonMask(MouseCurrentState.Buttons);
+
+    for (uint32_t i = 0; i < INPUT_MAX_ACTIONS / 64; ++i)
+    {
+        ActionsPrevious[i] = ActionsCurrent[i];
+        ActionsCurrent[i] = 0;
+    }
+
+    for (uint16_t i = 0; i < ActionCount; ++i)
+    {
+        const ActionEntry& Entry = Actions[i];
+        const bool bDown = KeyMaskIntersects(Keys, Entry.Keys) || (Buttons & Entry.Buttons);
+        ActionsCurrent[i >> 6] |= static_cast<uint64_t>(bDown) << (i & 63);
+    }
+
+    float MouseDeltaX;
+    float MouseDeltaY;
+    GetMouseDelta(&MouseDeltaX, &MouseDeltaY);
+    const float WheelDelta = static_cast<float>(MouseCurrentState.WheelDelta);
+
+    for (uint16_t i = 0; i < AxisCount; ++i)
+    {
+        const AxisEntry& Entry = Axes[i];
+        const bool bPositive = KeyMaskIntersects(Keys, Entry.PositiveKeys) || (Buttons & Entry.PositiveButtons);
+        const bool bNegative = KeyMaskIntersects(Keys, Entry.NegativeKeys) || (Buttons & Entry.NegativeButtons);
+
+        AxisValues[i] = static_cast<float>(bPositive) - static_cast<float>(bNegative) +
+                        MouseDeltaX * Entry.MouseXScale + MouseDeltaY * Entry.MouseYScale + WheelDelta * Entry.WheelScale;
+    }
 }
 
 bool InputSystem::IsKeyDown(KeyboardKey Key)
 {
-    return KeyboardCurrentState.Keys[Key];
+    return KeyMaskTest(KeyboardCurrentState.Keys, Key);
 }
 
 bool InputSystem::IsKeyUp(KeyboardKey Key)
 {
-    return !KeyboardCurrentState.Keys[Key];
+    return !KeyMaskTest(KeyboardCurrentState.Keys, Key);
 }
 
 bool InputSystem::WasKeyDown(KeyboardKey Key)
 {
-    return KeyboardPreviousState.Keys[Key];
+    return KeyMaskTest(KeyboardPreviousState.Keys, Key);
 }
 
 bool InputSystem::WasKeyUp(KeyboardKey Key)
 {
-    return !KeyboardPreviousState.Keys[Key];
+    return !KeyMaskTest(KeyboardPreviousState.Keys, Key);
 }
 
 bool InputSystem::IsKeyDown(const char KeyChar)
@@ -71,11 +349,46 @@ bool InputSystem::WasKeyUp(const char KeyChar)
     return !WasKeyDown(static_cast<KeyboardKey>(KeyChar));
 }
 
-void InputSystem::ProcessKey(KeyboardKey Key, bool bPressed)
+bool InputSystem::IsKeyPressed(KeyboardKey Key)
+{
+    return KeyMaskTest(KeyboardCurrentState.Pressed, Key);
+}
+
+bool InputSystem::IsKeyReleased(KeyboardKey Key)
+{
+    return KeyMaskTest(KeyboardCurrentState.Released, Key);
+}
+
+void InputSystem::GetPressedKeys(KeyMask* OutMask) const
+{
+    *OutMask = KeyboardCurrentState.Pressed;
+}
+
+void InputSystem::GetReleasedKeys(KeyMask* OutMask) const
+{
+    *OutMask = KeyboardCurrentState.Released;
+}
+
+void InputSystem::GetChangedKeys(KeyMask* OutMask) const
+{
+    for (uint32_t i = 0; i < KEY_MASK_WORD_COUNT; ++i)
+    {
+        OutMask->Words[i] = KeyboardCurrentState.Pressed.Words[i] | KeyboardCurrentState.Released.Words[i];
+    }
+}
+
+void InputSystem::ProcessKey(KeyboardKey Key, bool bPressed, double Timestamp)
 {
-    if (KeyboardCurrentState.Keys[Key] != bPressed)
+    if (KeyMaskTest(KeyboardLiveState.Keys, Key) != bPressed)
     {
-        KeyboardCurrentState.Keys[Key] = bPressed;
+        KeyMaskSet(KeyboardLiveState.Keys, Key, bPressed);
+        KeyMaskSet(bPressed ? KeyboardLiveState.Pressed : KeyboardLiveState.Released, Key, true);
+
+        if (InputEvent* Event = PushEvent(InputEventType::INPUT_EVENT_KEY, Timestamp))
+        {
+            Event->bPressed = bPressed;
+            Event->Code = Key;
+        }
 
         EventContext Context;
         Context.Data.u16[0] = Key;
@@ -115,32 +428,96 @@ void InputSystem::GetPreviousMousePosition(int32_t* X, int32_t* Y)
     *Y = MousePreviousState.YPos;
 }
 
-void InputSystem::ProcessMouseButton(MouseButton Button, bool bPressed)
+void InputSystem::GetMouseDelta(float* X, float* Y)
 {
-    if (MouseCurrentState.Buttons[static_cast<size_t>(Button)] != bPressed)
+    if (MouseCurrentState.bHasRawMotion)
+    {
+        *X = MouseCurrentState.RawDeltaX;
+        *Y = MouseCurrentState.RawDeltaY;
+    }
+    else
+    {
+        *X = static_cast<float>(MouseCurrentState.XPos - MousePreviousState.XPos);
+        *Y = static_cast<float>(MouseCurrentState.YPos - MousePreviousState.YPos);
+    }
+}
+
+void InputSystem::ProcessMouseButton(MouseButton Button, bool bPressed, double Timestamp)
+{
+    if (Button >= MouseButton::MOUSE_BUTTON_MAX)
+    {
+        return;
+    }
+
+    if (MouseLiveState.Buttons[static_cast<size_t>(Button)] != bPressed)
     {
+        MouseLiveState.Buttons[static_cast<size_t>(Button)] = bPressed;
+
+        if (InputEvent* Event = PushEvent(InputEventType::INPUT_EVENT_MOUSE_BUTTON, Timestamp))
+        {
+            Event->bPressed = bPressed;
+            Event->Code = static_cast<uint16_t>(Button);
+        }
+
         EventContext Context;
         Context.Data.u16[0] = static_cast<uint16_t>(Button);
         EventSystem::Get()->FireEvent(bPressed ? EVENT_CODE_MOUSE_BUTTON_PRESSED : EVENT_CODE_MOUSE_BUTTON_RELEASED, this, Context);
     }
 }
 
-void InputSystem::ProcessMouseMove(int16_t X, int16_t Y)
+void InputSystem::ProcessMouseMove(int16_t X, int16_t Y, double Timestamp)
 {
-    if (MouseCurrentState.XPos != X || MouseCurrentState.YPos != Y)
+    if (MouseLiveState.XPos != X || MouseLiveState.YPos != Y)
     {
-        MouseCurrentState.XPos = X;
-        MouseCurrentState.YPos = Y;
+        MouseLiveState.XPos = X;
+        MouseLiveState.YPos = Y;
 
-        EventContext Context;
-        Context.Data.u16[0] = X;
-        Context.Data.u16[1] = Y;
-        EventSystem::Get()->FireEvent(EVENT_CODE_MOUSE_MOVED, this, Context);
+        // Consecutive samples collapse into one event, which keeps the oldest timestamp for latency measurements
+        uint32_t& Count = EventCounts[PendingBufferIndex];
+        InputEvent* Event = Count > 0 ? &EventBuffers[PendingBufferIndex][Count - 1] : nullptr;
+        if (!Event || Event->Type != InputEventType::INPUT_EVENT_MOUSE_MOVE)
+        {
+            Event = PushEvent(InputEventType::INPUT_EVENT_MOUSE_MOVE, Timestamp);
+        }
+
+        if (Event)
+        {
+            Event->X = X;
+            Event->Y = Y;
+        }
+    }
+}
+
+void InputSystem::ProcessMouseRawMotion(float DeltaX, float DeltaY, double Timestamp)
+{
+    MouseLiveState.RawDeltaX += DeltaX;
+    MouseLiveState.RawDeltaY += DeltaY;
+    MouseLiveState.bHasRawMotion = true;
+
+    // Accumulated like cursor moves, the event keeps the oldest timestamp
+    uint32_t& Count = EventCounts[PendingBufferIndex];
+    InputEvent* Event = Count > 0 ? &EventBuffers[PendingBufferIndex][Count - 1] : nullptr;
+    if (!Event || Event->Type != InputEventType::INPUT_EVENT_MOUSE_RAW_MOTION)
+    {
+        Event = PushEvent(InputEventType::INPUT_EVENT_MOUSE_RAW_MOTION, Timestamp);
+    }
+
+    if (Event)
+    {
+        Event->DeltaX += DeltaX;
+        Event->DeltaY += DeltaY;
     }
 }
 
-void InputSystem::ProcessMouseWheel(int8_t WheelDelta)
+void InputSystem::ProcessMouseWheel(int8_t WheelDelta, double Timestamp)
 {
+    MouseLiveState.WheelDelta += WheelDelta;
+
+    if (InputEvent* Event = PushEvent(InputEventType::INPUT_EVENT_MOUSE_WHEEL, Timestamp))
+    {
+        Event->X = WheelDelta;
+    }
+
     EventContext Context;
     Context.Data.u8[0] = WheelDelta;
     EventSystem::Get()->FireEvent(EVENT_CODE_MOUSE_WHEEL, this, Context);
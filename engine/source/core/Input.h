@@ -2,6 +2,9 @@
 
 #include "Defines.h"
 
+#include "MlokUtils.h"
+#include "InputMapping.h"
+
 enum class MouseButton
 {
     MOUSE_BUTTON_LEFT,
@@ -144,6 +147,60 @@ typedef enum KeyboardKey
     KEYS_MAX_KEYS
 } KeyboardKey;
 
+#define KEY_MASK_WORD_COUNT 4 // 256 keys
+
+// One bit per key code
+typedef struct KeyMask
+{
+    uint64_t Words[KEY_MASK_WORD_COUNT];
+} KeyMask;
+
+MINLINE bool KeyMaskTest(const KeyMask& Mask, uint32_t Key)
+{
+    return (Mask.Words[(Key >> 6) & (KEY_MASK_WORD_COUNT - 1)] >> (Key & 63)) & 1;
+}
+
+MINLINE void KeyMaskSet(KeyMask& Mask, uint32_t Key, bool bValue)
+{
+    const uint64_t Bit = 1ull << (Key & 63);
+    uint64_t& Word = Mask.Words[(Key >> 6) & (KEY_MASK_WORD_COUNT - 1)];
+    Word = bValue ? (Word | Bit) : (Word & ~Bit);
+}
+
+MINLINE bool KeyMaskIsEmpty(const KeyMask& Mask)
+{
+    uint64_t Combined = 0;
+    for (uint32_t i = 0; i < KEY_MASK_WORD_COUNT; ++i)
+    {
+        Combined |= Mask.Words[i];
+    }
+    return Combined == 0;
+}
+
+#define INPUT_EVENT_BUFFER_SIZE 256
+
+enum class InputEventType : uint8_t
+{
+    INPUT_EVENT_KEY,
+    INPUT_EVENT_MOUSE_BUTTON,
+    INPUT_EVENT_MOUSE_MOVE,
+    INPUT_EVENT_MOUSE_WHEEL,
+    INPUT_EVENT_MOUSE_RAW_MOTION
+};
+
+// One input transition, in the order the platform delivered them
+typedef struct InputEvent
+{
+    double Timestamp;       // Platform::GetAbsoluteTime taken when the message was pumped
+    InputEventType Type;
+    bool bPressed;          // Keys and buttons
+    uint16_t Code;          // KeyboardKey or MouseButton
+    int16_t X;              // Cursor position for moves, wheel steps for the wheel
+    int16_t Y;
+    float DeltaX;           // Raw motion, unaccelerated device units
+    float DeltaY;
+} InputEvent;
+
 class MAPI InputSystem
 {
     public:
@@ -152,8 +209,26 @@ class MAPI InputSystem
         static void Initialize(size_t* outMemReq, void* Ptr);
         static void Shutdown();
 
+        // Latches everything processed since the previous call as the new frame state and resolves actions and axes.
+        // Called once per frame right after the platform messages are pumped.
         void Update(double DeltaTime);
 
+        // Compiles the mapping into lookup tables, replacing the previous one. Ids returned by Find* are invalidated.
+        bool LoadMapping(const InputMappingConfig& Config);
+
+        // Lookups are linear, resolve ids once and keep them
+        InputActionId FindAction(const char* Name) const;
+        InputAxisId FindAxis(const char* Name) const;
+
+        bool IsActionDown(InputActionId Action) const;
+        bool IsActionPressed(InputActionId Action) const; // Went down this frame
+        bool IsActionReleased(InputActionId Action) const; // Went up this frame
+        float GetAxisValue(InputAxisId Axis) const;
+
+        // Every transition latched by the last Update, including the ones that didn't survive until the frame state
+        // (a key tapped within one frame). Returns the event count.
+        uint32_t GetFrameEvents(const InputEvent** OutEvents) const;
+
         bool IsKeyDown(KeyboardKey Key);
         bool IsKeyUp(KeyboardKey Key);
         bool WasKeyDown(KeyboardKey Key); // On the previous frame
@@ -164,7 +239,22 @@ class MAPI InputSystem
         bool WasKeyDown(const char KeyChar); // On the previous frame
         bool WasKeyUp(const char KeyChar); // On the previous frame
 
-        void ProcessKey(KeyboardKey Key, bool bPressed);
+        // Went down/up since the previous frame, true for taps shorter than a frame as well
+        bool IsKeyPressed(KeyboardKey Key);
+        bool IsKeyReleased(KeyboardKey Key);
+
+        // Whole-word masks of keys that went down, up or either way since the previous frame
+        void GetPressedKeys(KeyMask* OutMask) const;
+        void GetReleasedKeys(KeyMask* OutMask) const;
+        void GetChangedKeys(KeyMask* OutMask) const;
+
+        // Visits the same keys as GetChangedKeys: Func(KeyboardKey Key, bool bDown) with the key's current state,
+        // so a tap shorter than a frame is visited with bDown false
+        template<typename TFunc>
+        void ForEachChangedKey(TFunc&& Func) const;
+
+        // Timestamp is the time the platform message was pumped
+        void ProcessKey(KeyboardKey Key, bool bPressed, double Timestamp);
 
         bool IsMouseButtonDown(MouseButton Button);
         bool IsMouseButtonUp(MouseButton Button);
@@ -173,27 +263,98 @@ class MAPI InputSystem
         void GetMousePosition(int32_t* X, int32_t* Y);
         void GetPreviousMousePosition(int32_t* X, int32_t* Y); // On the previous frame
 
-        void ProcessMouseButton(MouseButton Button, bool bPressed);
-        void ProcessMouseMove(int16_t X, int16_t Y);
-        void ProcessMouseWheel(int8_t WheelDelta);
+        // Motion accumulated over the last frame. Raw device motion (unaccelerated, sub-pixel) when the platform
+        // delivers it, the cursor position difference otherwise.
+        void GetMouseDelta(float* X, float* Y);
+
+        void ProcessMouseButton(MouseButton Button, bool bPressed, double Timestamp);
+        void ProcessMouseMove(int16_t X, int16_t Y, double Timestamp);
+        void ProcessMouseRawMotion(float DeltaX, float DeltaY, double Timestamp);
+        void ProcessMouseWheel(int8_t WheelDelta, double Timestamp);
 
     private:
+        void ResolveMapping();
+        InputEvent* PushEvent(InputEventType Type, double Timestamp);
+
         typedef struct KeyboardState
         {
-            bool Keys[256]; // TODO: maybe replace with bitmask
+            KeyMask Keys;
+            KeyMask Pressed;    // Edges since the previous frame
+            KeyMask Released;
         } KeyboardState;
 
         typedef struct MouseState
         {
             int16_t XPos;
             int16_t YPos;
+            int16_t WheelDelta; // Accumulated since the previous frame
+            float RawDeltaX;    // Accumulated since the previous frame
+            float RawDeltaY;
+            bool bHasRawMotion; // Set once the platform delivered raw motion
             uint16_t Buttons[static_cast<size_t>(MouseButton::MOUSE_BUTTON_MAX)];
         } MouseState;
 
+        // Compiled bindings of one action, resolving it is a handful of ANDs
+        typedef struct ActionEntry
+        {
+            KeyMask Keys;
+            uint8_t Buttons; // One bit per MouseButton
+        } ActionEntry;
+
+        typedef struct AxisEntry
+        {
+            KeyMask PositiveKeys;
+            KeyMask NegativeKeys;
+            uint8_t PositiveButtons;
+            uint8_t NegativeButtons;
+            float MouseXScale;
+            float MouseYScale;
+            float WheelScale;
+        } AxisEntry;
+
+        // Platform messages land in the live state, Update latches it, so the state is stable during a frame
+        KeyboardState KeyboardLiveState;
         KeyboardState KeyboardCurrentState;
         KeyboardState KeyboardPreviousState;
+        MouseState MouseLiveState;
         MouseState MouseCurrentState;
         MouseState MousePreviousState;
 
+        ActionEntry Actions[INPUT_MAX_ACTIONS];
+        AxisEntry Axes[INPUT_MAX_AXES];
+        uint16_t ActionCount;
+        uint16_t AxisCount;
+
+        uint64_t ActionsCurrent[INPUT_MAX_ACTIONS / 64];
+        uint64_t ActionsPrevious[INPUT_MAX_ACTIONS / 64];
+        float AxisValues[INPUT_MAX_AXES];
+
+        // Platform messages are appended to the pending buffer, Update swaps it with the frame one
+        InputEvent EventBuffers[2][INPUT_EVENT_BUFFER_SIZE];
+        uint32_t EventCounts[2];
+        uint32_t PendingBufferIndex;
+        uint32_t DroppedEventCount;
+
+        char ActionNames[INPUT_MAX_ACTIONS][INPUT_MAPPING_NAME_LENGTH];
+        char AxisNames[INPUT_MAX_AXES][INPUT_MAPPING_NAME_LENGTH];
+
         static InputSystem* Instance;
-};
\ No newline at end of file
+};
+
+template<typename TFunc>
+void InputSystem::ForEachChangedKey(TFunc&& Func) const
+{
+    for (uint32_t WordIdx = 0; WordIdx < KEY_MASK_WORD_COUNT; ++WordIdx)
+    {
+        const uint64_t Current = KeyboardCurrentState.Keys.Words[WordIdx];
+        uint64_t Changed = KeyboardCurrentState.Pressed.Words[WordIdx] | KeyboardCurrentState.Released.Words[WordIdx];
+
+        while (Changed)
+        {
+            const uint32_t Bit = MlokUtils::CountTrailingZeros(Changed);
+            Changed &= Changed - 1;
+
+            Func(static_cast<KeyboardKey>(WordIdx * 64 + Bit), ((Current >> Bit) & 1) != 0);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Defines.h"
+
+#define INPUT_MAX_ACTIONS 128 // Must be a multiple of 64
+#define INPUT_MAX_AXES 32
+#define INPUT_MAPPING_NAME_LENGTH 32
+#define INPUT_INVALID_ID 0xFFFF
+
+#define INPUT_ACTION_QUIT "Quit" // Bound to KEY_ESCAPE by the Application unless the mapping defines it
+
+typedef uint16_t InputActionId;
+typedef uint16_t InputAxisId;
+
+enum class InputBindingSource
+{
+    INPUT_BINDING_KEY,              // Code is a KeyboardKey
+    INPUT_BINDING_MOUSE_BUTTON,     // Code is a MouseButton
+    INPUT_BINDING_MOUSE_X,          // Cursor movement in pixels since the previous frame
+    INPUT_BINDING_MOUSE_Y,
+    INPUT_BINDING_MOUSE_WHEEL       // Wheel steps since the previous frame
+};
+
+typedef struct InputBinding
+{
+    InputBindingSource Source;
+    uint16_t Code;
+    float Scale = 1.f; // Axes only: sign picks the direction of a key or button, mouse deltas are multiplied by it
+} InputBinding;
+
+typedef struct InputActionDesc
+{
+    std::string Name;
+    std::vector<InputBinding> Bindings; // The action is down while any of them is down, mouse axes are ignored
+} InputActionDesc;
+
+typedef struct InputAxisDesc
+{
+    std::string Name;
+    std::vector<InputBinding> Bindings;
+} InputAxisDesc;
+
+// Human readable mapping, only used while loading. InputSystem compiles it into flat tables.
+typedef struct InputMappingConfig
+{
+    std::vector<InputActionDesc> Actions;
+    std::vector<InputAxisDesc> Axes;
+} InputMappingConfig;
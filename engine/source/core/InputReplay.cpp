@@ -0,0 +1,163 @@
+#include "InputReplay.h"
+
+#include "Input.h"
+#include "Event.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#define INPUT_REPLAY_MAX_LINE 256
+
+MINLINE bool ParsePressed(const char* State, bool* bOutPressed)
+{
+    if (std::strcmp(State, "down") == 0)
+    {
+        *bOutPressed = true;
+        return true;
+    }
+    if (std::strcmp(State, "up") == 0)
+    {
+        *bOutPressed = false;
+        return true;
+    }
+    return false;
+}
+
+bool InputReplay::Load(const std::string& Path)
+{
+    FILE* File = std::fopen(Path.c_str(), "r");
+    if (!File)
+    {
+        MlokError("Failed to open input replay %s", Path.c_str());
+        return false;
+    }
+
+    Events.clear();
+    Cursor = 0;
+
+    char Line[INPUT_REPLAY_MAX_LINE];
+    uint32_t LineNumber = 0;
+    bool bResult = true;
+
+    while (std::fgets(Line, sizeof(Line), File))
+    {
+        ++LineNumber;
+        Line[std::strcspn(Line, "\r\n")] = '\0';
+
+        if (char* Comment = std::strchr(Line, '#'))
+        {
+            *Comment = '\0';
+        }
+
+        unsigned long long Frame = 0;
+        char Command[16] = {};
+        char Arg0[32] = {};
+        char Arg1[32] = {};
+        const int32_t Fields = std::sscanf(Line, "%llu %15s %31s %31s", &Frame, Command, Arg0, Arg1);
+        if (Fields <= 0)
+        {
+            continue; // Empty line
+        }
+
+        InputReplayEvent Event {};
+        Event.Frame = Frame;
+
+        bool bValid = Fields >= 2;
+        if (bValid && std::strcmp(Command, "key") == 0)
+        {
+            Event.Command = InputReplayCommand::INPUT_REPLAY_KEY;
+            Event.Code = static_cast<uint16_t>(std::strtoul(Arg0, nullptr, 0));
+            bValid = Fields == 4 && Event.Code < KEYS_MAX_KEYS && ParsePressed(Arg1, &Event.bPressed);
+        }
+        else if (bValid && std::strcmp(Command, "button") == 0)
+        {
+            Event.Command = InputReplayCommand::INPUT_REPLAY_BUTTON;
+            Event.Code = static_cast<uint16_t>(std::strtoul(Arg0, nullptr, 0));
+            bValid = Fields == 4 && Event.Code < static_cast<uint16_t>(MouseButton::MOUSE_BUTTON_MAX) && ParsePressed(Arg1, &Event.bPressed);
+        }
+        else if (bValid && std::strcmp(Command, "move") == 0)
+        {
+            Event.Command = InputReplayCommand::INPUT_REPLAY_MOVE;
+            Event.X = static_cast<int16_t>(std::atoi(Arg0));
+            Event.Y = static_cast<int16_t>(std::atoi(Arg1));
+            bValid = Fields == 4;
+        }
+        else if (bValid && std::strcmp(Command, "wheel") == 0)
+        {
+            Event.Command = InputReplayCommand::INPUT_REPLAY_WHEEL;
+            Event.X = static_cast<int16_t>(std::atoi(Arg0));
+            bValid = Fields == 3;
+        }
+        else if (bValid && std::strcmp(Command, "quit") == 0)
+        {
+            Event.Command = InputReplayCommand::INPUT_REPLAY_QUIT;
+        }
+        else
+        {
+            bValid = false;
+        }
+
+        if (!bValid)
+        {
+            MlokError("Input replay %s:%u: can't parse '%s'", Path.c_str(), LineNumber, Line);
+            bResult = false;
+            break;
+        }
+
+        Events.push_back(Event);
+    }
+
+    std::fclose(File);
+
+    if (!bResult)
+    {
+        Events.clear();
+        return false;
+    }
+
+    // Commands of the same frame keep their file order
+    std::stable_sort(Events.begin(), Events.end(), [](const InputReplayEvent& A, const InputReplayEvent& B) { return A.Frame < B.Frame; });
+
+    MlokInfo("Input replay %s loaded: %zu events", Path.c_str(), Events.size());
+
+    return true;
+}
+
+void InputReplay::Play(uint64_t Frame, double Timestamp)
+{
+    InputSystem* Input = InputSystem::Get();
+
+    for (; Cursor < Events.size() && Events[Cursor].Frame <= Frame; ++Cursor)
+    {
+        const InputReplayEvent& Event = Events[Cursor];
+        switch (Event.Command)
+        {
+            case InputReplayCommand::INPUT_REPLAY_KEY:
+                Input->ProcessKey(static_cast<KeyboardKey>(Event.Code), Event.bPressed, Timestamp);
+                break;
+            case InputReplayCommand::INPUT_REPLAY_BUTTON:
+                Input->ProcessMouseButton(static_cast<MouseButton>(Event.Code), Event.bPressed, Timestamp);
+                break;
+            case InputReplayCommand::INPUT_REPLAY_MOVE:
+                Input->ProcessMouseMove(Event.X, Event.Y, Timestamp);
+                break;
+            case InputReplayCommand::INPUT_REPLAY_WHEEL:
+                Input->ProcessMouseWheel(static_cast<int8_t>(Event.X), Timestamp);
+                break;
+            case InputReplayCommand::INPUT_REPLAY_QUIT:
+                {
+                    EventContext Data {};
+                    EventSystem::Get()->FireEvent(EVENT_CODE_APPLICATION_QUIT, nullptr, Data);
+                }
+                break;
+        }
+    }
+}
+
+bool InputReplay::IsFinished() const
+{
+    return Cursor >= Events.size();
+}
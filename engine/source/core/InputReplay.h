@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Defines.h"
+
+enum class InputReplayCommand : uint8_t
+{
+    INPUT_REPLAY_KEY,
+    INPUT_REPLAY_BUTTON,
+    INPUT_REPLAY_MOVE,
+    INPUT_REPLAY_WHEEL,
+    INPUT_REPLAY_QUIT
+};
+
+typedef struct InputReplayEvent
+{
+    uint64_t Frame;
+    InputReplayCommand Command;
+    bool bPressed;
+    uint16_t Code;
+    int16_t X;
+    int16_t Y;
+} InputReplayEvent;
+
+// Drives the InputSystem from a script instead of the platform, one command per line:
+//     <frame> key <KeyboardKey code> down|up
+//     <frame> button <MouseButton index> down|up
+//     <frame> move <x> <y>
+//     <frame> wheel <steps>
+//     <frame> quit
+// Frames are counted from the first frame of Application::Run, '#' starts a comment.
+class MAPI InputReplay
+{
+    public:
+        bool Load(const std::string& Path);
+
+        // Feeds every event scheduled up to the frame
+        void Play(uint64_t Frame, double Timestamp);
+
+        bool IsFinished() const;
+
+    private:
+        std::vector<InputReplayEvent> Events;
+        size_t Cursor = 0;
+};
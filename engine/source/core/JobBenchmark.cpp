@@ -0,0 +1,146 @@
+#include "JobBenchmark.h"
+
+#include "JobSystem.h"
+#include "Logger.h"
+#include "platform/Platform.h"
+
+#include <algorithm>
+
+#define JOB_BENCHMARK_FLAT_JOBS 1024     // Fits the deque of the submitting thread
+#define JOB_BENCHMARK_ITERATIONS 16000  // Per job, a few tens of microseconds of integer work
+#define JOB_BENCHMARK_TREE_LEAF 16      // Leaves of the fork/join tree, in jobs worth of work
+#define JOB_BENCHMARK_REPEATS 3         // Best of
+
+typedef struct BenchmarkFlatData
+{
+    uint64_t Seed;
+    uint64_t Result;
+} BenchmarkFlatData;
+
+typedef struct BenchmarkTreeData
+{
+    uint32_t First;
+    uint32_t Count;
+    uint64_t Result;
+} BenchmarkTreeData;
+
+static uint64_t BenchmarkWork(uint64_t Seed)
+{
+    // xorshift chain, the compiler can't fold it away
+    uint64_t Value = Seed | 1;
+    for (uint32_t i = 0; i < JOB_BENCHMARK_ITERATIONS; ++i)
+    {
+        Value ^= Value << 13;
+        Value ^= Value >> 7;
+        Value ^= Value << 17;
+    }
+    return Value;
+}
+
+static void BenchmarkFlatJob(void* Data)
+{
+    BenchmarkFlatData* Flat = static_cast<BenchmarkFlatData*>(Data);
+    Flat->Result = BenchmarkWork(Flat->Seed);
+}
+
+static void BenchmarkTreeJob(void* Data)
+{
+    BenchmarkTreeData* Node = static_cast<BenchmarkTreeData*>(Data);
+
+    if (Node->Count <= JOB_BENCHMARK_TREE_LEAF)
+    {
+        Node->Result = 0;
+        for (uint32_t i = 0; i < Node->Count; ++i)
+        {
+            Node->Result ^= BenchmarkWork(Node->First + i);
+        }
+        return;
+    }
+
+    const uint32_t Half = Node->Count / 2;
+    BenchmarkTreeData Children[2] = { { Node->First, Half, 0 }, { Node->First + Half, Node->Count - Half, 0 } };
+
+    JobCounter Counter;
+    JobSystem::Get()->Run({ BenchmarkTreeJob, &Children[0] }, &Counter);
+    BenchmarkTreeJob(&Children[1]);
+    JobSystem::Get()->Wait(&Counter);
+
+    Node->Result = Children[0].Result ^ Children[1].Result;
+}
+
+static uint64_t BenchmarkFlat(std::vector<JobDesc>& Jobs)
+{
+    JobCounter Counter;
+
+    const uint64_t Start = Platform::Get()->GetAbsoluteTimeNs();
+    JobSystem::Get()->Run(Jobs.data(), static_cast<uint32_t>(Jobs.size()), &Counter);
+    JobSystem::Get()->Wait(&Counter);
+    return Platform::Get()->GetAbsoluteTimeNs() - Start;
+}
+
+static uint64_t BenchmarkTree()
+{
+    BenchmarkTreeData Root { 0, JOB_BENCHMARK_FLAT_JOBS, 0 };
+
+    const uint64_t Start = Platform::Get()->GetAbsoluteTimeNs();
+    BenchmarkTreeJob(&Root);
+    return Platform::Get()->GetAbsoluteTimeNs() - Start;
+}
+
+void RunJobSystemBenchmark()
+{
+    JobSystem* Jobs = JobSystem::Get();
+    if (!Jobs || !Platform::Get())
+    {
+        MlokError("Job system benchmark needs the Job system and the Platform to be initialized");
+        return;
+    }
+
+    std::vector<BenchmarkFlatData> FlatData(JOB_BENCHMARK_FLAT_JOBS);
+    std::vector<JobDesc> FlatJobs(JOB_BENCHMARK_FLAT_JOBS);
+    for (uint32_t i = 0; i < JOB_BENCHMARK_FLAT_JOBS; ++i)
+    {
+        FlatData[i] = { i, 0 };
+        FlatJobs[i] = { BenchmarkFlatJob, &FlatData[i] };
+    }
+
+    const uint32_t PreviousActive = Jobs->GetActiveThreadCount();
+    const uint32_t ThreadCount = Jobs->GetThreadCount();
+
+    MlokInfo("Job system benchmark: %u jobs of %u iterations, best of %u", JOB_BENCHMARK_FLAT_JOBS, JOB_BENCHMARK_ITERATIONS, JOB_BENCHMARK_REPEATS);
+
+    uint64_t FlatBaseline = 0;
+    uint64_t TreeBaseline = 0;
+    for (uint32_t Threads = 1; ; Threads = std::min(Threads * 2, ThreadCount))
+    {
+        Jobs->SetActiveThreadCount(Threads);
+
+        uint64_t FlatBest = UINT64_MAX;
+        uint64_t TreeBest = UINT64_MAX;
+        for (uint32_t Repeat = 0; Repeat < JOB_BENCHMARK_REPEATS; ++Repeat)
+        {
+            FlatBest = std::min(FlatBest, BenchmarkFlat(FlatJobs));
+            TreeBest = std::min(TreeBest, BenchmarkTree());
+        }
+
+        if (Threads == 1)
+        {
+            FlatBaseline = FlatBest;
+            TreeBaseline = TreeBest;
+        }
+
+        const double FlatSpeedup = static_cast<double>(FlatBaseline) / FlatBest;
+        const double TreeSpeedup = static_cast<double>(TreeBaseline) / TreeBest;
+        MlokInfo("    %2u threads: flat %8.2f ms x%5.2f (%3.0f%%), fork/join %8.2f ms x%5.2f (%3.0f%%)",
+                 Threads,
+                 FlatBest * 1e-6, FlatSpeedup, 100.0 * FlatSpeedup / Threads,
+                 TreeBest * 1e-6, TreeSpeedup, 100.0 * TreeSpeedup / Threads);
+
+        if (Threads == ThreadCount)
+        {
+            break;
+        }
+    }
+
+    Jobs->SetActiveThreadCount(PreviousActive);
+}
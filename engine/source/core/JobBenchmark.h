@@ -0,0 +1,7 @@
+#pragma once
+
+#include "Defines.h"
+
+// Runs a fixed workload on 1, 2, 4 ... all job system threads and logs time, speedup and efficiency.
+// Two workloads: a flat batch of independent jobs, and a fork/join tree that waits inside jobs and relies on stealing.
+MAPI void RunJobSystemBenchmark();
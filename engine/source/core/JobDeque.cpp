@@ -0,0 +1,81 @@
+#include "JobDeque.h"
+
+#define JOB_DEQUE_MASK (JOB_DEQUE_CAPACITY - 1)
+
+void JobDeque::Initialize()
+{
+    Top.store(0, std::memory_order_relaxed);
+    Bottom.store(0, std::memory_order_relaxed);
+}
+
+bool JobDeque::Push(const Job& NewJob)
+{
+    const int64_t B = Bottom.load(std::memory_order_relaxed);
+    const int64_t T = Top.load(std::memory_order_acquire);
+    if (B - T >= JOB_DEQUE_CAPACITY)
+    {
+        return false;
+    }
+
+    JobSlot& Slot = Slots[B & JOB_DEQUE_MASK];
+    Slot.Entry.store(NewJob.Entry, std::memory_order_relaxed);
+    Slot.Data.store(NewJob.Data, std::memory_order_relaxed);
+    Slot.Counter.store(NewJob.Counter, std::memory_order_relaxed);
+
+    // Publishes the slot to thieves that acquire Bottom
+    Bottom.store(B + 1, std::memory_order_release);
+    return true;
+}
+
+bool JobDeque::Pop(Job* outJob)
+{
+    const int64_t B = Bottom.load(std::memory_order_relaxed) - 1;
+    Bottom.store(B, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t T = Top.load(std::memory_order_relaxed);
+
+    if (T > B)
+    {
+        Bottom.store(B + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    LoadSlot(B, outJob);
+    if (T == B)
+    {
+        // Last job, race the thieves for it
+        const bool bWon = Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        Bottom.store(B + 1, std::memory_order_relaxed);
+        return bWon;
+    }
+
+    return true;
+}
+
+bool JobDeque::Steal(Job* outJob)
+{
+    int64_t T = Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t B = Bottom.load(std::memory_order_acquire);
+
+    if (T >= B)
+    {
+        return false;
+    }
+
+    LoadSlot(T, outJob);
+    return Top.compare_exchange_strong(T, T + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+bool JobDeque::IsEmpty() const
+{
+    return Bottom.load(std::memory_order_relaxed) <= Top.load(std::memory_order_relaxed);
+}
+
+void JobDeque::LoadSlot(int64_t Index, Job* outJob) const
+{
+    const JobSlot& Slot = Slots[Index & JOB_DEQUE_MASK];
+    outJob->Entry = Slot.Entry.load(std::memory_order_relaxed);
+    outJob->Data = Slot.Data.load(std::memory_order_relaxed);
+    outJob->Counter = Slot.Counter.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Defines.h"
+
+#include "MlokMemory.h"
+
+#include <atomic>
+
+#define JOB_DEQUE_CAPACITY 1024 // Per thread and priority, must be a power of two
+
+typedef void (*PFN_JobEntry)(void* Data);
+
+struct JobCounter;
+
+typedef struct Job
+{
+    PFN_JobEntry Entry;
+    void* Data;
+    JobCounter* Counter;
+} Job;
+
+// Chase-Lev work-stealing deque with a fixed capacity (the C11 formulation by Le et al.).
+// The owner thread pushes and pops at the bottom, any thread steals from the top.
+class JobDeque
+{
+    public:
+        void Initialize();
+
+        // Owner only. Returns false when full.
+        bool Push(const Job& NewJob);
+        // Owner only, newest job first
+        bool Pop(Job* outJob);
+        // Any thread, oldest job first. Fails when empty or when another thread won the race for the job.
+        bool Steal(Job* outJob);
+
+        bool IsEmpty() const;
+
+    private:
+        // Slots are atomics, so a thief reading a slot the owner is overwriting is a benign race
+        typedef struct JobSlot
+        {
+            std::atomic<PFN_JobEntry> Entry;
+            std::atomic<void*> Data;
+            std::atomic<JobCounter*> Counter;
+        } JobSlot;
+
+        void LoadSlot(int64_t Index, Job* outJob) const;
+
+        alignas(MLOK_CACHE_LINE_SIZE) std::atomic<int64_t> Top;
+        alignas(MLOK_CACHE_LINE_SIZE) std::atomic<int64_t> Bottom;
+        alignas(MLOK_CACHE_LINE_SIZE) JobSlot Slots[JOB_DEQUE_CAPACITY];
+};
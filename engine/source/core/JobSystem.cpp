@@ -0,0 +1,606 @@
+#include "JobSystem.h"
+
+#include "Logger.h"
+#include "MlokUtils.h"
+#include "platform/Platform.h"
+#include "platform/PlatformCpu.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+JobSystem* JobSystem::Instance = nullptr;
+
+static thread_local uint32_t CurrentThreadIndex = JOB_SYSTEM_FOREIGN_THREAD;
+
+// A fiber can resume on another thread, code that runs across a switch reads the index through this call
+// so the compiler can't reuse the previous thread's thread local address
+static MNOINLINE uint32_t ReadCurrentThreadIndex()
+{
+    return CurrentThreadIndex;
+}
+
+MINLINE void ExecuteJob(const Job& JobToRun)
+{
+    JobToRun.Entry(JobToRun.Data);
+    if (JobToRun.Counter)
+    {
+        JobToRun.Counter->Value.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+JobSystem* JobSystem::Get()
+{
+    return Instance;
+}
+
+uint32_t JobSystem::ResolveThreadCount(const JobSystemConfig& Config)
+{
+    // SMT siblings share a core's execution units, a second thread per core mostly adds contention
+    const uint32_t Count = Config.ThreadCount > 0 ? Config.ThreadCount : PlatformGetCpuTopology().PhysicalCoreCount;
+    return std::clamp<uint32_t>(Count, 1, JOB_SYSTEM_MAX_THREADS);
+}
+
+bool JobSystem::Initialize(size_t* outMemReq, void* Ptr, const JobSystemConfig& Config)
+{
+    const uint32_t Threads = ResolveThreadCount(Config);
+    const size_t DequeCount = static_cast<size_t>(Threads) * static_cast<size_t>(JobPriority::JOB_PRIORITY_MAX);
+    const size_t DequesOffset = AlignUp(sizeof(JobSystem), MLOK_CACHE_LINE_SIZE);
+
+    // Every worker holds a fiber, the rest are for suspended jobs
+    const uint32_t Fibers = Config.bFibers ? std::max(Config.FiberCount, Threads * 2) : 0;
+    const size_t FibersOffset = DequesOffset + DequeCount * sizeof(JobDeque);
+    const size_t FreeFibersOffset = FibersOffset + Fibers * sizeof(JobFiber);
+    const size_t WaitingFibersOffset = FreeFibersOffset + Fibers * sizeof(uint32_t);
+
+    // Fiber stacks are mapped by the platform, each with its own guard page
+    *outMemReq = WaitingFibersOffset + Fibers * sizeof(uint32_t);
+    if (Ptr == nullptr)
+    {
+        return true;
+    }
+
+    // Mutexes and threads need their constructors to run
+    Instance = new (Ptr) JobSystem();
+
+    Instance->Deques = reinterpret_cast<JobDeque*>(static_cast<uint8_t*>(Ptr) + DequesOffset);
+    for (size_t i = 0; i < DequeCount; ++i)
+    {
+        new (&Instance->Deques[i]) JobDeque();
+        Instance->Deques[i].Initialize();
+    }
+
+    Instance->ThreadCount = Threads;
+    Instance->ActiveThreadCount.store(Threads, std::memory_order_relaxed);
+    Instance->QueuedJobs.store(0, std::memory_order_relaxed);
+    Instance->SleepingMask.store(0, std::memory_order_relaxed);
+    Instance->bStopRequested.store(false, std::memory_order_relaxed);
+    Instance->SharedPending.store(0, std::memory_order_relaxed);
+
+    uint8_t* Memory = static_cast<uint8_t*>(Ptr);
+    Instance->bFibers = Config.bFibers;
+    Instance->FiberCount = Fibers;
+    Instance->Fibers = reinterpret_cast<JobFiber*>(Memory + FibersOffset);
+    Instance->FreeFibers = reinterpret_cast<uint32_t*>(Memory + FreeFibersOffset);
+    Instance->WaitingFibers = reinterpret_cast<uint32_t*>(Memory + WaitingFibersOffset);
+    Instance->FreeFiberCount = 0;
+    Instance->WaitingFiberCount.store(0, std::memory_order_relaxed);
+
+    for (uint32_t i = 0; i < Fibers; ++i)
+    {
+        JobFiber& Fiber = Instance->Fibers[i];
+        Fiber.WaitCounter = nullptr;
+        if (!PlatformCreateFiber(&Fiber.Context, Config.FiberStackSize, &JobSystem::FiberEntry, Instance))
+        {
+            MlokError("Failed to create job fiber %u of %u", i, Fibers);
+            for (uint32_t j = 0; j < i; ++j)
+            {
+                PlatformDestroyFiber(&Instance->Fibers[j].Context);
+            }
+            Instance->~JobSystem();
+            Instance = nullptr;
+            return false;
+        }
+        // Popped from the back, so the first workers get the first fibers
+        Instance->FreeFibers[Instance->FreeFiberCount++] = Fibers - 1 - i;
+    }
+
+    const CpuTopology& Topology = PlatformGetCpuTopology();
+    if (Config.bPinThreads && !PlatformThread::SetCurrentAffinity(Topology.PinOrder[0]))
+    {
+        MlokWarning("Couldn't pin the main thread to logical core %u", Topology.PinOrder[0]);
+    }
+
+    CurrentThreadIndex = 0;
+    for (uint32_t i = 1; i < Threads; ++i)
+    {
+        char Name[PLATFORM_THREAD_NAME_LENGTH];
+        std::snprintf(Name, sizeof(Name), "Mlok Job %u", i);
+        const uint32_t Core = Config.bPinThreads ? Topology.PinOrder[i % Topology.LogicalCoreCount] : PLATFORM_THREAD_ANY_CORE;
+
+        JobSystem* System = Instance;
+        if (Config.bFibers)
+        {
+            Instance->Workers[i].Start([System, i]() { System->FiberWorkerMain(i); }, Name, Core);
+        }
+        else
+        {
+            Instance->Workers[i].Start([System, i]() { System->WorkerLoop(i); }, Name, Core);
+        }
+    }
+
+    if (Config.bFibers)
+    {
+        MlokInfo("Job system started with %u threads and %u fibers of %u KiB", Threads, Fibers, Config.FiberStackSize / 1024);
+    }
+    else
+    {
+        MlokInfo("Job system started with %u threads", Threads);
+    }
+    return true;
+}
+
+void JobSystem::Shutdown()
+{
+    if (Instance == nullptr)
+    {
+        return;
+    }
+
+    Instance->bStopRequested.store(true);
+    Instance->WakeAllThreads();
+
+    for (uint32_t i = 1; i < Instance->ThreadCount; ++i)
+    {
+        Instance->Workers[i].Join();
+    }
+
+    const int64_t Abandoned = Instance->QueuedJobs.load(std::memory_order_relaxed);
+    if (Abandoned > 0)
+    {
+        MlokWarning("Job system shut down with %lld jobs still queued", Abandoned);
+    }
+
+    const uint32_t Suspended = Instance->WaitingFiberCount.load(std::memory_order_relaxed);
+    if (Suspended > 0)
+    {
+        MlokWarning("Job system shut down with %u jobs still waiting on fibers", Suspended);
+    }
+
+    for (uint32_t i = 0; i < Instance->FiberCount; ++i)
+    {
+        PlatformDestroyFiber(&Instance->Fibers[i].Context);
+    }
+
+    CurrentThreadIndex = JOB_SYSTEM_FOREIGN_THREAD;
+
+    Instance->~JobSystem();
+    Instance = nullptr;
+}
+
+void JobSystem::Run(const JobDesc* Jobs, uint32_t Count, JobCounter* Counter)
+{
+    if (Count == 0)
+    {
+        return;
+    }
+
+    // Before any job can finish and decrement it
+    if (Counter)
+    {
+        Counter->Value.fetch_add(Count, std::memory_order_relaxed);
+    }
+
+    const uint32_t ThreadIndex = CurrentThreadIndex;
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        Submit(ThreadIndex, Jobs[i].Priority, { Jobs[i].Entry, Jobs[i].Data, Counter });
+    }
+
+    WakeWorkers(Count);
+}
+
+void JobSystem::Run(const JobDesc& Desc, JobCounter* Counter)
+{
+    Run(&Desc, 1, Counter);
+}
+
+void JobSystem::Wait(JobCounter* Counter)
+{
+    if (Counter == nullptr)
+    {
+        return;
+    }
+
+    while (bFibers && Counter->Value.load(std::memory_order_acquire) > 0)
+    {
+        if (!SuspendFiber(Counter))
+        {
+            // Not on a worker fiber, or every fiber is taken
+            break;
+        }
+    }
+
+    const uint32_t ThreadIndex = ReadCurrentThreadIndex();
+    while (Counter->Value.load(std::memory_order_acquire) > 0)
+    {
+        if (!TryRunJob(ThreadIndex))
+        {
+            Platform::SpinPause();
+        }
+    }
+}
+
+bool JobSystem::RunPendingJob()
+{
+    return TryRunJob(ReadCurrentThreadIndex());
+}
+
+uint32_t JobSystem::GetThreadCount() const
+{
+    return ThreadCount;
+}
+
+void JobSystem::SetActiveThreadCount(uint32_t Count)
+{
+    ActiveThreadCount.store(std::clamp<uint32_t>(Count, 1, ThreadCount));
+    // Newly active threads look for work, newly inactive ones go back to sleep on their own
+    WakeAllThreads();
+}
+
+uint32_t JobSystem::GetActiveThreadCount() const
+{
+    return ActiveThreadCount.load(std::memory_order_relaxed);
+}
+
+uint32_t JobSystem::GetCurrentThreadIndex()
+{
+    return ReadCurrentThreadIndex();
+}
+
+void JobSystem::WorkerLoop(uint32_t ThreadIndex)
+{
+    CurrentThreadIndex = ThreadIndex;
+
+    uint32_t FailedSearches = 0;
+    while (!bStopRequested.load(std::memory_order_acquire))
+    {
+        if (ThreadIndex < ActiveThreadCount.load(std::memory_order_relaxed) && TryRunJob(ThreadIndex))
+        {
+            FailedSearches = 0;
+            continue;
+        }
+
+        Idle(&FailedSearches);
+    }
+}
+
+void JobSystem::Idle(uint32_t* FailedSearches)
+{
+    // Jobs tend to come in bursts, spin a little before paying for a sleep and a wake up
+    if (++(*FailedSearches) < JOB_SYSTEM_SPIN_COUNT)
+    {
+        Platform::SpinPause();
+        return;
+    }
+    *FailedSearches = 0;
+
+    // Nothing signals a suspended fiber's counter reaching zero, workers keep polling while any is waiting
+    if (WaitingFiberCount.load(std::memory_order_relaxed) > 0)
+    {
+        std::this_thread::yield();
+        return;
+    }
+
+    const uint32_t ThreadIndex = ReadCurrentThreadIndex();
+    const uint64_t Bit = 1ull << ThreadIndex;
+
+    // Sequentially consistent with Submit and WakeWorkers: either the waker sees the bit, or the job
+    // it queued is visible here
+    SleepingMask.fetch_or(Bit);
+    const bool bWorkLeft = bStopRequested.load() || (ThreadIndex < ActiveThreadCount.load() && QueuedJobs.load() > 0);
+    if (bWorkLeft && (SleepingMask.fetch_and(~Bit) & Bit))
+    {
+        return;
+    }
+
+    // Either there is no work, or a waker already took the bit and its post is on the way
+    WakeSemaphores[ThreadIndex].Wait();
+}
+
+bool JobSystem::WakeThread(uint32_t ThreadIndex)
+{
+    const uint64_t Bit = 1ull << ThreadIndex;
+    if ((SleepingMask.fetch_and(~Bit) & Bit) == 0)
+    {
+        return false;
+    }
+
+    WakeSemaphores[ThreadIndex].Post();
+    return true;
+}
+
+void JobSystem::WakeAllThreads()
+{
+    for (uint64_t Mask = SleepingMask.load(); Mask != 0; Mask &= Mask - 1)
+    {
+        WakeThread(MlokUtils::CountTrailingZeros(Mask));
+    }
+}
+
+bool JobSystem::TryRunJob(uint32_t ThreadIndex)
+{
+    Job NextJob;
+    if (!FindJob(ThreadIndex, &NextJob))
+    {
+        return false;
+    }
+
+    ExecuteJob(NextJob);
+    return true;
+}
+
+bool JobSystem::FindJob(uint32_t ThreadIndex, Job* outJob)
+{
+    const bool bOwnsDeques = ThreadIndex < ThreadCount;
+    // Thieves start right after themselves, so they don't all hammer the same victim
+    const uint32_t FirstVictim = bOwnsDeques ? ThreadIndex + 1 : 0;
+
+    for (uint32_t PriorityIdx = 0; PriorityIdx < static_cast<uint32_t>(JobPriority::JOB_PRIORITY_MAX); ++PriorityIdx)
+    {
+        const JobPriority Priority = static_cast<JobPriority>(PriorityIdx);
+
+        bool bFound = bOwnsDeques && GetDeque(ThreadIndex, Priority).Pop(outJob);
+        bFound = bFound || (SharedPending.load(std::memory_order_relaxed) > 0 && PopShared(Priority, outJob));
+
+        for (uint32_t i = 0; i < ThreadCount && !bFound; ++i)
+        {
+            const uint32_t Victim = (FirstVictim + i) % ThreadCount;
+            bFound = Victim != ThreadIndex && GetDeque(Victim, Priority).Steal(outJob);
+        }
+
+        if (bFound)
+        {
+            QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::Submit(uint32_t ThreadIndex, JobPriority Priority, const Job& NewJob)
+{
+    const bool bQueued = (ThreadIndex < ThreadCount && GetDeque(ThreadIndex, Priority).Push(NewJob)) || PushShared(Priority, NewJob);
+    if (!bQueued)
+    {
+        // Every queue is full, running it right away still makes progress
+        ExecuteJob(NewJob);
+        return;
+    }
+
+    // Sequentially consistent with the sleepers' SleepingMask update, see Idle
+    QueuedJobs.fetch_add(1);
+}
+
+void JobSystem::WakeWorkers(uint32_t JobCount)
+{
+    const uint32_t Active = ActiveThreadCount.load(std::memory_order_relaxed);
+    const uint64_t ActiveMask = Active >= 64 ? ~0ull : (1ull << Active) - 1;
+
+    // One sleeper per job, a job taken by an awake thread makes its sleeper search once and go back to sleep
+    for (uint64_t Mask = SleepingMask.load() & ActiveMask; Mask != 0 && JobCount > 0; Mask &= Mask - 1)
+    {
+        JobCount -= WakeThread(MlokUtils::CountTrailingZeros(Mask)) ? 1 : 0;
+    }
+}
+
+JobDeque& JobSystem::GetDeque(uint32_t ThreadIndex, JobPriority Priority)
+{
+    return Deques[ThreadIndex * static_cast<uint32_t>(JobPriority::JOB_PRIORITY_MAX) + static_cast<uint32_t>(Priority)];
+}
+
+bool JobSystem::PushShared(JobPriority Priority, const Job& NewJob)
+{
+    const size_t PriorityIdx = static_cast<size_t>(Priority);
+
+    std::lock_guard<PlatformMutex> Lock(SharedMutex);
+    if (SharedCount[PriorityIdx] == JOB_SYSTEM_SHARED_QUEUE_CAPACITY)
+    {
+        return false;
+    }
+
+    SharedQueue[PriorityIdx][(SharedHead[PriorityIdx] + SharedCount[PriorityIdx]) % JOB_SYSTEM_SHARED_QUEUE_CAPACITY] = NewJob;
+    ++SharedCount[PriorityIdx];
+    SharedPending.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::PopShared(JobPriority Priority, Job* outJob)
+{
+    const size_t PriorityIdx = static_cast<size_t>(Priority);
+
+    std::lock_guard<PlatformMutex> Lock(SharedMutex);
+    if (SharedCount[PriorityIdx] == 0)
+    {
+        return false;
+    }
+
+    *outJob = SharedQueue[PriorityIdx][SharedHead[PriorityIdx]];
+    SharedHead[PriorityIdx] = (SharedHead[PriorityIdx] + 1) % JOB_SYSTEM_SHARED_QUEUE_CAPACITY;
+    --SharedCount[PriorityIdx];
+    SharedPending.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+void JobSystem::FiberEntry(void* Data)
+{
+    JobSystem* System = static_cast<JobSystem*>(Data);
+    System->CompleteFiberSwitch();
+    System->FiberLoop();
+}
+
+void JobSystem::FiberWorkerMain(uint32_t ThreadIndex)
+{
+    CurrentThreadIndex = ThreadIndex;
+
+    FiberThreadState& State = FiberThreads[ThreadIndex];
+    State.CurrentFiber = JOB_SYSTEM_INVALID_FIBER;
+    State.PendingFree = JOB_SYSTEM_INVALID_FIBER;
+    State.PendingWait = JOB_SYSTEM_INVALID_FIBER;
+
+    if (!PlatformConvertThreadToFiber(&State.ThreadFiber))
+    {
+        MlokWarning("Job thread %u couldn't become a fiber, it runs jobs without suspending", ThreadIndex);
+        WorkerLoop(ThreadIndex);
+        return;
+    }
+
+    // There are at least twice as many fibers as threads
+    SwitchFiber(ThreadIndex, TakeFreeFiber(), JOB_SYSTEM_INVALID_FIBER, JOB_SYSTEM_INVALID_FIBER);
+
+    // Back on the thread's own stack, the system is shutting down
+    PlatformConvertFiberToThread(&State.ThreadFiber);
+}
+
+void JobSystem::FiberLoop()
+{
+    uint32_t FailedSearches = 0;
+    for (;;)
+    {
+        const uint32_t ThreadIndex = ReadCurrentThreadIndex();
+        const uint32_t CurrentFiber = FiberThreads[ThreadIndex].CurrentFiber;
+
+        if (bStopRequested.load(std::memory_order_acquire))
+        {
+            SwitchFiber(ThreadIndex, JOB_SYSTEM_INVALID_FIBER, CurrentFiber, JOB_SYSTEM_INVALID_FIBER);
+            continue;
+        }
+
+        // Resumed jobs first, they hold on to stacks and are further along than anything queued.
+        // Inactive threads still resume them, they may be the only ones left.
+        const uint32_t ReadyFiber = TakeReadyFiber();
+        if (ReadyFiber != JOB_SYSTEM_INVALID_FIBER)
+        {
+            SwitchFiber(ThreadIndex, ReadyFiber, CurrentFiber, JOB_SYSTEM_INVALID_FIBER);
+            FailedSearches = 0;
+            continue;
+        }
+
+        if (ThreadIndex < ActiveThreadCount.load(std::memory_order_relaxed) && TryRunJob(ThreadIndex))
+        {
+            FailedSearches = 0;
+            continue;
+        }
+
+        Idle(&FailedSearches);
+    }
+}
+
+bool JobSystem::SuspendFiber(JobCounter* Counter)
+{
+    const uint32_t ThreadIndex = ReadCurrentThreadIndex();
+    // The main thread never leaves its own stack, the frame loop must stay on it
+    if (ThreadIndex == 0 || ThreadIndex >= ThreadCount)
+    {
+        return false;
+    }
+
+    const uint32_t CurrentFiber = FiberThreads[ThreadIndex].CurrentFiber;
+    if (CurrentFiber == JOB_SYSTEM_INVALID_FIBER)
+    {
+        return false;
+    }
+
+    uint32_t NextFiber = TakeReadyFiber();
+    if (NextFiber == JOB_SYSTEM_INVALID_FIBER)
+    {
+        NextFiber = TakeFreeFiber();
+    }
+    if (NextFiber == JOB_SYSTEM_INVALID_FIBER)
+    {
+        return false;
+    }
+
+    Fibers[CurrentFiber].WaitCounter = Counter;
+    SwitchFiber(ThreadIndex, NextFiber, JOB_SYSTEM_INVALID_FIBER, CurrentFiber);
+
+    // Resumed, possibly on another thread
+    return true;
+}
+
+void JobSystem::SwitchFiber(uint32_t ThreadIndex, uint32_t NextFiber, uint32_t FreedFiber, uint32_t WaitingFiber)
+{
+    FiberThreadState& State = FiberThreads[ThreadIndex];
+    PlatformFiber* From = GetFiberContext(ThreadIndex, State.CurrentFiber);
+    PlatformFiber* To = GetFiberContext(ThreadIndex, NextFiber);
+
+    State.PendingFree = FreedFiber;
+    State.PendingWait = WaitingFiber;
+    State.CurrentFiber = NextFiber;
+
+    PlatformSwitchFiber(From, To);
+
+    // State and ThreadIndex may belong to another thread by now
+    CompleteFiberSwitch();
+}
+
+void JobSystem::CompleteFiberSwitch()
+{
+    FiberThreadState& State = FiberThreads[ReadCurrentThreadIndex()];
+    if (State.PendingFree == JOB_SYSTEM_INVALID_FIBER && State.PendingWait == JOB_SYSTEM_INVALID_FIBER)
+    {
+        return;
+    }
+
+    std::lock_guard<PlatformMutex> Lock(FiberMutex);
+    if (State.PendingFree != JOB_SYSTEM_INVALID_FIBER)
+    {
+        FreeFibers[FreeFiberCount++] = State.PendingFree;
+        State.PendingFree = JOB_SYSTEM_INVALID_FIBER;
+    }
+    if (State.PendingWait != JOB_SYSTEM_INVALID_FIBER)
+    {
+        const uint32_t Waiting = WaitingFiberCount.load(std::memory_order_relaxed);
+        WaitingFibers[Waiting] = State.PendingWait;
+        WaitingFiberCount.store(Waiting + 1, std::memory_order_relaxed);
+        State.PendingWait = JOB_SYSTEM_INVALID_FIBER;
+    }
+}
+
+uint32_t JobSystem::TakeReadyFiber()
+{
+    if (WaitingFiberCount.load(std::memory_order_relaxed) == 0)
+    {
+        return JOB_SYSTEM_INVALID_FIBER;
+    }
+
+    std::lock_guard<PlatformMutex> Lock(FiberMutex);
+    const uint32_t Waiting = WaitingFiberCount.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < Waiting; ++i)
+    {
+        JobFiber& Fiber = Fibers[WaitingFibers[i]];
+        if (Fiber.WaitCounter->Value.load(std::memory_order_acquire) == 0)
+        {
+            const uint32_t Ready = WaitingFibers[i];
+            WaitingFibers[i] = WaitingFibers[Waiting - 1];
+            WaitingFiberCount.store(Waiting - 1, std::memory_order_relaxed);
+            Fiber.WaitCounter = nullptr;
+            return Ready;
+        }
+    }
+
+    return JOB_SYSTEM_INVALID_FIBER;
+}
+
+uint32_t JobSystem::TakeFreeFiber()
+{
+    std::lock_guard<PlatformMutex> Lock(FiberMutex);
+    return FreeFiberCount > 0 ? FreeFibers[--FreeFiberCount] : JOB_SYSTEM_INVALID_FIBER;
+}
+
+PlatformFiber* JobSystem::GetFiberContext(uint32_t ThreadIndex, uint32_t Fiber)
+{
+    return Fiber == JOB_SYSTEM_INVALID_FIBER ? &FiberThreads[ThreadIndex].ThreadFiber : &Fibers[Fiber].Context;
+}
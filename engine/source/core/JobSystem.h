@@ -0,0 +1,162 @@
+#pragma once
+
+#include "Defines.h"
+
+#include "JobDeque.h"
+#include "platform/PlatformFiber.h"
+#include "platform/PlatformThread.h"
+
+#include <atomic>
+
+#define JOB_SYSTEM_MAX_THREADS 64           // Workers plus the main thread, one bit each in the sleeping mask
+#define JOB_SYSTEM_SHARED_QUEUE_CAPACITY 1024
+#define JOB_SYSTEM_SPIN_COUNT 256           // Failed searches before a worker goes to sleep
+#define JOB_SYSTEM_FOREIGN_THREAD 0xFFFFFFFF
+#define JOB_SYSTEM_DEFAULT_FIBER_COUNT 128
+#define JOB_SYSTEM_DEFAULT_FIBER_STACK_SIZE (64 * 1024)    // Jobs with deep recursion or big locals need more, an overflow hits a guard page
+#define JOB_SYSTEM_INVALID_FIBER 0xFFFFFFFF
+
+enum class JobPriority
+{
+    JOB_PRIORITY_HIGH,
+    JOB_PRIORITY_NORMAL,
+    JOB_PRIORITY_LOW,
+
+    JOB_PRIORITY_MAX
+};
+
+// Fork/join: Run adds the number of jobs, each finished job subtracts one
+typedef struct JobCounter
+{
+    std::atomic<uint32_t> Value { 0 };
+} JobCounter;
+
+typedef struct JobDesc
+{
+    PFN_JobEntry Entry;
+    void* Data;
+    JobPriority Priority = JobPriority::JOB_PRIORITY_NORMAL;
+} JobDesc;
+
+typedef struct JobSystemConfig
+{
+    uint32_t ThreadCount = 0;   // Including the main thread, 0 picks one per physical core
+    bool bPinThreads = false;   // Pins every thread, the main thread included, to its own core (CpuTopology::PinOrder)
+
+    // Workers run jobs on pooled fibers and Wait parks the fiber instead of blocking the worker, so long
+    // dependency chains don't pin threads. The main thread and foreign threads keep helping while they wait.
+    bool bFibers = false;
+    uint32_t FiberCount = JOB_SYSTEM_DEFAULT_FIBER_COUNT;   // One per worker plus the most jobs waiting at once
+    uint32_t FiberStackSize = JOB_SYSTEM_DEFAULT_FIBER_STACK_SIZE;
+} JobSystemConfig;
+
+// Work-stealing job system, the standard way to run parallel work in the engine.
+// Every thread owns a deque per priority and takes its own newest jobs first, idle threads steal the oldest
+// jobs of the others. The main thread is thread 0 and runs jobs while it waits. Threads that are not part
+// of the system (e.g. the render thread) may submit and wait too, their jobs go through a shared queue.
+class MAPI JobSystem
+{
+    public:
+        static JobSystem* Get();
+
+        static bool Initialize(size_t* outMemReq, void* Ptr, const JobSystemConfig& Config);
+        static void Shutdown();
+
+        void Run(const JobDesc* Jobs, uint32_t Count, JobCounter* Counter = nullptr);
+        void Run(const JobDesc& Desc, JobCounter* Counter = nullptr);
+
+        // Runs other jobs until the counter reaches zero, so it can be called from inside a job.
+        // In fiber mode a job on a worker is suspended instead and may resume on another thread.
+        void Wait(JobCounter* Counter);
+
+        // Runs one queued job on the calling thread, for wait loops that have more to do than JobSystem::Wait.
+        // Returns false if nothing was queued.
+        bool RunPendingJob();
+
+        uint32_t GetThreadCount() const;
+
+        // Threads from Count on stop taking jobs and sleep, e.g. to measure scaling or to leave cores to others
+        void SetActiveThreadCount(uint32_t Count);
+        uint32_t GetActiveThreadCount() const;
+
+        // 0 is the main thread, JOB_SYSTEM_FOREIGN_THREAD for threads the system doesn't own
+        static uint32_t GetCurrentThreadIndex();
+
+    private:
+        typedef struct JobFiber
+        {
+            PlatformFiber Context;
+            JobCounter* WaitCounter;    // Set while the fiber is suspended in Wait
+        } JobFiber;
+
+        // Fibers can't be handed to the pools before the switch away from them is done, the fiber
+        // switched to does it
+        typedef struct FiberThreadState
+        {
+            PlatformFiber ThreadFiber;  // The worker's own stack, only returned to on shutdown
+            uint32_t CurrentFiber;
+            uint32_t PendingFree;
+            uint32_t PendingWait;
+        } FiberThreadState;
+
+        static uint32_t ResolveThreadCount(const JobSystemConfig& Config);
+
+        void WorkerLoop(uint32_t ThreadIndex);
+        void Idle(uint32_t* FailedSearches);
+        // Posts the thread's semaphore if it is asleep, false if it wasn't
+        bool WakeThread(uint32_t ThreadIndex);
+        void WakeAllThreads();
+        bool TryRunJob(uint32_t ThreadIndex);
+        bool FindJob(uint32_t ThreadIndex, Job* outJob);
+        void Submit(uint32_t ThreadIndex, JobPriority Priority, const Job& NewJob);
+        void WakeWorkers(uint32_t JobCount);
+
+        JobDeque& GetDeque(uint32_t ThreadIndex, JobPriority Priority);
+
+        // For foreign threads and full deques
+        bool PushShared(JobPriority Priority, const Job& NewJob);
+        bool PopShared(JobPriority Priority, Job* outJob);
+
+        // Fiber mode
+        static void FiberEntry(void* Data);
+        void FiberWorkerMain(uint32_t ThreadIndex);
+        void FiberLoop();
+        bool SuspendFiber(JobCounter* Counter);
+        void SwitchFiber(uint32_t ThreadIndex, uint32_t NextFiber, uint32_t FreedFiber, uint32_t WaitingFiber);
+        void CompleteFiberSwitch();
+        uint32_t TakeReadyFiber();
+        uint32_t TakeFreeFiber();
+        PlatformFiber* GetFiberContext(uint32_t ThreadIndex, uint32_t Fiber);
+
+        JobDeque* Deques;       // ThreadCount * JOB_PRIORITY_MAX, right behind the system in its memory
+        uint32_t ThreadCount;
+        std::atomic<uint32_t> ActiveThreadCount;
+
+        PlatformThread Workers[JOB_SYSTEM_MAX_THREADS];
+
+        std::atomic<int64_t> QueuedJobs;    // Submitted and not taken yet, lets sleeping workers tell if there is work
+        std::atomic<bool> bStopRequested;
+
+        // A bit per sleeping thread. Whoever clears another thread's bit posts its semaphore, exactly once,
+        // so a waker only wakes threads that are really asleep and never more than the jobs it submitted.
+        std::atomic<uint64_t> SleepingMask;
+        PlatformSemaphore WakeSemaphores[JOB_SYSTEM_MAX_THREADS];
+
+        PlatformMutex SharedMutex;
+        std::atomic<uint32_t> SharedPending;
+        Job SharedQueue[static_cast<size_t>(JobPriority::JOB_PRIORITY_MAX)][JOB_SYSTEM_SHARED_QUEUE_CAPACITY];
+        uint32_t SharedHead[static_cast<size_t>(JobPriority::JOB_PRIORITY_MAX)];
+        uint32_t SharedCount[static_cast<size_t>(JobPriority::JOB_PRIORITY_MAX)];
+
+        bool bFibers;
+        uint32_t FiberCount;
+        JobFiber* Fibers;           // These three follow the deques
+        uint32_t* FreeFibers;
+        uint32_t* WaitingFibers;
+        uint32_t FreeFiberCount;    // Guarded by FiberMutex
+        std::atomic<uint32_t> WaitingFiberCount;    // Written under FiberMutex, read without it to skip the lock
+        PlatformMutex FiberMutex;
+        FiberThreadState FiberThreads[JOB_SYSTEM_MAX_THREADS];
+
+        static JobSystem* Instance;
+};
@@ -0,0 +1,295 @@
+#include "LogFileSink.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef MPLATFORM_LINUX
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/uio.h>
+    #include <cerrno>
+#endif
+
+bool LogFileSink::Open(const LogFileConfig& Config, void* Memory)
+{
+    if (bIsOpen || Memory == nullptr || Config.FilePath.empty() || Config.FilePath.length() >= LOG_FILE_MAX_PATH - 8)
+    {
+        return false;
+    }
+
+    std::strncpy(Path, Config.FilePath.c_str(), LOG_FILE_MAX_PATH - 1);
+    Path[LOG_FILE_MAX_PATH - 1] = '\0';
+    MaxFileSize = Config.MaxFileSize;
+    MaxFiles = Config.MaxFiles;
+    SyncPolicy = Config.SyncPolicy;
+
+    // Keep the buffer block aligned, so it stays usable for O_DIRECT writes
+    const uintptr_t Address = reinterpret_cast<uintptr_t>(Memory);
+    Buffer = reinterpret_cast<char*>((Address + LOG_FILE_BLOCK_ALIGNMENT - 1) & ~static_cast<uintptr_t>(LOG_FILE_BLOCK_ALIGNMENT - 1));
+    BufferUsed = 0;
+    FileSize = 0;
+
+    // Every run starts with a fresh file, the previous one goes to the rotation chain
+    if (!Rotate())
+    {
+        return false;
+    }
+
+    bIsOpen = true;
+    return true;
+}
+
+void LogFileSink::Close()
+{
+    if (!bIsOpen)
+    {
+        return;
+    }
+
+    FlushBlocks(true);
+    CloseFile();
+
+    bIsOpen = false;
+}
+
+void LogFileSink::Write(const char* Data, size_t Size)
+{
+    if (!bIsOpen || Size == 0)
+    {
+        return;
+    }
+
+    if (MaxFileSize > 0 && FileSize + BufferUsed > 0 && FileSize + BufferUsed + Size > MaxFileSize)
+    {
+        if (!Rotate())
+        {
+            return;
+        }
+    }
+
+    if (BufferUsed + Size <= LOG_FILE_BUFFER_SIZE)
+    {
+        std::memcpy(Buffer + BufferUsed, Data, Size);
+        BufferUsed += Size;
+        return;
+    }
+
+    if (SyncPolicy == LogFileSyncPolicy::LOG_FILE_SYNC_DIRECT)
+    {
+        // Direct I/O can only write whole aligned blocks, so everything goes through the buffer
+        while (Size > 0)
+        {
+            const size_t Chunk = std::min(Size, static_cast<size_t>(LOG_FILE_BUFFER_SIZE) - BufferUsed);
+            std::memcpy(Buffer + BufferUsed, Data, Chunk);
+            BufferUsed += Chunk;
+            Data += Chunk;
+            Size -= Chunk;
+
+            if (BufferUsed == LOG_FILE_BUFFER_SIZE)
+            {
+                FlushBlocks(false);
+            }
+        }
+        return;
+    }
+
+    // Buffer contents and the new message leave in one call
+    WriteOut(Data, Size);
+}
+
+void LogFileSink::Flush()
+{
+    if (!bIsOpen)
+    {
+        return;
+    }
+
+    FlushBlocks(SyncPolicy != LogFileSyncPolicy::LOG_FILE_SYNC_DIRECT);
+
+#ifdef MPLATFORM_LINUX
+    if (SyncPolicy == LogFileSyncPolicy::LOG_FILE_SYNC_DATA)
+    {
+        fdatasync(Fd);
+    }
+#else
+    std::fflush(static_cast<FILE*>(File));
+#endif
+}
+
+bool LogFileSink::OpenFile()
+{
+#ifdef MPLATFORM_LINUX
+    int32_t Flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (SyncPolicy == LogFileSyncPolicy::LOG_FILE_SYNC_DIRECT)
+    {
+        Flags |= O_DIRECT;
+    }
+
+    Fd = open(Path, Flags, 0644);
+    if (Fd < 0 && SyncPolicy == LogFileSyncPolicy::LOG_FILE_SYNC_DIRECT)
+    {
+        // Some file systems (tmpfs for one) refuse O_DIRECT, fall back to the page cache
+        SyncPolicy = LogFileSyncPolicy::LOG_FILE_SYNC_DATA;
+        Fd = open(Path, Flags & ~O_DIRECT, 0644);
+    }
+
+    return Fd >= 0;
+#else
+    File = std::fopen(Path, "wb");
+    return File != nullptr;
+#endif
+}
+
+void LogFileSink::CloseFile()
+{
+#ifdef MPLATFORM_LINUX
+    if (Fd >= 0)
+    {
+        if (SyncPolicy != LogFileSyncPolicy::LOG_FILE_SYNC_NONE)
+        {
+            fdatasync(Fd);
+        }
+        close(Fd);
+        Fd = -1;
+    }
+#else
+    if (File)
+    {
+        std::fclose(static_cast<FILE*>(File));
+        File = nullptr;
+    }
+#endif
+}
+
+bool LogFileSink::Rotate()
+{
+    if (bIsOpen)
+    {
+        FlushBlocks(true);
+        CloseFile();
+    }
+
+    char From[LOG_FILE_MAX_PATH];
+    char To[LOG_FILE_MAX_PATH];
+
+    if (MaxFiles > 0)
+    {
+        std::snprintf(To, LOG_FILE_MAX_PATH, "%s.%u", Path, MaxFiles);
+        std::remove(To);
+
+        for (uint32_t i = MaxFiles - 1; i > 0; --i)
+        {
+            std::snprintf(From, LOG_FILE_MAX_PATH, "%s.%u", Path, i);
+            std::snprintf(To, LOG_FILE_MAX_PATH, "%s.%u", Path, i + 1);
+            std::rename(From, To);
+        }
+
+        std::snprintf(To, LOG_FILE_MAX_PATH, "%s.1", Path);
+        std::rename(Path, To);
+    }
+
+    FileSize = 0;
+
+    if (!OpenFile())
+    {
+        bIsOpen = false;
+        return false;
+    }
+
+    return true;
+}
+
+void LogFileSink::WriteOut(const char* Data, size_t Size)
+{
+#ifdef MPLATFORM_LINUX
+    struct iovec Vectors[2];
+    Vectors[0].iov_base = Buffer;
+    Vectors[0].iov_len = BufferUsed;
+    Vectors[1].iov_base = const_cast<char*>(Data);
+    Vectors[1].iov_len = Size;
+
+    struct iovec* Current = Vectors[0].iov_len > 0 ? &Vectors[0] : &Vectors[1];
+    int32_t Count = static_cast<int32_t>(&Vectors[2] - Current);
+
+    while (Count > 0)
+    {
+        ssize_t Written = writev(Fd, Current, Count);
+        if (Written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        FileSize += static_cast<size_t>(Written);
+
+        // Skip what was written, the kernel may stop in the middle of a vector
+        while (Count > 0 && static_cast<size_t>(Written) >= Current->iov_len)
+        {
+            Written -= Current->iov_len;
+            ++Current;
+            --Count;
+        }
+        if (Count > 0)
+        {
+            Current->iov_base = static_cast<char*>(Current->iov_base) + Written;
+            Current->iov_len -= Written;
+        }
+    }
+#else
+    FILE* Handle = static_cast<FILE*>(File);
+    FileSize += std::fwrite(Buffer, 1, BufferUsed, Handle);
+    FileSize += std::fwrite(Data, 1, Size, Handle);
+#endif
+
+    BufferUsed = 0;
+}
+
+void LogFileSink::FlushBlocks(bool bFlushTail)
+{
+    if (BufferUsed == 0)
+    {
+        return;
+    }
+
+#ifdef MPLATFORM_LINUX
+    if (SyncPolicy == LogFileSyncPolicy::LOG_FILE_SYNC_DIRECT)
+    {
+        const size_t BlocksSize = BufferUsed & ~static_cast<size_t>(LOG_FILE_BLOCK_ALIGNMENT - 1);
+        size_t Offset = 0;
+        while (Offset < BlocksSize)
+        {
+            ssize_t Written = write(Fd, Buffer + Offset, BlocksSize - Offset);
+            if (Written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+            Offset += static_cast<size_t>(Written);
+        }
+
+        FileSize += Offset;
+        BufferUsed -= Offset;
+        if (BufferUsed > 0)
+        {
+            std::memmove(Buffer, Buffer + Offset, BufferUsed);
+        }
+
+        if (!bFlushTail || BufferUsed == 0)
+        {
+            return;
+        }
+
+        // The unaligned tail can't go through O_DIRECT, it's only written right before the file is closed
+        fcntl(Fd, F_SETFL, fcntl(Fd, F_GETFL) & ~O_DIRECT);
+    }
+#endif
+
+    WriteOut(nullptr, 0);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Defines.h"
+
+#define LOG_FILE_BUFFER_SIZE (256 * 1024)
+#define LOG_FILE_BLOCK_ALIGNMENT 4096 // O_DIRECT requires block aligned buffers, sizes and offsets
+#define LOG_FILE_MAX_PATH 256
+
+enum class LogFileSyncPolicy
+{
+    LOG_FILE_SYNC_NONE,         // Leave write-back to the OS page cache
+    LOG_FILE_SYNC_DATA,         // fdatasync after every buffer flush
+    LOG_FILE_SYNC_DIRECT        // Bypass the page cache with O_DIRECT, only whole blocks are written until Close
+};
+
+typedef struct LogFileConfig
+{
+    std::string FilePath = "Mlok.log";
+    size_t MaxFileSize = 16 * 1024 * 1024;  // Rotate when the current file would grow past this size, 0 disables rotation
+    uint32_t MaxFiles = 4;                  // Number of rotated files kept next to the current one (Mlok.log.1 ... Mlok.log.N)
+    LogFileSyncPolicy SyncPolicy = LogFileSyncPolicy::LOG_FILE_SYNC_NONE;
+} LogFileConfig;
+
+// Buffered log file writer with size based rotation.
+// Lives inside the Logger memory block, so it keeps only trivial members and takes its buffer from the caller.
+class LogFileSink
+{
+    public:
+        static size_t GetMemoryRequirement() { return LOG_FILE_BUFFER_SIZE + LOG_FILE_BLOCK_ALIGNMENT; }
+
+        bool Open(const LogFileConfig& Config, void* Memory);
+        void Close();
+
+        void Write(const char* Data, size_t Size);
+        void Flush();
+
+        bool IsOpen() const { return bIsOpen; }
+
+    private:
+        bool OpenFile();
+        void CloseFile();
+        bool Rotate();
+
+        // Writes Data directly to the file, optionally batching it behind the pending buffer contents
+        void WriteOut(const char* Data, size_t Size);
+        void FlushBlocks(bool bFlushTail);
+
+        char Path[LOG_FILE_MAX_PATH];
+        size_t MaxFileSize;
+        uint32_t MaxFiles;
+        LogFileSyncPolicy SyncPolicy;
+
+        char* Buffer;
+        size_t BufferUsed;
+        size_t FileSize;
+
+    #ifdef MPLATFORM_LINUX
+        int32_t Fd;
+    #else
+        void* File;
+    #endif
+
+        bool bIsOpen;
+};
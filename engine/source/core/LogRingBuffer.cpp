@@ -0,0 +1,76 @@
+#include "LogRingBuffer.h"
+
+MINLINE size_t AlignRecordSize(size_t Size)
+{
+    return (Size + LOG_RECORD_ALIGNMENT - 1) & ~static_cast<size_t>(LOG_RECORD_ALIGNMENT - 1);
+}
+
+void LogRingBuffer::Initialize(void* Memory, size_t inCapacity)
+{
+    const uintptr_t Address = reinterpret_cast<uintptr_t>(Memory);
+    Data = reinterpret_cast<uint8_t*>(AlignRecordSize(Address));
+    Capacity = inCapacity;
+
+    Head.store(0, std::memory_order_relaxed);
+    Tail.store(0, std::memory_order_relaxed);
+    DroppedCount.store(0, std::memory_order_relaxed);
+    PendingHead = 0;
+}
+
+uint8_t* LogRingBuffer::Reserve(const LogFormatDescriptor* Descriptor, size_t PayloadSize)
+{
+    const size_t RecordSize = AlignRecordSize(sizeof(LogRecordHeader) + PayloadSize);
+    const uint64_t CurrentHead = Head.load(std::memory_order_relaxed);
+    const uint64_t CurrentTail = Tail.load(std::memory_order_acquire);
+
+    const size_t Offset = static_cast<size_t>(CurrentHead & (Capacity - 1));
+    const size_t Contiguous = Capacity - Offset;
+    const size_t Padding = RecordSize > Contiguous ? Contiguous : 0;
+
+    if (CurrentHead + Padding + RecordSize - CurrentTail > Capacity)
+    {
+        DroppedCount.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    uint8_t* Record = Data + Offset;
+    if (Padding > 0)
+    {
+        LogRecordHeader* PaddingHeader = reinterpret_cast<LogRecordHeader*>(Record);
+        PaddingHeader->Descriptor = nullptr;
+        PaddingHeader->Size = static_cast<uint32_t>(Padding);
+        Record = Data;
+    }
+
+    LogRecordHeader* Header = reinterpret_cast<LogRecordHeader*>(Record);
+    Header->Descriptor = Descriptor;
+    Header->Size = static_cast<uint32_t>(RecordSize);
+
+    PendingHead = CurrentHead + Padding + RecordSize;
+
+    return Record + sizeof(LogRecordHeader);
+}
+
+void LogRingBuffer::Commit()
+{
+    Head.store(PendingHead, std::memory_order_release);
+}
+
+const LogRecordHeader* LogRingBuffer::Peek()
+{
+    const uint64_t CurrentTail = Tail.load(std::memory_order_relaxed);
+    if (CurrentTail == Head.load(std::memory_order_acquire))
+    {
+        return nullptr;
+    }
+
+    return reinterpret_cast<const LogRecordHeader*>(Data + (CurrentTail & (Capacity - 1)));
+}
+
+void LogRingBuffer::Pop()
+{
+    const uint64_t CurrentTail = Tail.load(std::memory_order_relaxed);
+    const LogRecordHeader* Header = reinterpret_cast<const LogRecordHeader*>(Data + (CurrentTail & (Capacity - 1)));
+
+    Tail.store(CurrentTail + Header->Size, std::memory_order_release);
+}
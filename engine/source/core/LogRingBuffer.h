@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Defines.h"
+
+#include <atomic>
+
+#define LOG_DEFERRED_BUFFER_SIZE (1024 * 1024) // Must be a power of two
+#define LOG_RECORD_ALIGNMENT 16
+
+enum class LogLevel;
+
+typedef std::string (*PFN_LogDecode)(const char* Format, const uint8_t* Payload);
+
+// Registered once per call site, records only point to it
+typedef struct LogFormatDescriptor
+{
+    LogLevel Level;
+    const char* Format;
+    PFN_LogDecode Decode;
+} LogFormatDescriptor;
+
+typedef struct alignas(LOG_RECORD_ALIGNMENT) LogRecordHeader
+{
+    const LogFormatDescriptor* Descriptor; // nullptr marks padding before a wrap around
+    uint32_t Size; // Whole record size including the header
+} LogRecordHeader;
+
+// Single producer / single consumer byte ring for deferred log records.
+// Positions grow monotonically, so Head - Tail is always the used size.
+class LogRingBuffer
+{
+    public:
+        void Initialize(void* Memory, size_t inCapacity);
+
+        // Returns payload memory for a record or nullptr if the ring is full (the record is counted as dropped)
+        uint8_t* Reserve(const LogFormatDescriptor* Descriptor, size_t PayloadSize);
+        void Commit();
+
+        // Consumer side
+        const LogRecordHeader* Peek();
+        void Pop();
+
+        uint64_t ConsumeDroppedCount() { return DroppedCount.exchange(0, std::memory_order_relaxed); }
+
+    private:
+        uint8_t* Data;
+        size_t Capacity;
+
+        std::atomic<uint64_t> Head;
+        std::atomic<uint64_t> Tail;
+        std::atomic<uint64_t> DroppedCount;
+
+        uint64_t PendingHead;
+};
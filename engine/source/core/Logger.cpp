@@ -1,39 +1,291 @@
 #include "Logger.h"
 
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#ifdef MPLATFORM_LINUX
+    #include <unistd.h>
+    #define MlokIsTerminal(Stream) isatty(fileno(Stream))
+#else
+    #include <io.h>
+    #define MlokIsTerminal(Stream) _isatty(_fileno(Stream))
+#endif
+
 Logger* Logger::Instance = nullptr;
+std::thread::id Logger::DeferredProducerThread;
+
+// Sinks are shared by every thread that logs
+static std::mutex OutputMutex;
+
+static_assert(static_cast<size_t>(LogCategory::LOG_CATEGORY_MAX) == 7, "Default category levels must match LogCategory");
+std::atomic<uint8_t> Logger::CategoryLevels[static_cast<size_t>(LogCategory::LOG_CATEGORY_MAX)] = {
+    MLOK_LOG_COMPILE_LEVEL,
+    MLOK_LOG_COMPILE_LEVEL,
+    MLOK_LOG_COMPILE_LEVEL,
+    MLOK_LOG_COMPILE_LEVEL,
+    MLOK_LOG_COMPILE_LEVEL,
+    MLOK_LOG_COMPILE_LEVEL,
+    MLOK_LOG_COMPILE_LEVEL
+};
+
+static const char* CategoryNames[static_cast<size_t>(LogCategory::LOG_CATEGORY_MAX)] = {
+    "general", "event", "input", "memory", "platform", "renderer", "vulkan"
+};
+
+static const char* LevelNames[6] = { "fatal", "error", "warning", "info", "debug", "verbose" };
 
 Logger* Logger::Get()
 {
     return Instance;
 }
 
-bool Logger::Initialize(size_t* outMemReq, void* Ptr)
+bool Logger::Initialize(size_t* outMemReq, void* Ptr, const LoggerConfig& Config)
 {
     *outMemReq = sizeof(Logger);
+    if (Config.bFileOutput)
+    {
+        *outMemReq += LogFileSink::GetMemoryRequirement();
+    }
+    if (Config.bDeferredOutput)
+    {
+        *outMemReq += LOG_DEFERRED_BUFFER_SIZE + LOG_RECORD_ALIGNMENT;
+    }
+
     if (Ptr == nullptr)
     {
         return true;
     }
 
-    Instance = static_cast<Logger*>(Ptr);
-    // TODO: open File
+    // Constructed in place, the deferred ring's atomics need it
+    Instance = new (Ptr) Logger();
+
+    ParseCategoryLevels(Config.CategoryLevels);
+    if (const char* EnvLevels = std::getenv("MLOK_LOG"))
+    {
+        ParseCategoryLevels(EnvLevels);
+    }
+
+    Instance->bConsoleOutput = Config.bConsoleOutput;
+    Instance->bConsoleColors = Config.bConsoleColors && MlokIsTerminal(stdout) && MlokIsTerminal(stderr);
+    Instance->bFileOutput = false;
+    Instance->bDeferredOutput = false;
+
+    // File buffer and deferred ring are placed right behind the Logger itself
+    char* ExtraMemory = static_cast<char*>(Ptr) + sizeof(Logger);
+
+    if (Config.bDeferredOutput)
+    {
+        Instance->DeferredRing.Initialize(ExtraMemory, LOG_DEFERRED_BUFFER_SIZE);
+        DeferredProducerThread = std::this_thread::get_id();
+        Instance->bDeferredOutput = true;
+        ExtraMemory += LOG_DEFERRED_BUFFER_SIZE + LOG_RECORD_ALIGNMENT;
+    }
+
+    if (Config.bFileOutput)
+    {
+        void* FileBufferMemory = ExtraMemory;
+        if (!Instance->FileSink.Open(Config.File, FileBufferMemory))
+        {
+            Instance->bConsoleOutput = true;
+            Instance->MError("Failed to open log file: %s", Config.File.FilePath.c_str());
+            return false;
+        }
+        Instance->bFileOutput = true;
+    }
 
     return true;
 }
 
 void Logger::Shutdown()
 {
-    // TODO: close file
+    Instance->ProcessDeferred();
 
+    if (Instance->bFileOutput)
+    {
+        Instance->FileSink.Close();
+        Instance->bFileOutput = false;
+    }
+
+    Instance->~Logger();
     Instance = nullptr;
 }
 
+void Logger::SetCategoryLevel(const LogCategory Category, LogLevel Level)
+{
+    if (static_cast<int32_t>(Level) < static_cast<int32_t>(LogLevel::LOG_LEVEL_ERROR))
+    {
+        Level = LogLevel::LOG_LEVEL_ERROR;
+    }
+
+    CategoryLevels[static_cast<size_t>(Category)].store(static_cast<uint8_t>(Level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::GetCategoryLevel(const LogCategory Category)
+{
+    return static_cast<LogLevel>(CategoryLevels[static_cast<size_t>(Category)].load(std::memory_order_relaxed));
+}
+
+void Logger::SetAllCategoriesLevel(LogLevel Level)
+{
+    for (size_t i = 0; i < static_cast<size_t>(LogCategory::LOG_CATEGORY_MAX); ++i)
+    {
+        SetCategoryLevel(static_cast<LogCategory>(i), Level);
+    }
+}
+
+bool Logger::ParseCategoryLevels(const std::string& Spec)
+{
+    bool bResult = true;
+    size_t Start = 0;
+
+    while (Start < Spec.length())
+    {
+        size_t End = Spec.find(',', Start);
+        if (End == std::string::npos)
+        {
+            End = Spec.length();
+        }
+
+        std::string Entry = Spec.substr(Start, End - Start);
+        Start = End + 1;
+
+        for (char& Char : Entry)
+        {
+            Char = static_cast<char>(std::tolower(static_cast<unsigned char>(Char)));
+        }
+        if (Entry.empty())
+        {
+            continue;
+        }
+
+        const size_t Separator = Entry.find('=');
+        const std::string CategoryName = Separator != std::string::npos ? Entry.substr(0, Separator) : std::string();
+        const std::string LevelName = Separator != std::string::npos ? Entry.substr(Separator + 1) : Entry;
+
+        int32_t LevelIdx = -1;
+        for (int32_t i = 0; i < 6; ++i)
+        {
+            if (LevelName == LevelNames[i] || (i == 2 && LevelName == "warn"))
+            {
+                LevelIdx = i;
+                break;
+            }
+        }
+
+        if (LevelIdx < 0)
+        {
+            bResult = false;
+            continue;
+        }
+
+        if (CategoryName.empty() || CategoryName == "all")
+        {
+            SetAllCategoriesLevel(static_cast<LogLevel>(LevelIdx));
+            continue;
+        }
+
+        bool bFound = false;
+        for (size_t i = 0; i < static_cast<size_t>(LogCategory::LOG_CATEGORY_MAX); ++i)
+        {
+            if (CategoryName == CategoryNames[i])
+            {
+                SetCategoryLevel(static_cast<LogCategory>(i), static_cast<LogLevel>(LevelIdx));
+                bFound = true;
+                break;
+            }
+        }
+
+        bResult = bResult && bFound;
+    }
+
+    return bResult;
+}
+
+void Logger::Output(const LogLevel& Level, const std::string& Message)
+{
+    const bool bIsError = static_cast<int32_t>(Level) < static_cast<int32_t>(LogLevel::LOG_LEVEL_WARNING);
+    const size_t LevelIdx = static_cast<size_t>(Level);
+
+    std::lock_guard<std::mutex> Lock(OutputMutex);
+
+    if (bConsoleOutput)
+    {
+        std::ostream& Stream = bIsError ? std::cerr : std::cout;
+        if (bConsoleColors)
+        {
+            Stream << Level << Logger::Colors[LevelIdx] << Message << "\033[m" << '\n';
+        }
+        else
+        {
+            Stream << LevelStrings[LevelIdx] << Message << '\n';
+        }
+
+        if (bIsError)
+        {
+            Stream.flush();
+        }
+    }
+
+    if (bFileOutput)
+    {
+        const size_t LevelLength = std::strlen(LevelStrings[LevelIdx]);
+        FileSink.Write(LevelStrings[LevelIdx], LevelLength);
+        FileSink.Write(Message.data(), Message.length());
+        FileSink.Write("\n", 1);
+
+        if (bIsError)
+        {
+            FileSink.Flush();
+        }
+    }
+}
+
+void Logger::ProcessDeferred()
+{
+    if (!bDeferredOutput)
+    {
+        return;
+    }
+
+    while (const LogRecordHeader* Header = DeferredRing.Peek())
+    {
+        if (const LogFormatDescriptor* Descriptor = Header->Descriptor)
+        {
+            const uint8_t* Payload = reinterpret_cast<const uint8_t*>(Header) + sizeof(LogRecordHeader);
+            Output(Descriptor->Level, Descriptor->Decode(Descriptor->Format, Payload));
+        }
+        DeferredRing.Pop();
+    }
+
+    if (uint64_t Dropped = DeferredRing.ConsumeDroppedCount())
+    {
+        Output(LogLevel::LOG_LEVEL_WARNING, MlokUtils::StringFormat("Deferred log ring overflow, %llu messages dropped", Dropped));
+    }
+}
+
+void Logger::Flush()
+{
+    std::lock_guard<std::mutex> Lock(OutputMutex);
+
+    if (bConsoleOutput)
+    {
+        std::cout.flush();
+    }
+
+    if (bFileOutput)
+    {
+        FileSink.Flush();
+    }
+}
+
 std::ostream& operator<<(std::ostream& os, const LogLevel& Level)
 {
-    const char* LevelStrings[6] = { "FATAL: ", "ERROR: ", "WARN: ", "INFO: ", "DEBUG: ", "VERBOSE: " };
     const size_t LevelIdx = static_cast<size_t>(Level);
 
-    os << Logger::Colors[LevelIdx] << LevelStrings[LevelIdx] << "\033[m";
+    os << Logger::Colors[LevelIdx] << Logger::LevelStrings[LevelIdx] << "\033[m";
 
     return os;
 }
@@ -3,17 +3,40 @@
 #include "Defines.h"
 
 #include "MlokUtils.h"
+#include "LogFileSink.h"
+#include "LogRingBuffer.h"
 
+#include <atomic>
 #include <string>
 #include <iostream>
-
-#define LOG_WARNING_ENABLED
-#define LOG_INFO_ENABLED
-
-#ifndef MRELEASE
+#include <thread>
+
+// Compile-time floor, calls above this level are stripped entirely (values match LogLevel)
+#ifndef MLOK_LOG_COMPILE_LEVEL
+    #ifdef MRELEASE
+        #define MLOK_LOG_COMPILE_LEVEL 3
+    #else
+        #define MLOK_LOG_COMPILE_LEVEL 5
+    #endif // MRELEASE
+#endif // MLOK_LOG_COMPILE_LEVEL
+
+#if MLOK_LOG_COMPILE_LEVEL >= 2
+    #define LOG_WARNING_ENABLED
+#endif
+#if MLOK_LOG_COMPILE_LEVEL >= 3
+    #define LOG_INFO_ENABLED
+#endif
+#if MLOK_LOG_COMPILE_LEVEL >= 4
     #define LOG_DEBUG_ENABLED
+#endif
+#if MLOK_LOG_COMPILE_LEVEL >= 5
     #define LOG_VERBOSE_ENABLED
-#endif // MRELEASE
+#endif
+
+// Category used by the MlokInfo-style macros, a source file can define it before its includes
+#ifndef MLOK_LOG_CATEGORY
+    #define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_GENERAL
+#endif
 
 enum class LogLevel
 {
@@ -25,17 +48,71 @@ enum class LogLevel
     LOG_LEVEL_VERBOSE = 5
 };
 
+enum class LogCategory
+{
+    LOG_CATEGORY_GENERAL,
+    LOG_CATEGORY_EVENT,
+    LOG_CATEGORY_INPUT,
+    LOG_CATEGORY_MEMORY,
+    LOG_CATEGORY_PLATFORM,
+    LOG_CATEGORY_RENDERER,
+    LOG_CATEGORY_VULKAN,
+
+    LOG_CATEGORY_MAX
+};
+
+typedef struct LoggerConfig
+{
+    bool bConsoleOutput = true;
+    bool bConsoleColors = true; // Ignored when the output is not a terminal
+    bool bFileOutput = false;
+    bool bDeferredOutput = false; // Enables the MlokDeferred* macros, otherwise they log immediately
+    LogFileConfig File;
+
+    // Runtime category levels, e.g. "vulkan=verbose,renderer=debug" or just "warning" for every category.
+    // MLOK_LOG environment variable is applied on top of it.
+    std::string CategoryLevels;
+} LoggerConfig;
+
 class MAPI Logger
 {
     public:
         static Logger* Get();
 
-        static bool Initialize(size_t* outMemReq, void* Ptr);
+        static bool Initialize(size_t* outMemReq, void* Ptr, const LoggerConfig& Config = LoggerConfig());
         static void Shutdown();
 
         template<typename... TArgs>
         void LogOutput(const LogLevel& Level, const std::string& Message, TArgs&&... Args);
 
+        // Single branch checked before any argument evaluation
+        static bool IsEnabled(const LogCategory Category, const LogLevel Level)
+        {
+            return static_cast<uint8_t>(Level) <= CategoryLevels[static_cast<size_t>(Category)].load(std::memory_order_relaxed);
+        }
+
+        static void SetCategoryLevel(const LogCategory Category, LogLevel Level);
+        static LogLevel GetCategoryLevel(const LogCategory Category);
+        static void SetAllCategoriesLevel(LogLevel Level);
+
+        // Parses "category=level" pairs separated by commas, a bare level applies to every category
+        static bool ParseCategoryLevels(const std::string& Spec);
+
+        // Writes an already formatted message to the enabled sinks
+        void Output(const LogLevel& Level, const std::string& Message);
+
+        // Copies raw arguments into the deferred ring, formatting happens in ProcessDeferred.
+        // C strings, std::string and std::string_view are copied into the record and formatted as %s,
+        // every other argument must be trivially copyable.
+        template<typename... TArgs>
+        void LogDeferred(LogFormatDescriptor& Descriptor, TArgs&&... Args);
+
+        // Formats and outputs all pending deferred records
+        void ProcessDeferred();
+
+        // Pushes buffered file output to the OS (errors and fatals are flushed right away)
+        void Flush();
+
         template<typename... TArgs>
         constexpr void MFatal(const std::string& Message, TArgs&&... Args);
         template<typename... TArgs>
@@ -52,7 +129,16 @@ class MAPI Logger
         friend std::ostream& operator<<(std::ostream& os, const LogLevel& Level);
 
     private:
-        // TODO: add file handle
+        bool bConsoleOutput;
+        bool bConsoleColors;
+        bool bFileOutput;
+        bool bDeferredOutput;
+
+        // The deferred ring has a single producer, other threads log immediately
+        static std::thread::id DeferredProducerThread;
+
+        LogFileSink FileSink;
+        LogRingBuffer DeferredRing;
 
         static constexpr char Colors[6][6] = {
             "\033[41m",
@@ -63,6 +149,11 @@ class MAPI Logger
             "\033[37m"
         };
 
+        // Errors and fatals can't be filtered out at runtime. Read by every thread that logs, relaxed is enough.
+        static std::atomic<uint8_t> CategoryLevels[static_cast<size_t>(LogCategory::LOG_CATEGORY_MAX)];
+
+        static constexpr const char* LevelStrings[6] = { "FATAL: ", "ERROR: ", "WARN: ", "INFO: ", "DEBUG: ", "VERBOSE: " };
+
         static Logger* Instance;
 };
 
@@ -71,29 +162,81 @@ std::ostream& operator<<(std::ostream& os, const LogLevel& Level);
 #include "Logger.tcc"
 
 
-#define MlokFatal(Message, ...) (Logger::Get()->MFatal(Message, ##__VA_ARGS__))
-#define MlokError(Message, ...) (Logger::Get()->MError(Message, ##__VA_ARGS__))
+#define MlokLogOutput(Category, Level, Message, ...)                                                \
+        do                                                                                          \
+        {                                                                                           \
+            if (Logger::IsEnabled(Category, Level))                                                 \
+            {                                                                                       \
+                Logger::Get()->LogOutput(Level, Message, ##__VA_ARGS__);                            \
+            }                                                                                       \
+        } while (0)
+
+#define MlokLogFatal(Category, Message, ...) MlokLogOutput(Category, LogLevel::LOG_LEVEL_FATAL, Message, ##__VA_ARGS__)
+#define MlokLogError(Category, Message, ...) MlokLogOutput(Category, LogLevel::LOG_LEVEL_ERROR, Message, ##__VA_ARGS__)
+
+#ifdef LOG_WARNING_ENABLED
+    #define MlokLogWarning(Category, Message, ...) MlokLogOutput(Category, LogLevel::LOG_LEVEL_WARNING, Message, ##__VA_ARGS__)
+#else
+    #define MlokLogWarning(Category, Message, ...)
+#endif //LOG_WARNING_ENABLED
+
+#ifdef LOG_INFO_ENABLED
+    #define MlokLogInfo(Category, Message, ...) MlokLogOutput(Category, LogLevel::LOG_LEVEL_INFO, Message, ##__VA_ARGS__)
+#else
+    #define MlokLogInfo(Category, Message, ...)
+#endif //LOG_INFO_ENABLED
+
+#ifdef LOG_DEBUG_ENABLED
+    #define MlokLogDebug(Category, Message, ...) MlokLogOutput(Category, LogLevel::LOG_LEVEL_DEBUG, Message, ##__VA_ARGS__)
+#else
+    #define MlokLogDebug(Category, Message, ...)
+#endif //LOG_DEBUG_ENABLED
+
+#ifdef LOG_VERBOSE_ENABLED
+    #define MlokLogVerbose(Category, Message, ...) MlokLogOutput(Category, LogLevel::LOG_LEVEL_VERBOSE, Message, ##__VA_ARGS__)
+#else
+    #define MlokLogVerbose(Category, Message, ...)
+#endif //LOG_VERBOSE_ENABLED
+
+#define MlokFatal(Message, ...)     MlokLogFatal(MLOK_LOG_CATEGORY, Message, ##__VA_ARGS__)
+#define MlokError(Message, ...)     MlokLogError(MLOK_LOG_CATEGORY, Message, ##__VA_ARGS__)
+#define MlokWarning(Message, ...)   MlokLogWarning(MLOK_LOG_CATEGORY, Message, ##__VA_ARGS__)
+#define MlokInfo(Message, ...)      MlokLogInfo(MLOK_LOG_CATEGORY, Message, ##__VA_ARGS__)
+#define MlokDebug(Message, ...)     MlokLogDebug(MLOK_LOG_CATEGORY, Message, ##__VA_ARGS__)
+#define MlokVerbose(Message, ...)   MlokLogVerbose(MLOK_LOG_CATEGORY, Message, ##__VA_ARGS__)
+
+// Deferred logging: the call site registers a static descriptor once and every call only copies its arguments.
+// Message has to be a string literal, it's kept by pointer until the record is formatted.
+#define MlokLogDeferred(Category, Level, Message, ...)                                              \
+        do                                                                                          \
+        {                                                                                           \
+            if (Logger::IsEnabled(Category, Level))                                                 \
+            {                                                                                       \
+                static LogFormatDescriptor MlokDeferredDescriptor { Level, Message, nullptr };      \
+                Logger::Get()->LogDeferred(MlokDeferredDescriptor, ##__VA_ARGS__);                  \
+            }                                                                                       \
+        } while (0)
 
 #ifdef LOG_WARNING_ENABLED
-    #define MlokWarning(Message, ...) (Logger::Get()->MWarning(Message, ##__VA_ARGS__))
+    #define MlokDeferredWarning(Message, ...) MlokLogDeferred(MLOK_LOG_CATEGORY, LogLevel::LOG_LEVEL_WARNING, Message, ##__VA_ARGS__)
 #else
-    #define MlokWarning(Message, ...)
+    #define MlokDeferredWarning(Message, ...)
 #endif //LOG_WARNING_ENABLED
 
 #ifdef LOG_INFO_ENABLED
-    #define MlokInfo(Message, ...) (Logger::Get()->MInfo(Message, ##__VA_ARGS__))
+    #define MlokDeferredInfo(Message, ...) MlokLogDeferred(MLOK_LOG_CATEGORY, LogLevel::LOG_LEVEL_INFO, Message, ##__VA_ARGS__)
 #else
-    #define MlokInfo(Message, ...)
+    #define MlokDeferredInfo(Message, ...)
 #endif //LOG_INFO_ENABLED
 
 #ifdef LOG_DEBUG_ENABLED
-    #define MlokDebug(Message, ...) (Logger::Get()->MDebug(Message, ##__VA_ARGS__))
+    #define MlokDeferredDebug(Message, ...) MlokLogDeferred(MLOK_LOG_CATEGORY, LogLevel::LOG_LEVEL_DEBUG, Message, ##__VA_ARGS__)
 #else
-    #define MlokDebug(Message, ...)
+    #define MlokDeferredDebug(Message, ...)
 #endif //LOG_DEBUG_ENABLED
 
 #ifdef LOG_VERBOSE_ENABLED
-    #define MlokVerbose(Message, ...) (Logger::Get()->MVerbose(Message, ##__VA_ARGS__))
+    #define MlokDeferredVerbose(Message, ...) MlokLogDeferred(MLOK_LOG_CATEGORY, LogLevel::LOG_LEVEL_VERBOSE, Message, ##__VA_ARGS__)
 #else
-    #define MlokVerbose(Message, ...)
+    #define MlokDeferredVerbose(Message, ...)
 #endif //LOG_VERBOSE_ENABLED
\ No newline at end of file
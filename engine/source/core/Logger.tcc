@@ -1,21 +1,124 @@
 #pragma once
 
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
 std::ostream& operator<<(std::ostream& os, const LogLevel& Level);
 
+// Deferred record arguments are packed back to back, strings are stored inline with their terminator
+template<typename T>
+struct LogDeferredArg
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Deferred log arguments must be trivially copyable");
+
+    static size_t Size(const T&) { return sizeof(T); }
+
+    static void Store(uint8_t*& Cursor, const T& Value)
+    {
+        std::memcpy(Cursor, &Value, sizeof(T));
+        Cursor += sizeof(T);
+    }
+
+    static T Load(const uint8_t*& Cursor)
+    {
+        T Value;
+        std::memcpy(&Value, Cursor, sizeof(T));
+        Cursor += sizeof(T);
+        return Value;
+    }
+};
+
+template<>
+struct LogDeferredArg<const char*>
+{
+    static size_t Size(const char* Value) { return std::strlen(Value) + 1; }
+
+    static void Store(uint8_t*& Cursor, const char* Value)
+    {
+        const size_t Length = std::strlen(Value) + 1;
+        std::memcpy(Cursor, Value, Length);
+        Cursor += Length;
+    }
+
+    static const char* Load(const uint8_t*& Cursor)
+    {
+        const char* Value = reinterpret_cast<const char*>(Cursor);
+        Cursor += std::strlen(Value) + 1;
+        return Value;
+    }
+};
+
+template<>
+struct LogDeferredArg<char*> : public LogDeferredArg<const char*> {};
+
+// Stored like C strings and read back as one, the format sees a const char* for %s
+template<>
+struct LogDeferredArg<std::string_view>
+{
+    static size_t Size(std::string_view Value) { return Value.size() + 1; }
+
+    static void Store(uint8_t*& Cursor, std::string_view Value)
+    {
+        std::memcpy(Cursor, Value.data(), Value.size());
+        Cursor[Value.size()] = '\0';
+        Cursor += Value.size() + 1;
+    }
+
+    static const char* Load(const uint8_t*& Cursor) { return LogDeferredArg<const char*>::Load(Cursor); }
+};
+
+template<>
+struct LogDeferredArg<std::string> : public LogDeferredArg<std::string_view> {};
+
+template<typename... TArgs>
+std::string DecodeDeferredLog(const char* Format, const uint8_t* Payload)
+{
+    const uint8_t* Cursor = Payload;
+    // Braced initialization keeps the loads in argument order. Strings come back as const char*
+    std::tuple<decltype(LogDeferredArg<TArgs>::Load(Cursor))...> Values { LogDeferredArg<TArgs>::Load(Cursor)... };
+
+    return std::apply([Format](auto... Unpacked) { return MlokUtils::StringFormat(Format, Unpacked...); }, Values);
+}
+
 template<typename... TArgs>
 void Logger::LogOutput(const LogLevel& Level, const std::string& Message, TArgs&&... Args)
 {
-    bool bIsError = static_cast<int32_t>(Level) < static_cast<int32_t>(LogLevel::LOG_LEVEL_WARNING);
-    const size_t LevelIdx = static_cast<size_t>(Level);
-    
-    if (bIsError)
+    Output(Level, MlokUtils::StringFormat(Message, Args...));
+}
+
+template<typename... TArgs>
+void Logger::LogDeferred(LogFormatDescriptor& Descriptor, TArgs&&... Args)
+{
+    const size_t PayloadSize = (LogDeferredArg<std::decay_t<TArgs>>::Size(Args) + ... + 0);
+
+    // Packed and decoded the same way as a record, so string objects reach the format as C strings
+    if (!bDeferredOutput || std::this_thread::get_id() != DeferredProducerThread)
+    {
+        std::unique_ptr<uint8_t[]> Payload(new uint8_t[PayloadSize + 1]);
+        uint8_t* Cursor = Payload.get();
+        (LogDeferredArg<std::decay_t<TArgs>>::Store(Cursor, Args), ...);
+        Output(Descriptor.Level, DecodeDeferredLog<std::decay_t<TArgs>...>(Descriptor.Format, Payload.get()));
+        return;
+    }
+
+    if (Descriptor.Decode == nullptr)
     {
-        std::cerr << Level << Logger::Colors[LevelIdx] << MlokUtils::StringFormat(Message, Args...) << "\033[m" << std::endl;
+        Descriptor.Decode = &DecodeDeferredLog<std::decay_t<TArgs>...>;
     }
-    else
+
+    uint8_t* Cursor = DeferredRing.Reserve(&Descriptor, PayloadSize);
+    if (Cursor == nullptr)
     {
-        std::cout << Level << Logger::Colors[LevelIdx] << MlokUtils::StringFormat(Message, Args...) << "\033[m" << std::endl;
+        return;
     }
+
+    (LogDeferredArg<std::decay_t<TArgs>>::Store(Cursor, Args), ...);
+
+    DeferredRing.Commit();
 }
 
 template<typename... TArgs>
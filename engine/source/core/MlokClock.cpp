@@ -3,29 +3,39 @@
 
 void MlokClock::Update()
 {
-    if (StartTime != 0.f)
+    if (StartTime != 0)
     {
-        Elapsed = Platform::Get()->GetAbsoluteTime() - StartTime;
+        Elapsed = Platform::Get()->GetAbsoluteTimeNs() - StartTime;
     }
 }
 
 void MlokClock::Start()
 {
-    StartTime = Platform::Get()->GetAbsoluteTime();
-    Elapsed = 0.f;
+    StartTime = Platform::Get()->GetAbsoluteTimeNs();
+    Elapsed = 0;
 }
 
 void MlokClock::Stop()
 {
-    StartTime = 0.f;
+    StartTime = 0;
 }
 
 double MlokClock::GetStartTime() const
 {
-    return StartTime;
+    return static_cast<double>(StartTime) * 1e-9;
 }
 
 double MlokClock::GetElapsed() const
+{
+    return static_cast<double>(Elapsed) * 1e-9;
+}
+
+uint64_t MlokClock::GetStartTimeNs() const
+{
+    return StartTime;
+}
+
+uint64_t MlokClock::GetElapsedNs() const
 {
     return Elapsed;
 }
@@ -5,8 +5,8 @@
 class MAPI MlokClock
 {
     private:
-        double StartTime;
-        double Elapsed;
+        uint64_t StartTime; // Nanoseconds, 0 while stopped
+        uint64_t Elapsed;
 
     public:
         void Update();
@@ -15,4 +15,7 @@ class MAPI MlokClock
 
         double GetStartTime() const;
         double GetElapsed() const;
-};
\ No newline at end of file
+
+        uint64_t GetStartTimeNs() const;
+        uint64_t GetElapsedNs() const;
+};
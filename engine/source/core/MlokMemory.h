@@ -2,6 +2,30 @@
 
 #include "Defines.h"
 
+#define MLOK_CACHE_LINE_SIZE 64
+
+MINLINE size_t AlignUp(const size_t Size, const size_t Alignment)
+{
+    return (Size + Alignment - 1) & ~(Alignment - 1);
+}
+
+// Owns an object constructed with placement new in memory it doesn't free, e.g. a subsystem arena.
+// Only runs the destructor.
+template<typename T>
+struct PlacementDeleter
+{
+    void operator()(T* Ptr) const noexcept
+    {
+        if (Ptr)
+        {
+            Ptr->~T();
+        }
+    }
+};
+
+template<typename T>
+using PlacementPtr = std::unique_ptr<T, PlacementDeleter<T>>;
+
 typedef enum MemoryTag
 {
     MEMORY_TAG_UNKNOWN,
@@ -4,6 +4,10 @@
 
 #include <cstring>
 
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
 namespace MlokUtils
 {
     // TODO: replace with std::format after switching to c++20
@@ -43,6 +47,18 @@ namespace MlokUtils
         return (float)Bytes / 1024.f / 1024.f / 1024.f;
     }
 
+    // Index of the lowest set bit, Value must not be zero
+    MAPI MINLINE uint32_t CountTrailingZeros(uint64_t Value)
+    {
+#ifdef _MSC_VER
+        unsigned long Index;
+        _BitScanForward64(&Index, Value);
+        return static_cast<uint32_t>(Index);
+#else
+        return static_cast<uint32_t>(__builtin_ctzll(Value));
+#endif
+    }
+
     template<typename T>
     MAPI MINLINE T Clamp(const T Value, const T Min, const T Max)
     {
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Defines.h"
+
+#include "JobSystem.h"
+
+#define PARALLEL_FOR_SERIAL_THRESHOLD 256   // Shorter ranges run on the calling thread
+#define PARALLEL_FOR_CHUNKS_PER_THREAD 16   // Bounds the default grain, more chunks balance better but cost more grabs
+#define PARALLEL_REDUCE_FIXED_CHUNKS 64     // Chunk count of deterministic reductions, whatever the thread count
+
+typedef struct ParallelForOptions
+{
+    // Fewest indices a job takes at once. Larger when the body is tiny, so a grab isn't more expensive than the
+    // work it gets. 0 picks one from the range and the thread count.
+    uint32_t GrainSize = 0;
+    uint32_t SerialThreshold = PARALLEL_FOR_SERIAL_THRESHOLD;
+
+    // ParallelReduce only: chunk boundaries depend on the range alone and partial results are combined in index
+    // order, so floating point sums come out bit identical on any thread count. Costs a partial per chunk.
+    bool bDeterministic = false;
+
+    JobPriority Priority = JobPriority::JOB_PRIORITY_NORMAL;
+} ParallelForOptions;
+
+// Data-parallel loops on the job system. The calling thread takes part and the call returns when every index
+// is done; it can be called from inside a job. Jobs grab chunks off a shared cursor, large at first and
+// shrinking towards the grain as the range runs out, so uneven bodies still balance.
+// Without a running job system everything runs on the calling thread.
+
+// Body(uint32_t Index) for every index in [Begin, End)
+template<typename TBody>
+void ParallelFor(uint32_t Begin, uint32_t End, TBody&& Body, const ParallelForOptions& Options = ParallelForOptions());
+
+// Body(uint32_t ChunkBegin, uint32_t ChunkEnd), for bodies that set something up once per chunk
+template<typename TBody>
+void ParallelForRange(uint32_t Begin, uint32_t End, TBody&& Body, const ParallelForOptions& Options = ParallelForOptions());
+
+// Body(Element&) for every element of a contiguous container (data() and size(), e.g. std::vector)
+template<typename TContainer, typename TBody>
+void ParallelForEach(TContainer& Container, TBody&& Body, const ParallelForOptions& Options = ParallelForOptions());
+
+// Body(uint32_t Index, T& Accumulator) folds an index into an accumulator that starts as Identity,
+// Combine(const T&, const T&) -> T joins two partial results. Combine must be associative, Identity neutral.
+template<typename T, typename TBody, typename TCombine>
+T ParallelReduce(uint32_t Begin, uint32_t End, const T& Identity, TBody&& Body, TCombine&& Combine,
+                 const ParallelForOptions& Options = ParallelForOptions());
+
+#include "ParallelFor.tcc"
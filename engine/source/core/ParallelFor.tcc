@@ -0,0 +1,223 @@
+#pragma once
+
+#include "MlokMemory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+// Guided self-scheduling: every grab takes a share of what is left, never less than the grain
+typedef struct ParallelChunkCursor
+{
+    std::atomic<uint32_t> Next;
+    uint32_t End;
+    uint32_t Grain;
+    uint32_t Divisor;
+} ParallelChunkCursor;
+
+MINLINE bool ParallelNextChunk(ParallelChunkCursor& Cursor, uint32_t* outBegin, uint32_t* outEnd)
+{
+    uint32_t ChunkBegin = Cursor.Next.load(std::memory_order_relaxed);
+    while (ChunkBegin < Cursor.End)
+    {
+        const uint32_t Remaining = Cursor.End - ChunkBegin;
+        const uint32_t Size = std::min(Remaining, std::max(Cursor.Grain, Remaining / Cursor.Divisor));
+        if (Cursor.Next.compare_exchange_weak(ChunkBegin, ChunkBegin + Size, std::memory_order_relaxed))
+        {
+            *outBegin = ChunkBegin;
+            *outEnd = ChunkBegin + Size;
+            return true;
+        }
+    }
+    return false;
+}
+
+// A partial of ParallelReduce written by one job, on its own cache line. Also keeps std::vector<bool> out of it.
+template<typename T>
+struct alignas(MLOK_CACHE_LINE_SIZE) ParallelReduceSlot
+{
+    T Value;
+};
+
+// Jobs worth running for Count indices, 0 or 1 means the caller should just run the range itself
+MINLINE uint32_t ParallelJobCount(uint32_t Count, const ParallelForOptions& Options, uint32_t* outGrain)
+{
+    JobSystem* Jobs = JobSystem::Get();
+    const uint32_t Threads = Jobs ? Jobs->GetActiveThreadCount() : 1;
+    if (Threads < 2 || Count < Options.SerialThreshold)
+    {
+        return 1;
+    }
+
+    const uint32_t Grain = Options.GrainSize > 0 ? Options.GrainSize : std::max(1u, Count / (Threads * PARALLEL_FOR_CHUNKS_PER_THREAD));
+    *outGrain = Grain;
+    return std::min(Threads, (Count + Grain - 1) / Grain);
+}
+
+// Runs JobBody(ParallelChunkCursor&) on JobCount - 1 jobs and on the caller, each grabs chunks until none are left
+template<typename TJobBody>
+void ParallelRunJobs(uint32_t Begin, uint32_t End, uint32_t Grain, uint32_t JobCount, JobPriority Priority, TJobBody& JobBody)
+{
+    struct ParallelJobContext
+    {
+        ParallelChunkCursor Cursor;
+        TJobBody* JobBody;
+    };
+
+    ParallelJobContext Context;
+    Context.Cursor.Next.store(Begin, std::memory_order_relaxed);
+    Context.Cursor.End = End;
+    Context.Cursor.Grain = Grain;
+    Context.Cursor.Divisor = JobCount * 2;
+    Context.JobBody = &JobBody;
+
+    PFN_JobEntry Worker = [](void* Data)
+    {
+        ParallelJobContext* JobContext = static_cast<ParallelJobContext*>(Data);
+        (*JobContext->JobBody)(JobContext->Cursor);
+    };
+
+    JobDesc Descs[JOB_SYSTEM_MAX_THREADS];
+    for (uint32_t i = 0; i + 1 < JobCount; ++i)
+    {
+        Descs[i] = { Worker, &Context, Priority };
+    }
+
+    // The caller is the last worker, helpers that start late find the cursor already at the end
+    JobCounter Counter;
+    JobSystem::Get()->Run(Descs, JobCount - 1, &Counter);
+    Worker(&Context);
+    JobSystem::Get()->Wait(&Counter);
+}
+
+template<typename TBody>
+void ParallelForRange(uint32_t Begin, uint32_t End, TBody&& Body, const ParallelForOptions& Options)
+{
+    if (End <= Begin)
+    {
+        return;
+    }
+
+    uint32_t Grain = 1;
+    const uint32_t JobCount = ParallelJobCount(End - Begin, Options, &Grain);
+    if (JobCount < 2)
+    {
+        Body(Begin, End);
+        return;
+    }
+
+    auto JobBody = [&Body](ParallelChunkCursor& Cursor)
+    {
+        uint32_t ChunkBegin, ChunkEnd;
+        while (ParallelNextChunk(Cursor, &ChunkBegin, &ChunkEnd))
+        {
+            Body(ChunkBegin, ChunkEnd);
+        }
+    };
+    ParallelRunJobs(Begin, End, Grain, JobCount, Options.Priority, JobBody);
+}
+
+template<typename TBody>
+void ParallelFor(uint32_t Begin, uint32_t End, TBody&& Body, const ParallelForOptions& Options)
+{
+    ParallelForRange(Begin, End, [&Body](uint32_t ChunkBegin, uint32_t ChunkEnd)
+    {
+        for (uint32_t i = ChunkBegin; i < ChunkEnd; ++i)
+        {
+            Body(i);
+        }
+    }, Options);
+}
+
+template<typename TContainer, typename TBody>
+void ParallelForEach(TContainer& Container, TBody&& Body, const ParallelForOptions& Options)
+{
+    auto* Elements = Container.data();
+    ParallelFor(0, static_cast<uint32_t>(Container.size()), [Elements, &Body](uint32_t Index)
+    {
+        Body(Elements[Index]);
+    }, Options);
+}
+
+template<typename T, typename TBody, typename TCombine>
+T ParallelReduce(uint32_t Begin, uint32_t End, const T& Identity, TBody&& Body, TCombine&& Combine,
+                 const ParallelForOptions& Options)
+{
+    if (End <= Begin)
+    {
+        return Identity;
+    }
+
+    const uint32_t Count = End - Begin;
+
+    if (Options.bDeterministic)
+    {
+        // Same chunks and the same combine order no matter how many threads take part
+        const uint32_t ChunkSize = std::max(Options.GrainSize, (Count + PARALLEL_REDUCE_FIXED_CHUNKS - 1) / PARALLEL_REDUCE_FIXED_CHUNKS);
+        const uint32_t ChunkCount = (Count + ChunkSize - 1) / ChunkSize;
+        std::vector<ParallelReduceSlot<T>> Partials(ChunkCount, ParallelReduceSlot<T> { Identity });
+
+        ParallelForOptions ChunkOptions = Options;
+        ChunkOptions.GrainSize = 1;
+        ChunkOptions.SerialThreshold = Count < Options.SerialThreshold ? UINT32_MAX : 2;
+
+        ParallelFor(0, ChunkCount, [&](uint32_t Chunk)
+        {
+            const uint32_t ChunkBegin = Begin + Chunk * ChunkSize;
+            const uint32_t ChunkEnd = std::min(End, ChunkBegin + ChunkSize);
+
+            T Accumulator = Identity;
+            for (uint32_t i = ChunkBegin; i < ChunkEnd; ++i)
+            {
+                Body(i, Accumulator);
+            }
+            Partials[Chunk].Value = Accumulator;
+        }, ChunkOptions);
+
+        T Result = Identity;
+        for (const ParallelReduceSlot<T>& Partial : Partials)
+        {
+            Result = Combine(Result, Partial.Value);
+        }
+        return Result;
+    }
+
+    uint32_t Grain = 1;
+    const uint32_t JobCount = ParallelJobCount(Count, Options, &Grain);
+    if (JobCount < 2)
+    {
+        T Accumulator = Identity;
+        for (uint32_t i = Begin; i < End; ++i)
+        {
+            Body(i, Accumulator);
+        }
+        return Accumulator;
+    }
+
+    // One partial per job rather than per chunk, accumulated in a local
+    std::vector<ParallelReduceSlot<T>> Partials(JobCount, ParallelReduceSlot<T> { Identity });
+    std::atomic<uint32_t> NextPartial { 0 };
+
+    auto JobBody = [&](ParallelChunkCursor& Cursor)
+    {
+        T Accumulator = Identity;
+        uint32_t ChunkBegin, ChunkEnd;
+        while (ParallelNextChunk(Cursor, &ChunkBegin, &ChunkEnd))
+        {
+            for (uint32_t i = ChunkBegin; i < ChunkEnd; ++i)
+            {
+                Body(i, Accumulator);
+            }
+        }
+        Partials[NextPartial.fetch_add(1, std::memory_order_relaxed)].Value = Accumulator;
+    };
+    ParallelRunJobs(Begin, End, Grain, JobCount, Options.Priority, JobBody);
+
+    T Result = Identity;
+    for (const ParallelReduceSlot<T>& Partial : Partials)
+    {
+        Result = Combine(Result, Partial.Value);
+    }
+    return Result;
+}
@@ -0,0 +1,278 @@
+#include "Profiler.h"
+
+#include "Logger.h"
+#include "MlokMemory.h"
+#include "platform/Platform.h"
+#include "platform/PlatformThread.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+Profiler* Profiler::Instance = nullptr;
+
+// The buffer of the calling thread, tagged with its profiler so a new one starts clean
+typedef struct ProfilerThreadSlot
+{
+    Profiler* Owner;
+    void* Buffer;
+} ProfilerThreadSlot;
+
+static thread_local ProfilerThreadSlot CurrentSlot = { nullptr, nullptr };
+
+// Names are string literals and function names, quotes and backslashes are all that need escaping
+static void WriteJsonString(FILE* File, const char* String)
+{
+    std::fputc('"', File);
+    for (const char* Char = String ? String : ""; *Char; ++Char)
+    {
+        if (*Char == '"' || *Char == '\\')
+        {
+            std::fputc('\\', File);
+        }
+        std::fputc(*Char, File);
+    }
+    std::fputc('"', File);
+}
+
+Profiler* Profiler::Get()
+{
+    return Instance;
+}
+
+bool Profiler::Initialize(size_t* outMemReq, void* Ptr, const ProfilerConfig& Config)
+{
+#ifndef MLOK_PROFILE
+    *outMemReq = 0;
+    return true;
+#else
+    const uint32_t Threads = Config.ThreadCount > 0 ? Config.ThreadCount : 1;
+    const uint32_t Events = Config.EventsPerThread > 0 ? Config.EventsPerThread : 1;
+    const size_t ThreadsOffset = AlignUp(sizeof(Profiler), MLOK_CACHE_LINE_SIZE);
+    const uint32_t Buffers = Threads + 1;   // And the GPU track
+    const size_t EventsOffset = AlignUp(ThreadsOffset + Buffers * sizeof(ThreadBuffer), MLOK_CACHE_LINE_SIZE);
+
+    *outMemReq = EventsOffset + static_cast<size_t>(Buffers) * Events * sizeof(ProfileEvent);
+    if (Ptr == nullptr)
+    {
+        return true;
+    }
+
+    uint8_t* Memory = static_cast<uint8_t*>(Ptr);
+    Instance = new (Memory) Profiler();
+    Instance->Threads = reinterpret_cast<ThreadBuffer*>(Memory + ThreadsOffset);
+    Instance->ThreadCount = Threads;
+    Instance->EventsPerThread = Events;
+    Instance->RegisteredThreads.store(0, std::memory_order_relaxed);
+    Instance->DroppedThreadEvents.store(0, std::memory_order_relaxed);
+    Instance->StartNs = GetTimeNs();
+    std::strncpy(Instance->TracePath, Config.TracePath.c_str(), sizeof(Instance->TracePath) - 1);
+
+    ProfileEvent* EventMemory = reinterpret_cast<ProfileEvent*>(Memory + EventsOffset);
+    for (uint32_t i = 0; i < Buffers; ++i)
+    {
+        ThreadBuffer* Buffer = new (&Instance->Threads[i]) ThreadBuffer();
+        Buffer->Events = EventMemory + static_cast<size_t>(i) * Events;
+        Buffer->Head.store(0, std::memory_order_relaxed);
+    }
+
+    Instance->GpuTrack = &Instance->Threads[Threads];
+    Instance->GpuTrack->OsThreadId = PROFILER_GPU_TRACK_ID;
+    std::strncpy(Instance->GpuTrack->Name, "GPU", PROFILER_THREAD_NAME_LENGTH - 1);
+
+    MlokInfo("Profiler recording up to %u threads, %u events each", Threads, Events);
+    return true;
+#endif
+}
+
+void Profiler::Shutdown()
+{
+    if (!Instance)
+    {
+        return;
+    }
+
+    if (Instance->TracePath[0] != '\0')
+    {
+        if (Instance->WriteChromeTrace(Instance->TracePath))
+        {
+            MlokInfo("Profiler trace written to %s", Instance->TracePath);
+        }
+    }
+
+    const uint64_t Dropped = Instance->DroppedThreadEvents.load(std::memory_order_relaxed);
+    if (Dropped > 0)
+    {
+        MlokWarning("Profiler dropped %llu events from threads past the first %u", Dropped, Instance->ThreadCount);
+    }
+
+    Instance->~Profiler();
+    Instance = nullptr;
+}
+
+uint64_t Profiler::GetTimeNs()
+{
+    // Same time base as FrameStats and RenderStats. The platform starts after the profiler, until then the
+    // OS clock its time continues from.
+    Platform* CurrentPlatform = Platform::Get();
+    return CurrentPlatform ? CurrentPlatform->GetAbsoluteTimeNs() : Platform::GetOsTimeNs();
+}
+
+void Profiler::SetThreadName(const char* Name)
+{
+    ThreadBuffer* Buffer = GetThreadBuffer();
+    if (Buffer)
+    {
+        std::strncpy(Buffer->Name, Name, PROFILER_THREAD_NAME_LENGTH - 1);
+    }
+}
+
+void Profiler::RecordZone(const char* Name, uint64_t StartNs, uint64_t EndNs)
+{
+    ProfileEvent Event;
+    Event.TimeNs = StartNs;
+    Event.Name = Name;
+    Event.DurationNs = EndNs > StartNs ? EndNs - StartNs : 0;
+    Event.Type = ProfileEventType::PROFILE_EVENT_ZONE;
+    Record(Event);
+}
+
+void Profiler::RecordCounter(const char* Name, double Value)
+{
+    ProfileEvent Event;
+    Event.TimeNs = GetTimeNs();
+    Event.Name = Name;
+    Event.Value = Value;
+    Event.Type = ProfileEventType::PROFILE_EVENT_COUNTER;
+    Record(Event);
+}
+
+void Profiler::RecordFrame(uint64_t FrameIndex)
+{
+    ProfileEvent Event;
+    Event.TimeNs = GetTimeNs();
+    Event.Name = "Frame";
+    Event.Value = static_cast<double>(FrameIndex);
+    Event.Type = ProfileEventType::PROFILE_EVENT_FRAME;
+    Record(Event);
+}
+
+void Profiler::RecordGpuZone(const char* Name, uint64_t StartNs, uint64_t EndNs)
+{
+    ProfileEvent Event;
+    Event.TimeNs = StartNs;
+    Event.Name = Name;
+    Event.DurationNs = EndNs > StartNs ? EndNs - StartNs : 0;
+    Event.Type = ProfileEventType::PROFILE_EVENT_ZONE;
+    Write(GpuTrack, EventsPerThread, Event);
+}
+
+bool Profiler::WriteChromeTrace(const char* Path) const
+{
+    FILE* File = std::fopen(Path, "w");
+    if (!File)
+    {
+        MlokError("Failed to open profiler trace file %s", Path);
+        return false;
+    }
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", File);
+    std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Mlok\"}}", File);
+
+    const uint32_t Registered = std::min(RegisteredThreads.load(std::memory_order_acquire), ThreadCount);
+    for (uint32_t ThreadIdx = 0; ThreadIdx <= Registered; ++ThreadIdx)
+    {
+        // The GPU track goes last
+        const ThreadBuffer& Buffer = ThreadIdx < Registered ? Threads[ThreadIdx] : *GpuTrack;
+        const unsigned long long Tid = static_cast<unsigned long long>(Buffer.OsThreadId);
+
+        std::fprintf(File, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%llu,\"args\":{\"name\":", Tid);
+        if (Buffer.Name[0] != '\0')
+        {
+            WriteJsonString(File, Buffer.Name);
+        }
+        else
+        {
+            std::fprintf(File, "\"Thread %llu\"", Tid);
+        }
+        std::fputs("}}", File);
+
+        // Older events were overwritten once the ring wrapped
+        const uint64_t Head = Buffer.Head.load(std::memory_order_acquire);
+        const uint64_t First = Head > EventsPerThread ? Head - EventsPerThread : 0;
+        for (uint64_t i = First; i < Head; ++i)
+        {
+            const ProfileEvent& Event = Buffer.Events[i % EventsPerThread];
+            const double TimeUs = static_cast<double>(static_cast<int64_t>(Event.TimeNs - StartNs)) * 1e-3;
+
+            std::fputs(",\n{\"name\":", File);
+            WriteJsonString(File, Event.Name);
+            switch (Event.Type)
+            {
+                case ProfileEventType::PROFILE_EVENT_ZONE:
+                    std::fprintf(File, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%llu}",
+                                 TimeUs, static_cast<double>(Event.DurationNs) * 1e-3, Tid);
+                    break;
+                case ProfileEventType::PROFILE_EVENT_COUNTER:
+                    std::fprintf(File, ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%llu,\"args\":{\"value\":%.17g}}",
+                                 TimeUs, Tid, Event.Value);
+                    break;
+                case ProfileEventType::PROFILE_EVENT_FRAME:
+                default:
+                    std::fprintf(File, ",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":%llu,\"args\":{\"frame\":%.0f}}",
+                                 TimeUs, Tid, Event.Value);
+                    break;
+            }
+        }
+    }
+
+    std::fputs("\n]}\n", File);
+    const bool bSuccess = std::ferror(File) == 0;
+    std::fclose(File);
+
+    if (!bSuccess)
+    {
+        MlokError("Failed to write profiler trace file %s", Path);
+    }
+    return bSuccess;
+}
+
+Profiler::ThreadBuffer* Profiler::GetThreadBuffer()
+{
+    if (CurrentSlot.Owner == this)
+    {
+        return static_cast<ThreadBuffer*>(CurrentSlot.Buffer);
+    }
+
+    // First event of this thread, threads past the limit keep a null buffer
+    const uint32_t Index = RegisteredThreads.fetch_add(1, std::memory_order_relaxed);
+    ThreadBuffer* Buffer = nullptr;
+    if (Index < ThreadCount)
+    {
+        Buffer = &Threads[Index];
+        Buffer->OsThreadId = PlatformThread::GetCurrentId();
+    }
+
+    CurrentSlot.Owner = this;
+    CurrentSlot.Buffer = Buffer;
+    return Buffer;
+}
+
+void Profiler::Record(const ProfileEvent& Event)
+{
+    ThreadBuffer* Buffer = GetThreadBuffer();
+    if (!Buffer)
+    {
+        DroppedThreadEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Write(Buffer, EventsPerThread, Event);
+}
+
+void Profiler::Write(ThreadBuffer* Buffer, uint32_t Capacity, const ProfileEvent& Event)
+{
+    const uint64_t Head = Buffer->Head.load(std::memory_order_relaxed);
+    Buffer->Events[Head % Capacity] = Event;
+    Buffer->Head.store(Head + 1, std::memory_order_release);
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Defines.h"
+
+#include <atomic>
+
+#define PROFILER_DEFAULT_THREAD_COUNT 32
+#define PROFILER_DEFAULT_EVENTS_PER_THREAD (16 * 1024)  // 32 bytes each, the newest ones are kept
+#define PROFILER_THREAD_NAME_LENGTH 32
+#define PROFILER_GPU_TRACK_ID 0xFFFFFFFFull    // Trace thread id of the GPU track
+
+enum class ProfileEventType
+{
+    PROFILE_EVENT_ZONE,     // Complete zone: start time and duration
+    PROFILE_EVENT_COUNTER,
+    PROFILE_EVENT_FRAME,    // Frame start marker, Value is the frame index
+
+    PROFILE_EVENT_MAX
+};
+
+typedef struct ProfileEvent
+{
+    uint64_t TimeNs;
+    const char* Name;       // Must outlive the profiler, zones and counters take string literals
+    union
+    {
+        uint64_t DurationNs;
+        double Value;
+    };
+    ProfileEventType Type;
+} ProfileEvent;
+
+typedef struct ProfilerConfig
+{
+    uint32_t ThreadCount = PROFILER_DEFAULT_THREAD_COUNT;  // Threads recording past this many are ignored
+    uint32_t EventsPerThread = PROFILER_DEFAULT_EVENTS_PER_THREAD;
+    std::string TracePath = "mlok_trace.json";  // Chrome trace_event JSON written on shutdown, empty skips it
+} ProfilerConfig;
+
+// Scoped CPU profiler, compiled in with MLOK_PROFILE (make PROFILE=1). Without it the macros below expand to
+// nothing and the subsystem takes no memory. Every thread records into its own ring buffer with no locks and
+// no atomics beyond a release store. The trace opens in chrome://tracing and ui.perfetto.dev.
+class MAPI Profiler
+{
+    public:
+        static Profiler* Get();
+
+        static bool Initialize(size_t* outMemReq, void* Ptr, const ProfilerConfig& Config = ProfilerConfig());
+        // Writes the trace, every recording thread must be stopped by then
+        static void Shutdown();
+
+        // Platform::GetAbsoluteTimeNs time, like every other engine timestamp
+        static uint64_t GetTimeNs();
+
+        // Names the calling thread in the trace
+        void SetThreadName(const char* Name);
+
+        void RecordZone(const char* Name, uint64_t StartNs, uint64_t EndNs);
+        void RecordCounter(const char* Name, double Value);
+        void RecordFrame(uint64_t FrameIndex);
+
+        // Zones measured on the GPU, already converted to GetTimeNs time. They go to their own track, recorded
+        // by one thread at a time (the one that draws).
+        void RecordGpuZone(const char* Name, uint64_t StartNs, uint64_t EndNs);
+
+        bool WriteChromeTrace(const char* Path) const;
+
+    private:
+        typedef struct ThreadBuffer
+        {
+            ProfileEvent* Events;
+            std::atomic<uint64_t> Head;     // Total events written, only the owning thread writes it
+            uint64_t OsThreadId;
+            char Name[PROFILER_THREAD_NAME_LENGTH];
+        } ThreadBuffer;
+
+        ThreadBuffer* GetThreadBuffer();
+        void Record(const ProfileEvent& Event);
+        static void Write(ThreadBuffer* Buffer, uint32_t Capacity, const ProfileEvent& Event);
+
+        ThreadBuffer* Threads;          // ThreadCount of them and the GPU track right behind the profiler, then the events
+        ThreadBuffer* GpuTrack;
+        uint32_t ThreadCount;
+        uint32_t EventsPerThread;
+        std::atomic<uint32_t> RegisteredThreads;
+        std::atomic<uint64_t> DroppedThreadEvents;  // From threads past ThreadCount
+        uint64_t StartNs;
+        char TracePath[256];
+
+        static Profiler* Instance;
+};
+
+#ifdef MLOK_PROFILE
+
+// Records the enclosing scope as one complete zone when it ends. A job that waits in fiber mode may end the
+// zone on another thread, the zone shows up there.
+class ProfileScope
+{
+    public:
+        explicit ProfileScope(const char* inName)
+            : Name(inName), StartNs(Profiler::GetTimeNs())
+        {
+        }
+
+        ~ProfileScope()
+        {
+            if (Profiler* Instance = Profiler::Get())
+            {
+                Instance->RecordZone(Name, StartNs, Profiler::GetTimeNs());
+            }
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const char* Name;
+        uint64_t StartNs;
+};
+
+#define MLOK_PROFILE_CONCAT_INNER(A, B) A##B
+#define MLOK_PROFILE_CONCAT(A, B) MLOK_PROFILE_CONCAT_INNER(A, B)
+
+#define MLOK_PROFILE_SCOPE(Name) ProfileScope MLOK_PROFILE_CONCAT(ProfileScope_, __LINE__)(Name)
+#define MLOK_PROFILE_FUNCTION() MLOK_PROFILE_SCOPE(__func__)
+#define MLOK_PROFILE_FRAME(FrameIndex) do { if (Profiler* P_ = Profiler::Get()) P_->RecordFrame(FrameIndex); } while (0)
+#define MLOK_PROFILE_COUNTER(Name, Value) do { if (Profiler* P_ = Profiler::Get()) P_->RecordCounter(Name, static_cast<double>(Value)); } while (0)
+#define MLOK_PROFILE_THREAD(Name) do { if (Profiler* P_ = Profiler::Get()) P_->SetThreadName(Name); } while (0)
+
+#else
+
+#define MLOK_PROFILE_SCOPE(Name)
+#define MLOK_PROFILE_FUNCTION()
+#define MLOK_PROFILE_FRAME(FrameIndex)
+#define MLOK_PROFILE_COUNTER(Name, Value)
+#define MLOK_PROFILE_THREAD(Name)
+
+#endif // MLOK_PROFILE
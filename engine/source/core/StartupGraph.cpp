@@ -0,0 +1,202 @@
+#include "StartupGraph.h"
+
+#include "Logger.h"
+#include "platform/PlatformCpu.h"
+#include "platform/PlatformThread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// The Platform clock may not be up yet while the graph runs
+MINLINE uint64_t GetStartupTimeNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+StartupStepId StartupGraph::AddStep(const std::string& Name,
+                                    std::function<bool()> Function,
+                                    std::initializer_list<StartupStepId> Dependencies,
+                                    StartupThread Thread)
+{
+    Step NewStep {};
+    NewStep.Name = Name;
+    NewStep.Function = std::move(Function);
+    NewStep.Thread = Thread;
+    NewStep.State = StepState::STEP_STATE_PENDING;
+
+    for (StartupStepId Dependency : Dependencies)
+    {
+        if (Dependency >= Steps.size())
+        {
+            continue;
+        }
+
+        if (NewStep.DependencyCount == STARTUP_GRAPH_MAX_DEPENDENCIES)
+        {
+            MlokError("Startup step '%s' has more than %u dependencies", Name.c_str(), STARTUP_GRAPH_MAX_DEPENDENCIES);
+            break;
+        }
+
+        NewStep.Dependencies[NewStep.DependencyCount++] = Dependency;
+    }
+
+    Steps.push_back(std::move(NewStep));
+    return static_cast<StartupStepId>(Steps.size() - 1);
+}
+
+bool StartupGraph::Run()
+{
+    RunStartNs = GetStartupTimeNs();
+
+    // Startup steps mostly wait on the driver and the disk, logical cores are fine
+    const uint32_t HardwareThreads = PlatformGetCpuTopology().LogicalCoreCount;
+    const uint32_t WorkerCount = std::min({ HardwareThreads - 1, static_cast<uint32_t>(Steps.size()), static_cast<uint32_t>(STARTUP_GRAPH_MAX_WORKERS) });
+
+    PlatformThread Workers[STARTUP_GRAPH_MAX_WORKERS];
+    for (uint32_t i = 0; i < WorkerCount; ++i)
+    {
+        char Name[PLATFORM_THREAD_NAME_LENGTH];
+        std::snprintf(Name, sizeof(Name), "Mlok Startup %u", i + 1);
+        Workers[i].Start([this]() { Execute(false); }, Name);
+    }
+
+    Execute(true);
+
+    for (uint32_t i = 0; i < WorkerCount; ++i)
+    {
+        Workers[i].Join();
+    }
+
+    TotalTimeNs = GetStartupTimeNs() - RunStartNs;
+
+    ReportTimings();
+
+    return std::all_of(Steps.begin(), Steps.end(), [](const Step& Entry) { return Entry.State == StepState::STEP_STATE_DONE; });
+}
+
+uint64_t StartupGraph::GetTotalTimeNs() const
+{
+    return TotalTimeNs;
+}
+
+StartupStepId StartupGraph::FindRunnableStep(bool bMainThread)
+{
+    StartupStepId Runnable = STARTUP_GRAPH_INVALID_STEP;
+    StartupStepId MainOnly = STARTUP_GRAPH_INVALID_STEP;
+
+    // Dependencies always precede their dependents, so one pass settles every skip
+    for (StartupStepId Id = 0; Id < Steps.size(); ++Id)
+    {
+        Step& Candidate = Steps[Id];
+        if (Candidate.State != StepState::STEP_STATE_PENDING)
+        {
+            continue;
+        }
+
+        bool bReady = true;
+        for (uint32_t i = 0; i < Candidate.DependencyCount; ++i)
+        {
+            const StepState DependencyState = Steps[Candidate.Dependencies[i]].State;
+            if (DependencyState == StepState::STEP_STATE_FAILED || DependencyState == StepState::STEP_STATE_SKIPPED)
+            {
+                Candidate.State = StepState::STEP_STATE_SKIPPED;
+                bReady = false;
+                break;
+            }
+
+            bReady &= DependencyState == StepState::STEP_STATE_DONE;
+        }
+
+        if (!bReady)
+        {
+            continue;
+        }
+
+        if (Candidate.Thread == StartupThread::STARTUP_THREAD_MAIN)
+        {
+            if (bMainThread && MainOnly == STARTUP_GRAPH_INVALID_STEP)
+            {
+                MainOnly = Id;
+            }
+        }
+        else if (Runnable == STARTUP_GRAPH_INVALID_STEP)
+        {
+            Runnable = Id;
+        }
+    }
+
+    // Nobody else can take main thread steps, so they go first
+    return MainOnly != STARTUP_GRAPH_INVALID_STEP ? MainOnly : Runnable;
+}
+
+bool StartupGraph::IsFinished() const
+{
+    for (const Step& Entry : Steps)
+    {
+        if (Entry.State == StepState::STEP_STATE_PENDING || Entry.State == StepState::STEP_STATE_RUNNING)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void StartupGraph::Execute(bool bMainThread)
+{
+    std::unique_lock<std::mutex> Lock(GraphMutex);
+
+    for (;;)
+    {
+        const StartupStepId Id = FindRunnableStep(bMainThread);
+        if (Id == STARTUP_GRAPH_INVALID_STEP)
+        {
+            if (IsFinished())
+            {
+                Lock.unlock();
+                StepFinished.notify_all();
+                return;
+            }
+
+            StepFinished.wait(Lock);
+            continue;
+        }
+
+        Steps[Id].State = StepState::STEP_STATE_RUNNING;
+        Steps[Id].StartNs = GetStartupTimeNs() - RunStartNs;
+        Lock.unlock();
+
+        const bool bResult = Steps[Id].Function();
+        const uint64_t EndNs = GetStartupTimeNs() - RunStartNs;
+
+        Lock.lock();
+        Steps[Id].EndNs = EndNs;
+        Steps[Id].State = bResult ? StepState::STEP_STATE_DONE : StepState::STEP_STATE_FAILED;
+        StepFinished.notify_all();
+    }
+}
+
+void StartupGraph::ReportTimings() const
+{
+    uint64_t SerialTimeNs = 0;
+
+    for (const Step& Entry : Steps)
+    {
+        switch (Entry.State)
+        {
+            case StepState::STEP_STATE_DONE:
+                MlokInfo("Startup: %-28s %8.2f ms (at %8.2f ms)", Entry.Name.c_str(), (Entry.EndNs - Entry.StartNs) * 1e-6, Entry.StartNs * 1e-6);
+                SerialTimeNs += Entry.EndNs - Entry.StartNs;
+                break;
+            case StepState::STEP_STATE_FAILED:
+                MlokError("Startup: %s failed after %.2f ms", Entry.Name.c_str(), (Entry.EndNs - Entry.StartNs) * 1e-6);
+                break;
+            default:
+                MlokWarning("Startup: %s skipped, a dependency failed", Entry.Name.c_str());
+                break;
+        }
+    }
+
+    MlokInfo("Startup: %u steps took %.2f ms, %.2f ms when run one after another", static_cast<uint32_t>(Steps.size()), TotalTimeNs * 1e-6, SerialTimeNs * 1e-6);
+}
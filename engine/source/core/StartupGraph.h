@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Defines.h"
+
+#include <condition_variable>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+
+#define STARTUP_GRAPH_MAX_DEPENDENCIES 8
+#define STARTUP_GRAPH_MAX_WORKERS 3 // Besides the calling thread
+#define STARTUP_GRAPH_INVALID_STEP 0xFFFFFFFF
+
+typedef uint32_t StartupStepId;
+
+enum class StartupThread
+{
+    STARTUP_THREAD_ANY,
+    STARTUP_THREAD_MAIN     // The thread calling Run, e.g. window creation has to stay where messages are pumped
+};
+
+// Runs initialization steps as soon as their dependencies are done, independent steps run concurrently.
+// A failed step skips everything that depends on it. Every step reports its own timing.
+class MAPI StartupGraph
+{
+    public:
+        // Steps are added before Run, dependencies must be added first. Invalid dependencies are ignored.
+        StartupStepId AddStep(const std::string& Name,
+                              std::function<bool()> Function,
+                              std::initializer_list<StartupStepId> Dependencies = {},
+                              StartupThread Thread = StartupThread::STARTUP_THREAD_ANY);
+
+        // Returns false if any step failed or was skipped
+        bool Run();
+
+        uint64_t GetTotalTimeNs() const;
+
+    private:
+        enum class StepState
+        {
+            STEP_STATE_PENDING,
+            STEP_STATE_RUNNING,
+            STEP_STATE_DONE,
+            STEP_STATE_FAILED,
+            STEP_STATE_SKIPPED
+        };
+
+        typedef struct Step
+        {
+            std::string Name;
+            std::function<bool()> Function;
+            StartupStepId Dependencies[STARTUP_GRAPH_MAX_DEPENDENCIES];
+            uint32_t DependencyCount;
+            StartupThread Thread;
+            StepState State;
+            uint64_t StartNs;       // Relative to the start of Run
+            uint64_t EndNs;
+        } Step;
+
+        // Called with the graph locked. Marks steps with a failed dependency as skipped and picks a runnable one.
+        StartupStepId FindRunnableStep(bool bMainThread);
+        bool IsFinished() const;
+        void Execute(bool bMainThread);
+        void ReportTimings() const;
+
+        std::vector<Step> Steps;
+
+        std::mutex GraphMutex;
+        std::condition_variable StepFinished;
+
+        uint64_t RunStartNs;
+        uint64_t TotalTimeNs;
+};
@@ -0,0 +1,166 @@
+#include "SubsystemRegistry.h"
+
+#include "Logger.h"
+
+bool SubsystemRegistry::Register(const std::string& Name,
+                                 PFN_SubsystemInitialize Initialize,
+                                 PFN_SubsystemShutdown Shutdown,
+                                 std::initializer_list<const char*> Dependencies)
+{
+    if (Arena)
+    {
+        MlokError("Subsystem '%s' registered after the registry was initialized", Name.c_str());
+        return false;
+    }
+
+    if (Dependencies.size() > SUBSYSTEM_REGISTRY_MAX_DEPENDENCIES)
+    {
+        MlokError("Subsystem '%s' has more than %u dependencies", Name.c_str(), SUBSYSTEM_REGISTRY_MAX_DEPENDENCIES);
+        return false;
+    }
+
+    Subsystem NewSubsystem {};
+    NewSubsystem.Name = Name;
+    NewSubsystem.Initialize = std::move(Initialize);
+    NewSubsystem.Shutdown = std::move(Shutdown);
+    for (const char* Dependency : Dependencies)
+    {
+        NewSubsystem.Dependencies[NewSubsystem.DependencyCount++] = Dependency;
+    }
+
+    Subsystems.push_back(std::move(NewSubsystem));
+    return true;
+}
+
+bool SubsystemRegistry::InitializeAll()
+{
+    if (!SortByDependencies())
+    {
+        return false;
+    }
+
+    // Cache line aligned slots, so subsystems updated from different threads don't share lines
+    TotalMemory = 0;
+    for (uint32_t Index : Order)
+    {
+        Subsystem& Entry = Subsystems[Index];
+        Entry.MemoryRequirement = 0;
+        Entry.Initialize(&Entry.MemoryRequirement, nullptr);
+
+        Entry.Offset = TotalMemory;
+        TotalMemory += AlignUp(Entry.MemoryRequirement > 0 ? Entry.MemoryRequirement : 1, MLOK_CACHE_LINE_SIZE);
+    }
+
+    // The platform allocation is not cache line aligned, the slack lets the first slot be
+    Arena = std::make_unique<MlokLinearAllocator>(nullptr, TotalMemory + MLOK_CACHE_LINE_SIZE, MEMORY_TAG_LINEAR_ALLOCATOR);
+    uint8_t* Block = static_cast<uint8_t*>(Arena->Allocate(TotalMemory, MLOK_CACHE_LINE_SIZE));
+
+    for (uint32_t Index : Order)
+    {
+        Subsystem& Entry = Subsystems[Index];
+        if (!Entry.Initialize(&Entry.MemoryRequirement, Block + Entry.Offset))
+        {
+            MlokError("Failed to initialize %s!", Entry.Name.c_str());
+            return false;
+        }
+        Entry.bInitialized = true;
+    }
+
+    MlokInfo("%u subsystems initialized in %llu bytes", static_cast<uint32_t>(Order.size()), static_cast<uint64_t>(TotalMemory));
+    return true;
+}
+
+void SubsystemRegistry::ShutdownAll()
+{
+    for (auto It = Order.rbegin(); It != Order.rend(); ++It)
+    {
+        Subsystem& Entry = Subsystems[*It];
+        if (Entry.bInitialized)
+        {
+            if (Entry.Shutdown)
+            {
+                Entry.Shutdown();
+            }
+            Entry.bInitialized = false;
+        }
+    }
+
+    if (Arena)
+    {
+        Arena->Clear();
+    }
+}
+
+size_t SubsystemRegistry::GetTotalMemory() const
+{
+    return TotalMemory;
+}
+
+bool SubsystemRegistry::SortByDependencies()
+{
+    const uint32_t Count = static_cast<uint32_t>(Subsystems.size());
+
+    // Resolve names once, Dependencies[i] of a subsystem becomes an index into Subsystems
+    std::vector<std::vector<uint32_t>> Dependents(Count);
+    std::vector<uint32_t> PendingDependencies(Count, 0);
+
+    for (uint32_t Index = 0; Index < Count; ++Index)
+    {
+        const Subsystem& Entry = Subsystems[Index];
+        for (uint32_t i = 0; i < Entry.DependencyCount; ++i)
+        {
+            uint32_t DependencyIndex = Count;
+            for (uint32_t Candidate = 0; Candidate < Count; ++Candidate)
+            {
+                if (Subsystems[Candidate].Name == Entry.Dependencies[i])
+                {
+                    DependencyIndex = Candidate;
+                    break;
+                }
+            }
+
+            if (DependencyIndex == Count)
+            {
+                MlokError("Subsystem '%s' depends on '%s', which is not registered", Entry.Name.c_str(), Entry.Dependencies[i].c_str());
+                return false;
+            }
+
+            Dependents[DependencyIndex].push_back(Index);
+            ++PendingDependencies[Index];
+        }
+    }
+
+    Order.clear();
+    Order.reserve(Count);
+
+    std::vector<bool> bPlaced(Count, false);
+    while (Order.size() < Count)
+    {
+        // Lowest registration index among the ready ones, the counts are tiny
+        uint32_t Next = Count;
+        for (uint32_t Index = 0; Index < Count; ++Index)
+        {
+            if (!bPlaced[Index] && PendingDependencies[Index] == 0)
+            {
+                Next = Index;
+                break;
+            }
+        }
+
+        if (Next == Count)
+        {
+            MlokError("Subsystem dependencies form a cycle");
+            Order.clear();
+            return false;
+        }
+
+        bPlaced[Next] = true;
+        Order.push_back(Next);
+        for (uint32_t Dependent : Dependents[Next])
+        {
+            --PendingDependencies[Dependent];
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Defines.h"
+
+#include "MlokMemory.h"
+
+#include <functional>
+#include <initializer_list>
+
+#define SUBSYSTEM_REGISTRY_MAX_DEPENDENCIES 8
+
+// Two-call pattern of the subsystems: reports the memory requirement when Ptr is null, initializes into Ptr otherwise
+typedef std::function<bool(size_t* outMemReq, void* Ptr)> PFN_SubsystemInitialize;
+typedef std::function<void()> PFN_SubsystemShutdown;
+
+// Collects the memory requirements of every subsystem before any of them starts, allocates one exactly sized block
+// and gives each subsystem its own cache lines in it. Subsystems start in dependency order and shut down in reverse.
+class MAPI SubsystemRegistry
+{
+    public:
+        // Dependencies are names of other subsystems and may be registered later
+        bool Register(const std::string& Name,
+                      PFN_SubsystemInitialize Initialize,
+                      PFN_SubsystemShutdown Shutdown,
+                      std::initializer_list<const char*> Dependencies = {});
+
+        // Stops at the first failure, ShutdownAll still shuts down whatever was initialized
+        bool InitializeAll();
+        void ShutdownAll();
+
+        size_t GetTotalMemory() const;
+
+    private:
+        typedef struct Subsystem
+        {
+            std::string Name;
+            PFN_SubsystemInitialize Initialize;
+            PFN_SubsystemShutdown Shutdown;
+            std::string Dependencies[SUBSYSTEM_REGISTRY_MAX_DEPENDENCIES];
+            uint32_t DependencyCount;
+
+            size_t MemoryRequirement;
+            size_t Offset;
+            bool bInitialized;
+        } Subsystem;
+
+        // Fills Order with a dependency respecting order, ties keep the registration order
+        bool SortByDependencies();
+
+        std::vector<Subsystem> Subsystems;
+        std::vector<uint32_t> Order;
+
+        std::unique_ptr<MlokLinearAllocator> Arena;
+        size_t TotalMemory = 0;
+};
@@ -0,0 +1,260 @@
+#include "Task.h"
+
+#include "Logger.h"
+#include "platform/Platform.h"
+
+#include <mutex>
+
+TaskScheduler* TaskScheduler::Instance = nullptr;
+
+TaskScheduler* TaskScheduler::Get()
+{
+    return Instance;
+}
+
+bool TaskScheduler::Initialize(size_t* outMemReq, void* Ptr)
+{
+    *outMemReq = sizeof(TaskScheduler);
+    if (Ptr == nullptr)
+    {
+        return true;
+    }
+
+    Instance = new (Ptr) TaskScheduler();
+    Instance->bIoStopRequested = false;
+
+    if (!Instance->IoThread.Start([]() { Instance->IoLoop(); }, "Mlok IO"))
+    {
+        MlokError("Failed to start the I/O thread");
+        Instance->~TaskScheduler();
+        Instance = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+void TaskScheduler::Shutdown()
+{
+    if (!Instance)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<PlatformMutex> Lock(Instance->IoMutex);
+        Instance->bIoStopRequested = true;
+    }
+    Instance->IoSemaphore.Post();
+    Instance->IoThread.Join();
+
+    if (!Instance->MainQueue.empty())
+    {
+        MlokWarning("Dropping %llu main thread tasks on shutdown", static_cast<unsigned long long>(Instance->MainQueue.size()));
+    }
+
+    Instance->~TaskScheduler();
+    Instance = nullptr;
+}
+
+void TaskScheduler::Dispatch(TaskThread Thread, std::function<void()> Function)
+{
+    switch (Thread)
+    {
+        case TaskThread::TASK_THREAD_JOBS:
+        {
+            JobSystem* Jobs = JobSystem::Get();
+            if (!Jobs)
+            {
+                Function();
+                return;
+            }
+
+            JobDesc Desc;
+            Desc.Entry = &TaskScheduler::RunJob;
+            Desc.Data = new std::function<void()>(std::move(Function));
+            Jobs->Run(Desc);
+            return;
+        }
+        case TaskThread::TASK_THREAD_IO:
+        {
+            {
+                std::lock_guard<PlatformMutex> Lock(IoMutex);
+                IoQueue.push_back(std::move(Function));
+            }
+            IoSemaphore.Post();
+            return;
+        }
+        case TaskThread::TASK_THREAD_MAIN:
+        {
+            std::lock_guard<PlatformMutex> Lock(MainMutex);
+            MainQueue.push_back(std::move(Function));
+            return;
+        }
+        case TaskThread::TASK_THREAD_ANY:
+        default:
+            Function();
+            return;
+    }
+}
+
+bool TaskScheduler::RunMainThreadTasks()
+{
+    // Local, a task that waits runs this again from inside the loop below. Tasks queued meanwhile run next time.
+    std::vector<std::function<void()>> Running;
+    {
+        std::lock_guard<PlatformMutex> Lock(MainMutex);
+        if (MainQueue.empty())
+        {
+            return false;
+        }
+        Running.swap(MainQueue);
+    }
+
+    for (std::function<void()>& Function : Running)
+    {
+        Function();
+    }
+
+    return true;
+}
+
+void TaskScheduler::Wait(JobCounter* Counter)
+{
+    JobSystem* Jobs = JobSystem::Get();
+    if (JobSystem::GetCurrentThreadIndex() != 0)
+    {
+        if (Jobs)
+        {
+            Jobs->Wait(Counter);
+            return;
+        }
+
+        while (Counter->Value.load(std::memory_order_acquire) > 0)
+        {
+            Platform::SpinPause();
+        }
+        return;
+    }
+
+    // The main thread may be the one expected to run the next step
+    while (Counter->Value.load(std::memory_order_acquire) > 0)
+    {
+        const bool bRanTasks = RunMainThreadTasks();
+        const bool bRanJob = Jobs && Jobs->RunPendingJob();
+        if (!bRanTasks && !bRanJob)
+        {
+            Platform::SpinPause();
+        }
+    }
+}
+
+void TaskScheduler::RunJob(void* Data)
+{
+    std::function<void()>* Function = static_cast<std::function<void()>*>(Data);
+    (*Function)();
+    delete Function;
+}
+
+void TaskScheduler::IoLoop()
+{
+    for (;;)
+    {
+        IoSemaphore.Wait();
+
+        std::function<void()> Function;
+        {
+            std::lock_guard<PlatformMutex> Lock(IoMutex);
+            if (IoQueue.empty())
+            {
+                // Only the stop post comes without a task, everything queued before it already ran
+                if (bIoStopRequested)
+                {
+                    return;
+                }
+                continue;
+            }
+            Function = std::move(IoQueue.front());
+            IoQueue.pop_front();
+        }
+
+        Function();
+    }
+}
+
+TaskStateBase::TaskStateBase()
+    : bFinished(false)
+{
+    Pending.Value.store(1, std::memory_order_relaxed);
+}
+
+bool TaskStateBase::IsFinished() const
+{
+    return Pending.Value.load(std::memory_order_acquire) == 0;
+}
+
+void TaskStateBase::Wait()
+{
+    if (IsFinished())
+    {
+        return;
+    }
+
+    TaskScheduler* Scheduler = TaskScheduler::Get();
+    if (Scheduler)
+    {
+        Scheduler->Wait(&Pending);
+        return;
+    }
+
+    while (!IsFinished())
+    {
+        Platform::SpinPause();
+    }
+}
+
+void TaskStateBase::Finish()
+{
+    std::vector<Continuation> Ready;
+    {
+        std::lock_guard<PlatformMutex> Lock(Mutex);
+        bFinished = true;
+        Ready.swap(Continuations);
+    }
+    Pending.Value.store(0, std::memory_order_release);
+
+    TaskScheduler* Scheduler = TaskScheduler::Get();
+    for (Continuation& Each : Ready)
+    {
+        if (Scheduler)
+        {
+            Scheduler->Dispatch(Each.Thread, std::move(Each.Function));
+        }
+        else
+        {
+            Each.Function();
+        }
+    }
+}
+
+void TaskStateBase::AddContinuation(TaskThread Thread, std::function<void()> Function)
+{
+    {
+        std::lock_guard<PlatformMutex> Lock(Mutex);
+        if (!bFinished)
+        {
+            Continuations.push_back({ Thread, std::move(Function) });
+            return;
+        }
+    }
+
+    TaskScheduler* Scheduler = TaskScheduler::Get();
+    if (Scheduler)
+    {
+        Scheduler->Dispatch(Thread, std::move(Function));
+    }
+    else
+    {
+        Function();
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "Defines.h"
+
+#include "JobSystem.h"
+#include "platform/PlatformThread.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+// Where a task or a continuation runs
+enum class TaskThread
+{
+    TASK_THREAD_JOBS,   // Any job system thread, for CPU work
+    TASK_THREAD_IO,     // The dedicated I/O thread, for blocking file and device reads
+    TASK_THREAD_MAIN,   // The main thread, once per frame in RunMainThreadTasks
+    TASK_THREAD_ANY,    // Continuations only: right where the previous task finished, for short glue code
+
+    TASK_THREAD_MAX
+};
+
+// Owns the I/O thread and the main thread queue that tasks are dispatched to. Jobs go to the job system.
+class MAPI TaskScheduler
+{
+    public:
+        static TaskScheduler* Get();
+
+        static bool Initialize(size_t* outMemReq, void* Ptr);
+        // Runs what is left on the I/O thread, drops the main thread tasks nobody ran
+        static void Shutdown();
+
+        // TASK_THREAD_ANY and calls without a scheduler run the function right away
+        void Dispatch(TaskThread Thread, std::function<void()> Function);
+
+        // Called by the main thread every frame, returns false if there was nothing to run
+        bool RunMainThreadTasks();
+
+        // Blocks until the counter reaches zero. The main thread runs main thread tasks and jobs meanwhile,
+        // other threads wait like JobSystem::Wait.
+        void Wait(JobCounter* Counter);
+
+    private:
+        static void RunJob(void* Data);
+        void IoLoop();
+
+        PlatformThread IoThread;
+        PlatformSemaphore IoSemaphore;  // One post per queued I/O task, plus one to stop
+        PlatformMutex IoMutex;
+        std::deque<std::function<void()>> IoQueue;
+        bool bIoStopRequested;          // Guarded by IoMutex
+
+        PlatformMutex MainMutex;
+        std::vector<std::function<void()>> MainQueue;
+
+        static TaskScheduler* Instance;
+};
+
+// Finishes once, then runs its continuations on the threads they asked for
+class MAPI TaskStateBase
+{
+    public:
+        TaskStateBase();
+
+        bool IsFinished() const;
+        void Wait();
+
+        // Call after the result is stored
+        void Finish();
+        void AddContinuation(TaskThread Thread, std::function<void()> Continuation);
+
+    private:
+        typedef struct Continuation
+        {
+            TaskThread Thread;
+            std::function<void()> Function;
+        } Continuation;
+
+        JobCounter Pending;     // 1 until finished, so waiting threads can help the job system
+        PlatformMutex Mutex;
+        std::vector<Continuation> Continuations;
+        bool bFinished;         // Guarded by Mutex
+};
+
+typedef struct TaskEmpty {} TaskEmpty;
+
+template<typename T>
+class TaskState : public TaskStateBase
+{
+    public:
+        std::conditional_t<std::is_void_v<T>, TaskEmpty, std::optional<T>> Value;
+};
+
+// C++17 continuation-based async task: work runs on the job system or the I/O thread and every Then picks
+// the thread its step resumes on, so a loading pipeline reads top to bottom without blocking the frame:
+//
+//     RunTask(TaskThread::TASK_THREAD_IO, [Path]() { return ReadFile(Path); })
+//         .Then(TaskThread::TASK_THREAD_JOBS, [](std::vector<char>& Bytes) { return Parse(Bytes); })
+//         .Then(TaskThread::TASK_THREAD_MAIN, [](Mesh& Result) { Upload(Result); });
+//
+// Functions report errors through their result (usually a bool), the engine doesn't use exceptions.
+// Functions and continuations are stored in std::function, so they have to be copyable.
+template<typename T>
+class Task
+{
+    public:
+        Task() = default;
+
+        bool IsValid() const { return State != nullptr; }
+        bool IsReady() const { return State && State->IsFinished(); }
+
+        // Waits for the result, see TaskScheduler::Wait. Returns T& or nothing for Task<void>.
+        decltype(auto) Get() const;
+
+        // Function takes T& (nothing for Task<void>) and runs on Thread once this task finishes
+        template<typename F>
+        auto Then(TaskThread Thread, F&& Function) const;
+
+    private:
+        template<typename U> friend class Task;
+        template<typename F> friend auto RunTask(TaskThread Thread, F&& Function);
+        template<typename U> friend Task<void> WhenAll(const std::vector<Task<U>>& Tasks);
+
+        std::shared_ptr<TaskState<T>> State;
+};
+
+// Starts Function on Thread, TASK_THREAD_ANY runs it right here
+template<typename F>
+auto RunTask(TaskThread Thread, F&& Function);
+
+// Finishes once every task has. Results stay in the tasks themselves.
+template<typename T>
+Task<void> WhenAll(const std::vector<Task<T>>& Tasks);
+
+#include "Task.tcc"
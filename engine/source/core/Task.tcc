@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+
+namespace TaskDetail
+{
+    // Runs Function with Arguments and stores whatever it returns in the state
+    template<typename R, typename F, typename... Args>
+    void Complete(TaskState<R>& State, F& Function, Args&... Arguments)
+    {
+        if constexpr (std::is_void_v<R>)
+        {
+            Function(Arguments...);
+        }
+        else
+        {
+            State.Value.emplace(Function(Arguments...));
+        }
+        State.Finish();
+    }
+
+    template<typename T, typename F>
+    struct ContinuationResult
+    {
+        using Type = std::invoke_result_t<F&, T&>;
+    };
+
+    template<typename F>
+    struct ContinuationResult<void, F>
+    {
+        using Type = std::invoke_result_t<F&>;
+    };
+}
+
+template<typename T>
+decltype(auto) Task<T>::Get() const
+{
+    State->Wait();
+    if constexpr (!std::is_void_v<T>)
+    {
+        return *State->Value;
+    }
+}
+
+template<typename T>
+template<typename F>
+auto Task<T>::Then(TaskThread Thread, F&& Function) const
+{
+    using R = typename TaskDetail::ContinuationResult<T, std::decay_t<F>>::Type;
+
+    Task<R> Next;
+    Next.State = std::make_shared<TaskState<R>>();
+
+    // The continuation keeps both states alive, the tasks themselves may be gone by the time it runs
+    State->AddContinuation(Thread, [Previous = State, NextState = Next.State, Fn = std::forward<F>(Function)]() mutable
+    {
+        if constexpr (std::is_void_v<T>)
+        {
+            TaskDetail::Complete(*NextState, Fn);
+        }
+        else
+        {
+            TaskDetail::Complete(*NextState, Fn, *Previous->Value);
+        }
+    });
+
+    return Next;
+}
+
+template<typename F>
+auto RunTask(TaskThread Thread, F&& Function)
+{
+    using R = std::invoke_result_t<std::decay_t<F>&>;
+
+    Task<R> NewTask;
+    NewTask.State = std::make_shared<TaskState<R>>();
+
+    std::function<void()> Run = [State = NewTask.State, Fn = std::forward<F>(Function)]() mutable
+    {
+        TaskDetail::Complete(*State, Fn);
+    };
+
+    TaskScheduler* Scheduler = TaskScheduler::Get();
+    if (Scheduler)
+    {
+        Scheduler->Dispatch(Thread, std::move(Run));
+    }
+    else
+    {
+        Run();
+    }
+
+    return NewTask;
+}
+
+template<typename T>
+Task<void> WhenAll(const std::vector<Task<T>>& Tasks)
+{
+    Task<void> All;
+    All.State = std::make_shared<TaskState<void>>();
+
+    if (Tasks.empty())
+    {
+        All.State->Finish();
+        return All;
+    }
+
+    auto Remaining = std::make_shared<std::atomic<uint32_t>>(static_cast<uint32_t>(Tasks.size()));
+    for (const Task<T>& Each : Tasks)
+    {
+        Each.State->AddContinuation(TaskThread::TASK_THREAD_ANY, [AllState = All.State, Remaining]()
+        {
+            if (Remaining->fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                AllState->Finish();
+            }
+        });
+    }
+
+    return All;
+}
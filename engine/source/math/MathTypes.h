@@ -2,6 +2,15 @@
 
 #include "Defines.h"
 
+// SSE2 is part of x86-64, wider instruction sets are picked at runtime (see SimdKernels.h)
+#if !defined(MUSE_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+    #define MUSE_SIMD 1
+#endif
+
+#ifdef MUSE_SIMD
+    #include <xmmintrin.h>
+#endif
+
 typedef union Vec2
 {
     float Elements[2];
@@ -40,10 +49,11 @@ typedef union Vec3
 
 typedef union Vec4
 {
+    // First, so brace initialization keeps filling the floats
+    alignas(16) float Elements[4];
 #ifdef MUSE_SIMD
     alignas(16) __m128 Data;
 #endif
-    alignas(16) float Elements[4];
     struct
     {
         union
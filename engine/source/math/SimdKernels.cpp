@@ -0,0 +1,142 @@
+#include "SimdKernels.h"
+
+#include "core/Logger.h"
+#include "platform/PlatformCpu.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SIMD_KERNELS_X86 1
+
+// SimdKernelsX86.cpp
+void TransformVec4Sse42(const Mat4& M, const Vec4* In, Vec4* Out, uint32_t Count);
+void TransformVec4Avx2(const Mat4& M, const Vec4* In, Vec4* Out, uint32_t Count);
+void TransformVec4Avx512(const Mat4& M, const Vec4* In, Vec4* Out, uint32_t Count);
+uint32_t CullSpheresSse42(const Vec4* Planes, uint32_t PlaneCount, const float* X, const float* Y, const float* Z, const float* Radius, uint32_t Count, uint8_t* outVisible);
+uint32_t CullSpheresAvx2(const Vec4* Planes, uint32_t PlaneCount, const float* X, const float* Y, const float* Z, const float* Radius, uint32_t Count, uint8_t* outVisible);
+uint32_t CullSpheresAvx512(const Vec4* Planes, uint32_t PlaneCount, const float* X, const float* Y, const float* Z, const float* Radius, uint32_t Count, uint8_t* outVisible);
+#endif
+
+static void TransformVec4Scalar(const Mat4& M, const Vec4* In, Vec4* Out, uint32_t Count)
+{
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        const Vec4 V = In[i];
+        for (uint32_t Row = 0; Row < 4; ++Row)
+        {
+            Out[i].Elements[Row] = M.Data[Row] * V.X + M.Data[4 + Row] * V.Y + M.Data[8 + Row] * V.Z + M.Data[12 + Row] * V.W;
+        }
+    }
+}
+
+static uint32_t CullSpheresScalar(const Vec4* Planes, uint32_t PlaneCount,
+                                  const float* X, const float* Y, const float* Z, const float* Radius,
+                                  uint32_t Count, uint8_t* outVisible)
+{
+    uint32_t VisibleCount = 0;
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        bool bVisible = true;
+        for (uint32_t p = 0; p < PlaneCount && bVisible; ++p)
+        {
+            bVisible = Planes[p].X * X[i] + Planes[p].Y * Y[i] + Planes[p].Z * Z[i] + Planes[p].W + Radius[i] >= 0.f;
+        }
+        outVisible[i] = bVisible ? 1 : 0;
+        VisibleCount += bVisible ? 1 : 0;
+    }
+    return VisibleCount;
+}
+
+SimdKernels GetSimdKernelsForLevel(SimdLevel Level)
+{
+    SimdKernels Kernels;
+    Kernels.TransformVec4 = TransformVec4Scalar;
+    Kernels.CullSpheres = CullSpheresScalar;
+    Kernels.Level = SimdLevel::SIMD_LEVEL_SCALAR;
+
+#ifdef SIMD_KERNELS_X86
+    switch (Level)
+    {
+        case SimdLevel::SIMD_LEVEL_AVX512:
+            Kernels.TransformVec4 = TransformVec4Avx512;
+            Kernels.CullSpheres = CullSpheresAvx512;
+            break;
+        case SimdLevel::SIMD_LEVEL_AVX2:
+            Kernels.TransformVec4 = TransformVec4Avx2;
+            Kernels.CullSpheres = CullSpheresAvx2;
+            break;
+        case SimdLevel::SIMD_LEVEL_SSE42:
+            Kernels.TransformVec4 = TransformVec4Sse42;
+            Kernels.CullSpheres = CullSpheresSse42;
+            break;
+        default:
+            return Kernels;
+    }
+    Kernels.Level = Level;
+#endif
+
+    return Kernels;
+}
+
+static SimdLevel GetSupportedSimdLevel()
+{
+    const uint32_t Avx512 = CPU_FEATURE_AVX512F | CPU_FEATURE_AVX512DQ | CPU_FEATURE_AVX512BW | CPU_FEATURE_AVX512VL;
+    const uint32_t Avx2 = CPU_FEATURE_AVX2 | CPU_FEATURE_FMA;
+    const uint32_t Sse42 = CPU_FEATURE_SSE42 | CPU_FEATURE_POPCNT;
+    const uint32_t Features = PlatformGetCpuFeatures();
+
+    // Every level builds on the ones below it
+    if ((Features & (Avx512 | Avx2 | Sse42)) == (Avx512 | Avx2 | Sse42))
+    {
+        return SimdLevel::SIMD_LEVEL_AVX512;
+    }
+    if ((Features & (Avx2 | Sse42)) == (Avx2 | Sse42))
+    {
+        return SimdLevel::SIMD_LEVEL_AVX2;
+    }
+    if ((Features & Sse42) == Sse42)
+    {
+        return SimdLevel::SIMD_LEVEL_SSE42;
+    }
+    return SimdLevel::SIMD_LEVEL_SCALAR;
+}
+
+static SimdKernels SelectSimdKernels()
+{
+    SimdLevel Level = GetSupportedSimdLevel();
+
+    if (const char* EnvLevel = std::getenv("MLOK_SIMD"))
+    {
+        for (uint32_t i = 0; i < static_cast<uint32_t>(SimdLevel::SIMD_LEVEL_MAX); ++i)
+        {
+            const SimdLevel Candidate = static_cast<SimdLevel>(i);
+            if (std::strcmp(EnvLevel, SimdLevelToString(Candidate)) == 0 && Candidate < Level)
+            {
+                Level = Candidate;
+            }
+        }
+    }
+
+    const SimdKernels Kernels = GetSimdKernelsForLevel(Level);
+    MlokInfo("Using %s math kernels", SimdLevelToString(Kernels.Level));
+    return Kernels;
+}
+
+const SimdKernels& GetSimdKernels()
+{
+    static const SimdKernels Kernels = SelectSimdKernels();
+    return Kernels;
+}
+
+const char* SimdLevelToString(SimdLevel Level)
+{
+    switch (Level)
+    {
+        case SimdLevel::SIMD_LEVEL_SCALAR:  return "scalar";
+        case SimdLevel::SIMD_LEVEL_SSE42:   return "sse42";
+        case SimdLevel::SIMD_LEVEL_AVX2:    return "avx2";
+        case SimdLevel::SIMD_LEVEL_AVX512:  return "avx512";
+        default:                            return "unknown";
+    }
+}
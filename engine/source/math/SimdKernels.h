@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Defines.h"
+
+#include "MathTypes.h"
+
+enum class SimdLevel
+{
+    SIMD_LEVEL_SCALAR,
+    SIMD_LEVEL_SSE42,   // With POPCNT
+    SIMD_LEVEL_AVX2,    // With FMA
+    SIMD_LEVEL_AVX512,  // F, DQ, BW and VL
+
+    SIMD_LEVEL_MAX
+};
+
+// Hot loops compiled once per instruction set. GetSimdKernels picks the widest set the CPU supports, so one
+// binary runs everywhere and callers never branch on the CPU themselves. New kernels get a slot here, a scalar
+// version in SimdKernels.cpp and x86 versions in SimdKernelsX86.cpp; a level may reuse a narrower kernel.
+typedef struct SimdKernels
+{
+    // Out[i] = M * In[i], M is column major. In and Out may be the same array.
+    void (*TransformVec4)(const Mat4& M, const Vec4* In, Vec4* Out, uint32_t Count);
+
+    // Spheres as separate X, Y, Z and Radius arrays, planes as (Normal, Distance) with normals pointing inside.
+    // outVisible[i] is 1 for spheres inside or crossing every plane. Returns the visible count.
+    uint32_t (*CullSpheres)(const Vec4* Planes, uint32_t PlaneCount,
+                            const float* X, const float* Y, const float* Z, const float* Radius,
+                            uint32_t Count, uint8_t* outVisible);
+
+    SimdLevel Level;
+} SimdKernels;
+
+// Chosen on the first call. MLOK_SIMD=scalar|sse42|avx2|avx512 caps the level, e.g. to compare kernels.
+MAPI const SimdKernels& GetSimdKernels();
+
+// Kernels of exactly that level without asking the CPU, for tests and benchmarks. Levels that aren't compiled
+// for this architecture give the scalar kernels.
+MAPI SimdKernels GetSimdKernelsForLevel(SimdLevel Level);
+
+MAPI const char* SimdLevelToString(SimdLevel Level);
@@ -0,0 +1,216 @@
+#include "SimdKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+// Each kernel is compiled for its own instruction set while the rest of the engine stays at the x86-64 baseline,
+// so they must only be called through the dispatch in SimdKernels.cpp. Only cl.exe lacks per-function targets;
+// clang with an MSVC target still defines _MSC_VER but needs the attribute for the intrinsics to compile
+#if defined(_MSC_VER) && !defined(__clang__)
+    #define SIMD_TARGET(Features)
+#else
+    #define SIMD_TARGET(Features) __attribute__((target(Features)))
+#endif
+
+#define SIMD_TARGET_SSE42 SIMD_TARGET("sse4.2,popcnt")
+#define SIMD_TARGET_AVX2 SIMD_TARGET("sse4.2,popcnt,avx2,fma")
+#define SIMD_TARGET_AVX512 SIMD_TARGET("sse4.2,popcnt,avx2,fma,avx512f,avx512dq,avx512bw,avx512vl")
+
+// TransformVec4: Out = Col0 * X + Col1 * Y + Col2 * Z + Col3 * W
+
+SIMD_TARGET_SSE42 void TransformVec4Sse42(const Mat4& M, const Vec4* In, Vec4* Out, uint32_t Count)
+{
+    const __m128 Col0 = _mm_loadu_ps(&M.Data[0]);
+    const __m128 Col1 = _mm_loadu_ps(&M.Data[4]);
+    const __m128 Col2 = _mm_loadu_ps(&M.Data[8]);
+    const __m128 Col3 = _mm_loadu_ps(&M.Data[12]);
+
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        const __m128 V = _mm_loadu_ps(In[i].Elements);
+        __m128 Result = _mm_mul_ps(Col0, _mm_shuffle_ps(V, V, _MM_SHUFFLE(0, 0, 0, 0)));
+        Result = _mm_add_ps(Result, _mm_mul_ps(Col1, _mm_shuffle_ps(V, V, _MM_SHUFFLE(1, 1, 1, 1))));
+        Result = _mm_add_ps(Result, _mm_mul_ps(Col2, _mm_shuffle_ps(V, V, _MM_SHUFFLE(2, 2, 2, 2))));
+        Result = _mm_add_ps(Result, _mm_mul_ps(Col3, _mm_shuffle_ps(V, V, _MM_SHUFFLE(3, 3, 3, 3))));
+        _mm_storeu_ps(Out[i].Elements, Result);
+    }
+}
+
+SIMD_TARGET_AVX2 void TransformVec4Avx2(const Mat4& M, const Vec4* In, Vec4* Out, uint32_t Count)
+{
+    // Two vectors per iteration, one in each 128 bit lane
+    const __m256 Col0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&M.Data[0]));
+    const __m256 Col1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&M.Data[4]));
+    const __m256 Col2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&M.Data[8]));
+    const __m256 Col3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&M.Data[12]));
+
+    uint32_t i = 0;
+    for (; i + 2 <= Count; i += 2)
+    {
+        const __m256 V = _mm256_loadu_ps(In[i].Elements);
+        __m256 Result = _mm256_mul_ps(Col0, _mm256_permute_ps(V, _MM_SHUFFLE(0, 0, 0, 0)));
+        Result = _mm256_fmadd_ps(Col1, _mm256_permute_ps(V, _MM_SHUFFLE(1, 1, 1, 1)), Result);
+        Result = _mm256_fmadd_ps(Col2, _mm256_permute_ps(V, _MM_SHUFFLE(2, 2, 2, 2)), Result);
+        Result = _mm256_fmadd_ps(Col3, _mm256_permute_ps(V, _MM_SHUFFLE(3, 3, 3, 3)), Result);
+        _mm256_storeu_ps(Out[i].Elements, Result);
+    }
+
+    if (i < Count)
+    {
+        TransformVec4Sse42(M, In + i, Out + i, Count - i);
+    }
+}
+
+SIMD_TARGET_AVX512 void TransformVec4Avx512(const Mat4& M, const Vec4* In, Vec4* Out, uint32_t Count)
+{
+    const __m512 Col0 = _mm512_broadcast_f32x4(_mm_loadu_ps(&M.Data[0]));
+    const __m512 Col1 = _mm512_broadcast_f32x4(_mm_loadu_ps(&M.Data[4]));
+    const __m512 Col2 = _mm512_broadcast_f32x4(_mm_loadu_ps(&M.Data[8]));
+    const __m512 Col3 = _mm512_broadcast_f32x4(_mm_loadu_ps(&M.Data[12]));
+
+    uint32_t i = 0;
+    for (; i + 4 <= Count; i += 4)
+    {
+        const __m512 V = _mm512_loadu_ps(In[i].Elements);
+        __m512 Result = _mm512_mul_ps(Col0, _mm512_permute_ps(V, _MM_SHUFFLE(0, 0, 0, 0)));
+        Result = _mm512_fmadd_ps(Col1, _mm512_permute_ps(V, _MM_SHUFFLE(1, 1, 1, 1)), Result);
+        Result = _mm512_fmadd_ps(Col2, _mm512_permute_ps(V, _MM_SHUFFLE(2, 2, 2, 2)), Result);
+        Result = _mm512_fmadd_ps(Col3, _mm512_permute_ps(V, _MM_SHUFFLE(3, 3, 3, 3)), Result);
+        _mm512_storeu_ps(Out[i].Elements, Result);
+    }
+
+    if (i < Count)
+    {
+        TransformVec4Avx2(M, In + i, Out + i, Count - i);
+    }
+}
+
+// CullSpheres: a sphere is visible while Dot(Normal, Center) + Distance + Radius >= 0 for every plane
+
+static uint32_t CullSpheresTail(const Vec4* Planes, uint32_t PlaneCount,
+                                const float* X, const float* Y, const float* Z, const float* Radius,
+                                uint32_t Begin, uint32_t Count, uint8_t* outVisible)
+{
+    uint32_t VisibleCount = 0;
+    for (uint32_t i = Begin; i < Count; ++i)
+    {
+        bool bVisible = true;
+        for (uint32_t p = 0; p < PlaneCount && bVisible; ++p)
+        {
+            bVisible = Planes[p].X * X[i] + Planes[p].Y * Y[i] + Planes[p].Z * Z[i] + Planes[p].W + Radius[i] >= 0.f;
+        }
+        outVisible[i] = bVisible ? 1 : 0;
+        VisibleCount += bVisible ? 1 : 0;
+    }
+    return VisibleCount;
+}
+
+SIMD_TARGET_SSE42 uint32_t CullSpheresSse42(const Vec4* Planes, uint32_t PlaneCount,
+                                             const float* X, const float* Y, const float* Z, const float* Radius,
+                                             uint32_t Count, uint8_t* outVisible)
+{
+    const __m128 Zero = _mm_setzero_ps();
+
+    uint32_t VisibleCount = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= Count; i += 4)
+    {
+        const __m128 CenterX = _mm_loadu_ps(X + i);
+        const __m128 CenterY = _mm_loadu_ps(Y + i);
+        const __m128 CenterZ = _mm_loadu_ps(Z + i);
+        const __m128 SphereRadius = _mm_loadu_ps(Radius + i);
+
+        __m128 Inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (uint32_t p = 0; p < PlaneCount; ++p)
+        {
+            __m128 Distance = _mm_add_ps(_mm_set1_ps(Planes[p].W), SphereRadius);
+            Distance = _mm_add_ps(Distance, _mm_mul_ps(_mm_set1_ps(Planes[p].X), CenterX));
+            Distance = _mm_add_ps(Distance, _mm_mul_ps(_mm_set1_ps(Planes[p].Y), CenterY));
+            Distance = _mm_add_ps(Distance, _mm_mul_ps(_mm_set1_ps(Planes[p].Z), CenterZ));
+            Inside = _mm_and_ps(Inside, _mm_cmpge_ps(Distance, Zero));
+        }
+
+        const int Mask = _mm_movemask_ps(Inside);
+        for (uint32_t Lane = 0; Lane < 4; ++Lane)
+        {
+            outVisible[i + Lane] = (Mask >> Lane) & 1;
+        }
+        VisibleCount += static_cast<uint32_t>(_mm_popcnt_u32(static_cast<uint32_t>(Mask)));
+    }
+
+    return VisibleCount + CullSpheresTail(Planes, PlaneCount, X, Y, Z, Radius, i, Count, outVisible);
+}
+
+SIMD_TARGET_AVX2 uint32_t CullSpheresAvx2(const Vec4* Planes, uint32_t PlaneCount,
+                                          const float* X, const float* Y, const float* Z, const float* Radius,
+                                          uint32_t Count, uint8_t* outVisible)
+{
+    const __m256 Zero = _mm256_setzero_ps();
+
+    uint32_t VisibleCount = 0;
+    uint32_t i = 0;
+    for (; i + 8 <= Count; i += 8)
+    {
+        const __m256 CenterX = _mm256_loadu_ps(X + i);
+        const __m256 CenterY = _mm256_loadu_ps(Y + i);
+        const __m256 CenterZ = _mm256_loadu_ps(Z + i);
+        const __m256 SphereRadius = _mm256_loadu_ps(Radius + i);
+
+        __m256 Inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (uint32_t p = 0; p < PlaneCount; ++p)
+        {
+            __m256 Distance = _mm256_add_ps(_mm256_set1_ps(Planes[p].W), SphereRadius);
+            Distance = _mm256_fmadd_ps(_mm256_set1_ps(Planes[p].X), CenterX, Distance);
+            Distance = _mm256_fmadd_ps(_mm256_set1_ps(Planes[p].Y), CenterY, Distance);
+            Distance = _mm256_fmadd_ps(_mm256_set1_ps(Planes[p].Z), CenterZ, Distance);
+            Inside = _mm256_and_ps(Inside, _mm256_cmp_ps(Distance, Zero, _CMP_GE_OQ));
+        }
+
+        // All ones lanes become 1 bytes: negate to 1, then pack 8 dwords down to 8 bytes
+        const __m256i Ones = _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_castps_si256(Inside));
+        const __m128i Words = _mm_packus_epi32(_mm256_castsi256_si128(Ones), _mm256_extracti128_si256(Ones, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(outVisible + i), _mm_packus_epi16(Words, Words));
+
+        VisibleCount += static_cast<uint32_t>(_mm_popcnt_u32(static_cast<uint32_t>(_mm256_movemask_ps(Inside))));
+    }
+
+    return VisibleCount + CullSpheresTail(Planes, PlaneCount, X, Y, Z, Radius, i, Count, outVisible);
+}
+
+SIMD_TARGET_AVX512 uint32_t CullSpheresAvx512(const Vec4* Planes, uint32_t PlaneCount,
+                                              const float* X, const float* Y, const float* Z, const float* Radius,
+                                              uint32_t Count, uint8_t* outVisible)
+{
+    const __m512 Zero = _mm512_setzero_ps();
+    const __m128i OneBytes = _mm_set1_epi8(1);
+
+    uint32_t VisibleCount = 0;
+    uint32_t i = 0;
+    for (; i < Count; i += 16)
+    {
+        // The tail is masked, lanes past the end are neither read nor written
+        const __mmask16 Lanes = Count - i >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (Count - i)) - 1);
+        const __m512 CenterX = _mm512_maskz_loadu_ps(Lanes, X + i);
+        const __m512 CenterY = _mm512_maskz_loadu_ps(Lanes, Y + i);
+        const __m512 CenterZ = _mm512_maskz_loadu_ps(Lanes, Z + i);
+        const __m512 SphereRadius = _mm512_maskz_loadu_ps(Lanes, Radius + i);
+
+        __mmask16 Inside = Lanes;
+        for (uint32_t p = 0; p < PlaneCount; ++p)
+        {
+            __m512 Distance = _mm512_add_ps(_mm512_set1_ps(Planes[p].W), SphereRadius);
+            Distance = _mm512_fmadd_ps(_mm512_set1_ps(Planes[p].X), CenterX, Distance);
+            Distance = _mm512_fmadd_ps(_mm512_set1_ps(Planes[p].Y), CenterY, Distance);
+            Distance = _mm512_fmadd_ps(_mm512_set1_ps(Planes[p].Z), CenterZ, Distance);
+            Inside = _mm512_mask_cmp_ps_mask(Inside, Distance, Zero, _CMP_GE_OQ);
+        }
+
+        _mm_mask_storeu_epi8(outVisible + i, Lanes, _mm_maskz_mov_epi8(Inside, OneBytes));
+        VisibleCount += static_cast<uint32_t>(_mm_popcnt_u32(static_cast<uint32_t>(Inside)));
+    }
+
+    return VisibleCount;
+}
+
+#endif
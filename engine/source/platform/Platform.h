@@ -2,6 +2,10 @@
 
 #include "Defines.h"
 
+#include "PlatformCpu.h"
+
+#include <atomic>
+
 #ifdef MPLATFORM_WINDOWS
     #include <windows.h>
     #include <windowsx.h>
@@ -16,6 +20,10 @@
     #include <X11/Xlib.h>
     #include <X11/Xlib-xcb.h>
     #include <sys/time.h>
+
+    #ifdef MLOK_RAW_MOUSE_INPUT
+        #include <xcb/xinput.h>
+    #endif
 #endif
 
 class VulkanContext;
@@ -25,14 +33,17 @@ class Platform
     public:
         static Platform* Get();
 
+        // Headless skips the window and the display connection, PumpMessages then has nothing to pump
         static bool Startup(size_t* outMemReq, void* Ptr,
                             const std::string& ApplicationName,
                             int32_t X, int32_t Y, 
-                            int32_t Width, int32_t Height);
+                            int32_t Width, int32_t Height,
+                            bool bHeadless = false);
 
         static void Shutdown();
 
         bool PumpMessages();
+        bool IsHeadless() const;
 
         // Memory
         static void* PlatformAllocate(size_t Size, bool bAligned);
@@ -44,24 +55,62 @@ class Platform
         void ConsoleWrite(const std::string& Message, uint8_t Color);
         void ConsoleWriteError(const std::string& Message, uint8_t Color);
 
+        // Monotonic time since an arbitrary point. Prefer the integer nanoseconds for measuring intervals,
+        // seconds are the same clock converted to double.
+        uint64_t GetAbsoluteTimeNs();
         double GetAbsoluteTime();
+        // The OS monotonic clock, GetAbsoluteTimeNs reads it until the TSC takes over and the TSC continues it.
+        // Works before Startup.
+        static uint64_t GetOsTimeNs();
 
         void PlatformSleep(uint64_t ms);
 
+        // Sleeps until the absolute time (GetAbsoluteTimeNs base), may oversleep by the scheduler granularity
+        void SleepUntilNs(uint64_t AbsoluteTimeNs);
+        // Hint for busy wait loops
+        static void SpinPause();
+
+        // CPU_FEATURE_* bits supported by both the CPU and the OS
+        static uint32_t GetCpuFeatures();
+        static bool HasCpuFeatures(uint32_t Features);
+
         // Renderer
         // Vulkan 
         // TODO: think on a more flexible and convenient way of declaring platform specific and renderer specific calls
-        void GetRequiredExtensionNames(std::vector<const char*>& OutExtensions) const;
+        // Doesn't need the Platform to be started, so the Vulkan instance can be created alongside the window
+        static void GetRequiredExtensionNames(std::vector<const char*>& OutExtensions);
         bool CreateVulkanSurface(VulkanContext* Context);
     
     private:
+        // Switches GetAbsoluteTimeNs to the TSC when built with MLOK_TSC_CLOCK and the CPU has an invariant one
+        void CalibrateTsc();
+        // Main thread, from PumpMessages. Re-measures the rate over everything since CalibrateTsc and steers
+        // the TSC time back onto the OS clock, see PlatformTsc.cpp for the accuracy this gives
+        void RefineTsc();
+        uint64_t GetTscTimeNs() const;
+
+        bool bHeadless;
+
+        bool bUseTsc;
+        // Read from any thread, RefineTsc is the only writer. An odd sequence means an update is in progress.
+        std::atomic<uint32_t> TscSequence;
+        std::atomic<uint64_t> TscBase;
+        std::atomic<uint64_t> TscBaseNs;
+        std::atomic<uint64_t> TscMultiplier;    // Nanoseconds per tick, 32.32 fixed point
+        uint64_t TscCalibrationTsc;             // First calibration point, the rate is measured from here
+        uint64_t TscCalibrationNs;
+        uint64_t TscLastRefineNs;               // OS clock
+
     #ifdef MPLATFORM_WINDOWS
         HINSTANCE hInstance;
         HWND hWnd;
 
-        double ClockFrequency;
         LARGE_INTEGER StartTime;
 
+        double MessageTimestamp; // GetAbsoluteTime of the message being dispatched
+
+        HANDLE SleepTimer; // High resolution waitable timer, nullptr before Windows 10 1803
+
         static LRESULT CALLBACK Win32ProcessMessage(HWND hWnd, uint32_t Message, WPARAM wParam, LPARAM lParam);
     #endif // MPLATFORM_WINDOWS
     
@@ -72,6 +121,11 @@ class Platform
         xcb_screen_t* pScreen;
         xcb_atom_t wmProtocols;
         xcb_atom_t wmDeleteWin;
+
+    #ifdef MLOK_RAW_MOUSE_INPUT
+        uint8_t XInputOpcode; // 0 if XInput2 raw motion isn't available
+        bool bWindowFocused;  // Raw motion is selected on the root window, it's dropped while this is false
+    #endif
     #endif // MPLATFORM_LINUX
 
         vk::SurfaceKHR Surface;
@@ -0,0 +1,461 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_PLATFORM
+
+#include "PlatformCpu.h"
+#include "Platform.h"
+
+#include "core/Logger.h"
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define CPU_FEATURES_X64 1
+
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+typedef struct LogicalCoreEntry
+{
+    uint32_t Logical;
+    uint32_t Package;
+    uint32_t Core;      // Only unique within its package
+} LogicalCoreEntry;
+
+static void FillPinOrder(CpuTopology* outTopology, std::vector<LogicalCoreEntry>& Entries)
+{
+    std::sort(Entries.begin(), Entries.end(), [](const LogicalCoreEntry& A, const LogicalCoreEntry& B)
+    {
+        return A.Package != B.Package ? A.Package < B.Package : A.Core != B.Core ? A.Core < B.Core : A.Logical < B.Logical;
+    });
+
+    if (Entries.size() > PLATFORM_MAX_LOGICAL_CORES)
+    {
+        Entries.resize(PLATFORM_MAX_LOGICAL_CORES);
+    }
+
+    // Dense core index and rank among SMT siblings for every logical core
+    std::vector<uint32_t> CoreIndices(Entries.size());
+    std::vector<uint32_t> SiblingRanks(Entries.size());
+    uint32_t CoreCount = 0;
+    uint32_t PackageCount = 0;
+    uint32_t MaxRank = 0;
+    for (size_t i = 0; i < Entries.size(); ++i)
+    {
+        const bool bNewPackage = i == 0 || Entries[i].Package != Entries[i - 1].Package;
+        const bool bNewCore = bNewPackage || Entries[i].Core != Entries[i - 1].Core;
+
+        PackageCount += bNewPackage ? 1 : 0;
+        CoreCount += bNewCore ? 1 : 0;
+        CoreIndices[i] = CoreCount - 1;
+        SiblingRanks[i] = bNewCore ? 0 : SiblingRanks[i - 1] + 1;
+        MaxRank = std::max(MaxRank, SiblingRanks[i]);
+    }
+
+    uint32_t Written = 0;
+    for (uint32_t Rank = 0; Rank <= MaxRank; ++Rank)
+    {
+        for (size_t i = 0; i < Entries.size(); ++i)
+        {
+            if (SiblingRanks[i] == Rank)
+            {
+                outTopology->PinOrder[Written] = static_cast<uint16_t>(Entries[i].Logical);
+                outTopology->CoreIndex[Written] = static_cast<uint16_t>(CoreIndices[i]);
+                ++Written;
+            }
+        }
+    }
+
+    outTopology->LogicalCoreCount = Written;
+    outTopology->PhysicalCoreCount = CoreCount;
+    outTopology->PackageCount = PackageCount;
+}
+
+static void FillFallbackTopology(CpuTopology* outTopology)
+{
+    std::vector<LogicalCoreEntry> Entries;
+    const uint32_t Count = std::max(std::thread::hardware_concurrency(), 1u);
+    for (uint32_t i = 0; i < Count; ++i)
+    {
+        Entries.push_back({ i, 0, i });
+    }
+    FillPinOrder(outTopology, Entries);
+}
+
+#ifdef MPLATFORM_LINUX
+
+#include <sched.h>
+
+#include <cstdlib>
+#include <fstream>
+
+#define SYS_CPU_PATH "/sys/devices/system/cpu/cpu"
+
+static bool ReadSysLine(const std::string& Path, std::string& outLine)
+{
+    std::ifstream File(Path);
+    return File.is_open() && static_cast<bool>(std::getline(File, outLine));
+}
+
+static bool ReadSysNumber(const std::string& Path, uint32_t* outValue)
+{
+    std::string Line;
+    if (!ReadSysLine(Path, Line) || Line.empty())
+    {
+        return false;
+    }
+
+    // Sizes come as "48K" or "32M"
+    char* End = nullptr;
+    uint64_t Value = std::strtoull(Line.c_str(), &End, 10);
+    if (*End == 'K')
+    {
+        Value *= 1024;
+    }
+    else if (*End == 'M')
+    {
+        Value *= 1024 * 1024;
+    }
+
+    *outValue = static_cast<uint32_t>(Value);
+    return true;
+}
+
+// "0-3,8,10-11" has 7 processors
+static uint32_t CountCpuList(const std::string& List)
+{
+    uint32_t Count = 0;
+    const char* Cursor = List.c_str();
+    while (*Cursor)
+    {
+        char* End = nullptr;
+        const unsigned long First = std::strtoul(Cursor, &End, 10);
+        unsigned long Last = First;
+        if (*End == '-')
+        {
+            Last = std::strtoul(End + 1, &End, 10);
+        }
+        if (End == Cursor)
+        {
+            break;
+        }
+
+        Count += static_cast<uint32_t>(Last - First + 1);
+        Cursor = *End == ',' ? End + 1 : End;
+    }
+    return Count;
+}
+
+static void ReadCaches(CpuTopology* outTopology, uint32_t Logical)
+{
+    const std::string CachePath = SYS_CPU_PATH + std::to_string(Logical) + "/cache/index";
+    for (uint32_t Index = 0; ; ++Index)
+    {
+        const std::string IndexPath = CachePath + std::to_string(Index) + "/";
+
+        uint32_t Level = 0;
+        std::string Type;
+        if (!ReadSysNumber(IndexPath + "level", &Level) || !ReadSysLine(IndexPath + "type", Type))
+        {
+            break;
+        }
+
+        CpuCacheInfo* Cache = nullptr;
+        if (Level == 1 && Type == "Data")
+        {
+            Cache = &outTopology->L1Data;
+        }
+        else if (Level == 2 && Type != "Instruction")
+        {
+            Cache = &outTopology->L2;
+        }
+        else if (Level == 3 && Type != "Instruction")
+        {
+            Cache = &outTopology->L3;
+        }
+
+        if (Cache == nullptr)
+        {
+            continue;
+        }
+
+        std::string SharedList;
+        ReadSysNumber(IndexPath + "size", &Cache->SizeBytes);
+        ReadSysNumber(IndexPath + "coherency_line_size", &Cache->LineSize);
+        Cache->SharedLogicalCores = ReadSysLine(IndexPath + "shared_cpu_list", SharedList) ? CountCpuList(SharedList) : 1;
+    }
+}
+
+static bool QueryCpuTopology(CpuTopology* outTopology)
+{
+    cpu_set_t Allowed;
+    if (sched_getaffinity(0, sizeof(Allowed), &Allowed) != 0)
+    {
+        return false;
+    }
+
+    std::vector<LogicalCoreEntry> Entries;
+    for (uint32_t Logical = 0; Logical < CPU_SETSIZE; ++Logical)
+    {
+        if (!CPU_ISSET(Logical, &Allowed))
+        {
+            continue;
+        }
+
+        const std::string TopologyPath = SYS_CPU_PATH + std::to_string(Logical) + "/topology/";
+        LogicalCoreEntry Entry { Logical, 0, 0 };
+        if (!ReadSysNumber(TopologyPath + "core_id", &Entry.Core))
+        {
+            return false;
+        }
+        ReadSysNumber(TopologyPath + "physical_package_id", &Entry.Package);
+        Entries.push_back(Entry);
+    }
+
+    if (Entries.empty())
+    {
+        return false;
+    }
+
+    FillPinOrder(outTopology, Entries);
+    ReadCaches(outTopology, outTopology->PinOrder[0]);
+    return true;
+}
+
+#endif // MPLATFORM_LINUX
+
+#ifdef MPLATFORM_WINDOWS
+
+#include <windows.h>
+
+static uint32_t CountMaskBits(KAFFINITY Mask)
+{
+    uint32_t Count = 0;
+    for (; Mask; Mask &= Mask - 1)
+    {
+        ++Count;
+    }
+    return Count;
+}
+
+static bool QueryCpuTopology(CpuTopology* outTopology)
+{
+    DWORD Length = 0;
+    GetLogicalProcessorInformationEx(RelationAll, nullptr, &Length);
+    if (Length == 0)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> Buffer(Length);
+    PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX First = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(Buffer.data());
+    if (!GetLogicalProcessorInformationEx(RelationAll, First, &Length))
+    {
+        return false;
+    }
+
+    DWORD_PTR ProcessMask = 0;
+    DWORD_PTR SystemMask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &ProcessMask, &SystemMask))
+    {
+        ProcessMask = ~static_cast<DWORD_PTR>(0);
+    }
+
+    // Packages and cores come as separate records, a first pass finds the package of every logical core
+    uint32_t PackageOf[64] = {};
+    std::vector<LogicalCoreEntry> Entries;
+    for (uint32_t Pass = 0; Pass < 2; ++Pass)
+    {
+        uint32_t PackageIndex = 0;
+        uint32_t CoreIndex = 0;
+        for (DWORD Offset = 0; Offset < Length; )
+        {
+            PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX Info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(Buffer.data() + Offset);
+            Offset += Info->Size;
+
+            if (Pass == 0 && Info->Relationship == RelationProcessorPackage)
+            {
+                for (WORD Group = 0; Group < Info->Processor.GroupCount; ++Group)
+                {
+                    const GROUP_AFFINITY& Affinity = Info->Processor.GroupMask[Group];
+                    for (uint32_t Bit = 0; Affinity.Group == 0 && Bit < 64; ++Bit)
+                    {
+                        PackageOf[Bit] = (Affinity.Mask >> Bit) & 1 ? PackageIndex : PackageOf[Bit];
+                    }
+                }
+                ++PackageIndex;
+            }
+            else if (Pass == 1 && Info->Relationship == RelationProcessorCore)
+            {
+                const GROUP_AFFINITY& Affinity = Info->Processor.GroupMask[0];
+                for (uint32_t Bit = 0; Affinity.Group == 0 && Bit < 64; ++Bit)
+                {
+                    if (((Affinity.Mask & ProcessMask) >> Bit) & 1)
+                    {
+                        Entries.push_back({ Bit, PackageOf[Bit], CoreIndex });
+                    }
+                }
+                ++CoreIndex;
+            }
+            else if (Pass == 1 && Info->Relationship == RelationCache)
+            {
+                const CACHE_RELATIONSHIP& CacheInfo = Info->Cache;
+                CpuCacheInfo* Cache = nullptr;
+                if (CacheInfo.Level == 1 && CacheInfo.Type == CacheData)
+                {
+                    Cache = &outTopology->L1Data;
+                }
+                else if (CacheInfo.Level == 2 && CacheInfo.Type != CacheInstruction)
+                {
+                    Cache = &outTopology->L2;
+                }
+                else if (CacheInfo.Level == 3 && CacheInfo.Type != CacheInstruction)
+                {
+                    Cache = &outTopology->L3;
+                }
+
+                // Every instance is reported, they are alike
+                if (Cache && Cache->SizeBytes == 0)
+                {
+                    Cache->SizeBytes = CacheInfo.CacheSize;
+                    Cache->LineSize = CacheInfo.LineSize;
+                    Cache->SharedLogicalCores = CountMaskBits(CacheInfo.GroupMask.Mask);
+                }
+            }
+        }
+    }
+
+    if (Entries.empty())
+    {
+        return false;
+    }
+
+    FillPinOrder(outTopology, Entries);
+    return true;
+}
+
+#endif // MPLATFORM_WINDOWS
+
+static CpuTopology DetectCpuTopology()
+{
+    CpuTopology Topology = {};
+    if (!QueryCpuTopology(&Topology))
+    {
+        Topology = {};
+        FillFallbackTopology(&Topology);
+        MlokWarning("CPU topology isn't available, assuming %u cores without SMT", Topology.LogicalCoreCount);
+        return Topology;
+    }
+
+    MlokInfo("CPU topology: %u packages, %u cores, %u logical cores, L1d %u KiB, L2 %u KiB, L3 %u KiB",
+             Topology.PackageCount, Topology.PhysicalCoreCount, Topology.LogicalCoreCount,
+             Topology.L1Data.SizeBytes / 1024, Topology.L2.SizeBytes / 1024, Topology.L3.SizeBytes / 1024);
+    return Topology;
+}
+
+const CpuTopology& PlatformGetCpuTopology()
+{
+    static const CpuTopology Topology = DetectCpuTopology();
+    return Topology;
+}
+
+#ifdef CPU_FEATURES_X64
+static void QueryCpuid(uint32_t Leaf, uint32_t SubLeaf, uint32_t Regs[4])
+{
+#ifdef _MSC_VER
+    __cpuidex(reinterpret_cast<int*>(Regs), static_cast<int>(Leaf), static_cast<int>(SubLeaf));
+#else
+    __cpuid_count(Leaf, SubLeaf, Regs[0], Regs[1], Regs[2], Regs[3]);
+#endif
+}
+
+// Register state the OS saves on context switches (XCR0)
+static uint64_t ReadXcr0()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t Low, High;
+    __asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+    return (static_cast<uint64_t>(High) << 32) | Low;
+#endif
+}
+#endif
+
+static uint32_t DetectCpuFeatures()
+{
+    uint32_t Features = 0;
+
+#ifdef CPU_FEATURES_X64
+    uint32_t Regs[4] = {};
+    QueryCpuid(0, 0, Regs);
+    const uint32_t MaxLeaf = Regs[0];
+
+    QueryCpuid(1, 0, Regs);
+    const uint32_t Leaf1Ecx = Regs[2];
+    Features |= (Leaf1Ecx & (1u << 20)) ? CPU_FEATURE_SSE42 : 0;
+    Features |= (Leaf1Ecx & (1u << 23)) ? CPU_FEATURE_POPCNT : 0;
+
+    // AVX needs the OS to save YMM state, AVX-512 additionally the opmask and ZMM state
+    const bool bOsXsave = (Leaf1Ecx & (1u << 27)) != 0;
+    const uint64_t Xcr0 = bOsXsave ? ReadXcr0() : 0;
+    const bool bYmmState = (Xcr0 & 0x6) == 0x6;
+    const bool bZmmState = (Xcr0 & 0xE6) == 0xE6;
+
+    if (bYmmState && (Leaf1Ecx & (1u << 28)))
+    {
+        Features |= CPU_FEATURE_AVX;
+        Features |= (Leaf1Ecx & (1u << 12)) ? CPU_FEATURE_FMA : 0;
+
+        if (MaxLeaf >= 7)
+        {
+            QueryCpuid(7, 0, Regs);
+            const uint32_t Leaf7Ebx = Regs[1];
+            Features |= (Leaf7Ebx & (1u << 5)) ? CPU_FEATURE_AVX2 : 0;
+
+            if (bZmmState && (Leaf7Ebx & (1u << 16)))
+            {
+                Features |= CPU_FEATURE_AVX512F;
+                Features |= (Leaf7Ebx & (1u << 17)) ? CPU_FEATURE_AVX512DQ : 0;
+                Features |= (Leaf7Ebx & (1u << 30)) ? CPU_FEATURE_AVX512BW : 0;
+                Features |= (Leaf7Ebx & (1u << 31)) ? CPU_FEATURE_AVX512VL : 0;
+            }
+        }
+    }
+#endif
+
+    static const char* const FeatureNames[] = { "SSE4.2", "AVX", "AVX2", "FMA", "AVX-512F", "AVX-512DQ", "AVX-512BW", "AVX-512VL", "POPCNT" };
+    std::string Names;
+    for (uint32_t i = 0; i < sizeof(FeatureNames) / sizeof(FeatureNames[0]); ++i)
+    {
+        if (Features & (1u << i))
+        {
+            Names += Names.empty() ? "" : " ";
+            Names += FeatureNames[i];
+        }
+    }
+    MlokInfo("CPU features: %s", Names.empty() ? "none" : Names.c_str());
+
+    return Features;
+}
+
+uint32_t PlatformGetCpuFeatures()
+{
+    static const uint32_t Features = DetectCpuFeatures();
+    return Features;
+}
+
+uint32_t Platform::GetCpuFeatures()
+{
+    return PlatformGetCpuFeatures();
+}
+
+bool Platform::HasCpuFeatures(uint32_t Features)
+{
+    return (PlatformGetCpuFeatures() & Features) == Features;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Defines.h"
+
+#define PLATFORM_MAX_LOGICAL_CORES 256
+
+// CPU features, set only when both the CPU and the OS support them (the OS has to save the wider registers)
+#define CPU_FEATURE_SSE42       (1u << 0)
+#define CPU_FEATURE_AVX         (1u << 1)
+#define CPU_FEATURE_AVX2        (1u << 2)
+#define CPU_FEATURE_FMA         (1u << 3)
+#define CPU_FEATURE_AVX512F     (1u << 4)
+#define CPU_FEATURE_AVX512DQ    (1u << 5)
+#define CPU_FEATURE_AVX512BW    (1u << 6)
+#define CPU_FEATURE_AVX512VL    (1u << 7)
+#define CPU_FEATURE_POPCNT      (1u << 8)
+
+typedef struct CpuCacheInfo
+{
+    uint32_t SizeBytes;         // 0 when unknown
+    uint32_t LineSize;
+    uint32_t SharedLogicalCores; // Logical cores using one instance of the cache
+} CpuCacheInfo;
+
+// Processors available to this process, as reported by /sys on Linux and GetLogicalProcessorInformationEx on
+// Windows (processor group 0 only). Logical cores are OS processor numbers, the ones to pass to
+// PlatformThread::SetCurrentAffinity. Without topology information every logical core counts as a physical one.
+typedef struct CpuTopology
+{
+    uint32_t LogicalCoreCount;
+    uint32_t PhysicalCoreCount;
+    uint32_t PackageCount;
+
+    // One logical core per physical core first, then their SMT siblings. Pinning thread i to PinOrder[i]
+    // spreads the first PhysicalCoreCount threads over separate cores.
+    uint16_t PinOrder[PLATFORM_MAX_LOGICAL_CORES];
+    // Dense physical core index for each entry of PinOrder, SMT siblings share one
+    uint16_t CoreIndex[PLATFORM_MAX_LOGICAL_CORES];
+
+    CpuCacheInfo L1Data;
+    CpuCacheInfo L2;
+    CpuCacheInfo L3;
+} CpuTopology;
+
+// Queried and logged on the first call, any thread may call it
+MAPI const CpuTopology& PlatformGetCpuTopology();
+
+// CPU_FEATURE_* bits, queried with CPUID and logged on the first call. Always 0 off x86-64.
+MAPI uint32_t PlatformGetCpuFeatures();
@@ -0,0 +1,132 @@
+#include "PlatformFiber.h"
+
+#ifdef MPLATFORM_LINUX
+
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// makecontext only passes int arguments, the pointer goes through in two halves
+static void FiberTrampoline(uint32_t EntryLow, uint32_t EntryHigh, uint32_t DataLow, uint32_t DataHigh)
+{
+    const uintptr_t EntryBits = (static_cast<uintptr_t>(EntryHigh) << 32) | EntryLow;
+    const uintptr_t DataBits = (static_cast<uintptr_t>(DataHigh) << 32) | DataLow;
+
+    PFN_FiberEntry Entry = reinterpret_cast<PFN_FiberEntry>(EntryBits);
+    Entry(reinterpret_cast<void*>(DataBits));
+}
+
+bool PlatformCreateFiber(PlatformFiber* outFiber, size_t StackSize, PFN_FiberEntry Entry, void* Data)
+{
+    outFiber->StackMemory = nullptr;
+    outFiber->StackMemorySize = 0;
+
+    if (getcontext(&outFiber->Context) != 0)
+    {
+        return false;
+    }
+
+    // Stacks grow down, the guard page goes at the lowest address
+    const size_t PageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t UsableSize = (StackSize + PageSize - 1) & ~(PageSize - 1);
+    const size_t MappingSize = UsableSize + PageSize;
+
+    void* Memory = mmap(nullptr, MappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (Memory == MAP_FAILED)
+    {
+        return false;
+    }
+    if (mprotect(Memory, PageSize, PROT_NONE) != 0)
+    {
+        munmap(Memory, MappingSize);
+        return false;
+    }
+
+    outFiber->StackMemory = Memory;
+    outFiber->StackMemorySize = MappingSize;
+    outFiber->Context.uc_stack.ss_sp = static_cast<uint8_t*>(Memory) + PageSize;
+    outFiber->Context.uc_stack.ss_size = UsableSize;
+    outFiber->Context.uc_link = nullptr;
+
+    const uintptr_t EntryBits = reinterpret_cast<uintptr_t>(Entry);
+    const uintptr_t DataBits = reinterpret_cast<uintptr_t>(Data);
+    makecontext(&outFiber->Context, reinterpret_cast<void (*)()>(FiberTrampoline), 4,
+                static_cast<uint32_t>(EntryBits), static_cast<uint32_t>(EntryBits >> 32),
+                static_cast<uint32_t>(DataBits), static_cast<uint32_t>(DataBits >> 32));
+    return true;
+}
+
+void PlatformDestroyFiber(PlatformFiber* Fiber)
+{
+    if (Fiber->StackMemory)
+    {
+        munmap(Fiber->StackMemory, Fiber->StackMemorySize);
+        Fiber->StackMemory = nullptr;
+        Fiber->StackMemorySize = 0;
+    }
+}
+
+bool PlatformConvertThreadToFiber(PlatformFiber* outFiber)
+{
+    // Filled by the first switch away from the thread, which keeps running on its own stack
+    outFiber->StackMemory = nullptr;
+    outFiber->StackMemorySize = 0;
+    return true;
+}
+
+void PlatformConvertFiberToThread(PlatformFiber* Fiber)
+{
+}
+
+void PlatformSwitchFiber(PlatformFiber* From, PlatformFiber* To)
+{
+    swapcontext(&From->Context, &To->Context);
+}
+
+#endif // MPLATFORM_LINUX
+
+#ifdef MPLATFORM_WINDOWS
+
+static void CALLBACK FiberTrampoline(LPVOID Parameter)
+{
+    PlatformFiber* Fiber = static_cast<PlatformFiber*>(Parameter);
+    Fiber->Entry(Fiber->Data);
+}
+
+bool PlatformCreateFiber(PlatformFiber* outFiber, size_t StackSize, PFN_FiberEntry Entry, void* Data)
+{
+    // Fiber stacks get a guard page like thread stacks do
+    outFiber->Entry = Entry;
+    outFiber->Data = Data;
+    outFiber->Handle = CreateFiber(StackSize, FiberTrampoline, outFiber);
+    return outFiber->Handle != nullptr;
+}
+
+void PlatformDestroyFiber(PlatformFiber* Fiber)
+{
+    if (Fiber->Handle)
+    {
+        DeleteFiber(Fiber->Handle);
+        Fiber->Handle = nullptr;
+    }
+}
+
+bool PlatformConvertThreadToFiber(PlatformFiber* outFiber)
+{
+    outFiber->Handle = ConvertThreadToFiber(nullptr);
+    return outFiber->Handle != nullptr;
+}
+
+void PlatformConvertFiberToThread(PlatformFiber* Fiber)
+{
+    ConvertFiberToThread();
+    Fiber->Handle = nullptr;
+}
+
+void PlatformSwitchFiber(PlatformFiber* From, PlatformFiber* To)
+{
+    SwitchToFiber(To->Handle);
+}
+
+#endif // MPLATFORM_WINDOWS
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Defines.h"
+
+#ifdef MPLATFORM_WINDOWS
+    #include <windows.h>
+#endif
+
+#ifdef MPLATFORM_LINUX
+    #include <ucontext.h>
+#endif
+
+typedef void (*PFN_FiberEntry)(void* Data);
+
+// An execution context with its own stack. A thread switches between fibers by hand, a fiber may be
+// switched away from on one thread and resumed on another.
+// Thread locals are per thread, not per fiber, and the compiler may keep their address across a switch:
+// code that can be resumed on another thread must read them through a non inlined call.
+typedef struct PlatformFiber
+{
+#ifdef MPLATFORM_WINDOWS
+    LPVOID Handle;
+    PFN_FiberEntry Entry;
+    void* Data;
+#endif
+#ifdef MPLATFORM_LINUX
+    ucontext_t Context;
+    void* StackMemory;      // Mapping with the guard page at its start, nullptr for a thread's own context
+    size_t StackMemorySize;
+#endif
+} PlatformFiber;
+
+// The stack is allocated by the platform with an inaccessible guard page below it, so an overflow crashes
+// right away instead of writing over other memory. Entry must never return.
+bool PlatformCreateFiber(PlatformFiber* outFiber, size_t StackSize, PFN_FiberEntry Entry, void* Data);
+void PlatformDestroyFiber(PlatformFiber* Fiber);
+
+// The calling thread's own context, to switch back to before the thread exits
+bool PlatformConvertThreadToFiber(PlatformFiber* outFiber);
+void PlatformConvertFiberToThread(PlatformFiber* Fiber);
+
+// Saves the running context into From and continues To
+void PlatformSwitchFiber(PlatformFiber* From, PlatformFiber* To);
@@ -2,7 +2,11 @@
 
 #ifdef MPLATFORM_LINUX
 
+#include "core/Input.h"
+
 #include <cstdlib>
+#include <cerrno>
+#include <time.h>
 
 Platform* Platform::Instance = nullptr;
 
@@ -11,17 +15,28 @@ Platform* Platform::Get()
     return Instance;
 }
 
-bool Platform::Startup(const std::string& ApplicationName,
+bool Platform::Startup(size_t* outMemReq, void* Ptr,
+                       const std::string& ApplicationName,
                        int32_t X, int32_t Y, 
-                       int32_t Width, int32_t Height)
+                       int32_t Width, int32_t Height,
+                       bool bHeadless)
 {
     *outMemReq = sizeof(Platform);
     if (Ptr == nullptr)
     {
-        return;
+        return true;
     }
 
-    Instance = static_cast<Platform*>(Ptr);
+    Instance = new (Ptr) Platform();
+    Instance->bHeadless = bHeadless;
+
+    Instance->CalibrateTsc();
+
+    // No display connection at all, so it runs on machines without an X server
+    if (bHeadless)
+    {
+        return true;
+    }
 
     pDisplay = XOpenDisplay(nullptr);
 
@@ -52,7 +67,7 @@ bool Platform::Startup(const std::string& ApplicationName,
     uint32_t EventValues = XCB_EVENT_MASK_BUTTON_PRESSED    | XCB_EVENT_MASK_BUTTON_RELEASED   |
                            XCB_EVENT_MASK_KEY_PRESS         | XCB_EVENT_MASK_KEY_RELEASE       |
                            XCB_EVENT_MASK_EXPOSURE          | XCB_EVENT_MASK_POINTER_MOTION    |
-                           XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+                           XCB_EVENT_MASK_STRUCTURE_NOTIFY  | XCB_EVENT_MASK_FOCUS_CHANGE;
 
     uint32_t ValueList[] = { pScreen->black_pixel, EventValues };
 
@@ -105,6 +120,34 @@ bool Platform::Startup(const std::string& ApplicationName,
 
     xcb_map_window(pConnection, Window);
 
+#ifdef MLOK_RAW_MOUSE_INPUT
+    // Raw motion is delivered for the whole screen, only while the window has focus it's forwarded to the InputSystem
+    XInputOpcode = 0;
+    bWindowFocused = false;
+    const xcb_query_extension_reply_t* XInputExtension = xcb_get_extension_data(pConnection, &xcb_input_id);
+    if (XInputExtension && XInputExtension->present)
+    {
+        xcb_input_xi_query_version_reply_t* VersionReply = xcb_input_xi_query_version_reply(pConnection,
+                                                                                             xcb_input_xi_query_version(pConnection, 2, 0),
+                                                                                             nullptr);
+        if (VersionReply && VersionReply->major_version >= 2)
+        {
+            struct
+            {
+                xcb_input_event_mask_t Header;
+                uint32_t Mask;
+            } RawMotionMask;
+            RawMotionMask.Header.deviceid = XCB_INPUT_DEVICE_ALL_MASTER;
+            RawMotionMask.Header.mask_len = 1;
+            RawMotionMask.Mask = XCB_INPUT_XI_EVENT_MASK_RAW_MOTION;
+
+            xcb_input_xi_select_events(pConnection, pScreen->root, 1, &RawMotionMask.Header);
+            XInputOpcode = XInputExtension->major_opcode;
+        }
+        free(VersionReply);
+    }
+#endif
+
     int32_t StreamResult = xcb_flush(pConnection);
     if (StreamResult <= 0)
     {
@@ -116,6 +159,18 @@ bool Platform::Startup(const std::string& ApplicationName,
 
 void Platform::Shutdown()
 {
+    // Startup runs as a startup graph step, it never ran if an earlier step failed
+    if (!Instance)
+    {
+        return;
+    }
+
+    if (Instance->bHeadless)
+    {
+        Instance = nullptr;
+        return;
+    }
+
     XAuthoRepeatOn(pDisplay);
 
     xcb_destroy_window(pConnection, Window);
@@ -125,6 +180,13 @@ void Platform::Shutdown()
 
 bool Platform::PumpMessages()
 {
+    RefineTsc();
+
+    if (bHeadless)
+    {
+        return true;
+    }
+
     xcb_generic_event_t* Event;
     xcb_client_message_event_t* ClientMessage;
 
@@ -132,6 +194,8 @@ bool Platform::PumpMessages()
 
     while((Event = xcb_poll_for_event(pConnection)))
     {
+        const double Timestamp = GetAbsoluteTime();
+
         switch (Event->response_type & ~0x80)
         {
             case XCB_KEY_PRESS:
@@ -143,7 +207,7 @@ bool Platform::PumpMessages()
                     KeySym Sym = XkbKeycodeToKeysym(InternalState->Display, (KeyCode)Code, 0, Code & ShiftMask ? 1 : 0);
                     KeyboardKey Key = TranslateKeycode(Sym);
 
-                    InputProcessKey(Key, bPressed);
+                    InputSystem::Get()->ProcessKey(Key, bPressed, Timestamp);
                 }
                 break;
             case XCB_BUTTON_PRESS:
@@ -167,16 +231,51 @@ bool Platform::PumpMessages()
                         break;
                     }
 
-                    InputProcessMouseButton(Button, bPressed);
+                    InputSystem::Get()->ProcessMouseButton(Button, bPressed, Timestamp);
                 }
                 break;
             case XCB_MOTION_NOTIFY:
                 {
                     xcb_motion_notify_event_t* MoveEvent = (xcb_motion_notify_event_t*)Event;
 
-                    InputProcessMouseMove(MoveEvent->event_x, MoveEvent->event_y);
+                    InputSystem::Get()->ProcessMouseMove(MoveEvent->event_x, MoveEvent->event_y, Timestamp);
+                }
+                break;
+#ifdef MLOK_RAW_MOUSE_INPUT
+            case XCB_FOCUS_IN:
+                bWindowFocused = true;
+                break;
+            case XCB_FOCUS_OUT:
+                bWindowFocused = false;
+                break;
+            case XCB_GE_GENERIC:
+                {
+                    xcb_ge_generic_event_t* GenericEvent = (xcb_ge_generic_event_t*)Event;
+                    if (bWindowFocused && XInputOpcode != 0 && GenericEvent->extension == XInputOpcode &&
+                        GenericEvent->event_type == XCB_INPUT_RAW_MOTION)
+                    {
+                        xcb_input_raw_motion_event_t* RawEvent = (xcb_input_raw_motion_event_t*)Event;
+
+                        // Values are only listed for the valuators set in the mask, 0 and 1 are the X and Y axes
+                        const uint32_t* ValuatorMask = xcb_input_raw_button_press_valuator_mask(RawEvent);
+                        const xcb_input_fp3232_t* RawValues = xcb_input_raw_button_press_axisvalues_raw(RawEvent);
+
+                        float Delta[2] = { 0.f, 0.f };
+                        uint32_t ValueIdx = 0;
+                        for (uint32_t Axis = 0; Axis < 2 && RawEvent->valuators_len > 0; ++Axis)
+                        {
+                            if (ValuatorMask[0] & (1u << Axis))
+                            {
+                                Delta[Axis] = static_cast<float>(RawValues[ValueIdx].integral + RawValues[ValueIdx].frac / 4294967296.0);
+                                ++ValueIdx;
+                            }
+                        }
+
+                        InputSystem::Get()->ProcessMouseRawMotion(Delta[0], Delta[1], Timestamp);
+                    }
                 }
                 break;
+#endif // MLOK_RAW_MOUSE_INPUT
             case XCB_CONFIGURE_NOTIFY:
                 {
                     xcb_notify_event_t* ConfigureEvent = (xcb_configure_notity_event_t*)Event;
@@ -207,6 +306,11 @@ bool Platform::PumpMessages()
     return !bQuitFlagged;
 }
 
+bool Platform::IsHeadless() const
+{
+    return bHeadless;
+}
+
 void* Platform::PlatformAllocate(size_t Size, bool bAligned)
 {
     return malloc(Size);
@@ -246,11 +350,26 @@ void Platform::ConsoleWriteError(const char* Message, uint8_t Color)
     printf("\033[%sm%s\033[0m", ColorCodes[Color], Message);
 }
 
-double Platform::GetAbsoluteTime()
+uint64_t Platform::GetAbsoluteTimeNs()
+{
+    if (bUseTsc)
+    {
+        return GetTscTimeNs();
+    }
+
+    return GetOsTimeNs();
+}
+
+uint64_t Platform::GetOsTimeNs()
 {
     struct timespec Now;
     clock_gettime(CLOCK_MONOTONIC, &Now);
-    return Now.tv_sec + now.tv_nsec * 0.000000001f;
+    return static_cast<uint64_t>(Now.tv_sec) * 1000000000ull + static_cast<uint64_t>(Now.tv_nsec);
+}
+
+double Platform::GetAbsoluteTime()
+{
+    return static_cast<double>(GetAbsoluteTimeNs()) * 1e-9;
 }
 
 void Platform::PlatformSleep(uint64_t ms)
@@ -269,7 +388,42 @@ void Platform::PlatformSleep(uint64_t ms)
     #endif
 }
 
-void Platform::GetRequiredExtensionNames(std::vector<const char*>& OutExtensions) const
+void Platform::SleepUntilNs(uint64_t AbsoluteTimeNs)
+{
+    // With the TSC clock the deadline is converted to a relative one, its base isn't CLOCK_MONOTONIC
+    if (bUseTsc)
+    {
+        const uint64_t Now = GetAbsoluteTimeNs();
+        if (AbsoluteTimeNs <= Now)
+        {
+            return;
+        }
+
+        struct timespec MonotonicNow;
+        clock_gettime(CLOCK_MONOTONIC, &MonotonicNow);
+        AbsoluteTimeNs = static_cast<uint64_t>(MonotonicNow.tv_sec) * 1000000000ull + MonotonicNow.tv_nsec + (AbsoluteTimeNs - Now);
+    }
+
+    struct timespec Deadline;
+    Deadline.tv_sec = static_cast<time_t>(AbsoluteTimeNs / 1000000000ull);
+    Deadline.tv_nsec = static_cast<long>(AbsoluteTimeNs % 1000000000ull);
+
+    // Absolute deadline, so an interrupted sleep is simply restarted without drifting
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Deadline, nullptr) == EINTR)
+    {
+    }
+}
+
+void Platform::SpinPause()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+void Platform::GetRequiredExtensionNames(std::vector<const char*>& OutExtensions)
 {
     OutExtensions.push_back("VK_KHR_xcb_surface");
 }
@@ -0,0 +1,341 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_PLATFORM
+
+#include "PlatformThread.h"
+
+#include "Platform.h"
+#include "core/Logger.h"
+#include "core/Profiler.h"
+
+#include <cstring>
+
+PlatformThread::~PlatformThread()
+{
+    Join();
+}
+
+bool PlatformThread::IsRunning() const
+{
+    return bRunning;
+}
+
+void PlatformThread::Run()
+{
+    SetCurrentName(Name);
+    MLOK_PROFILE_THREAD(Name);
+    if (LogicalCore != PLATFORM_THREAD_ANY_CORE && !SetCurrentAffinity(LogicalCore))
+    {
+        MlokWarning("Couldn't pin thread '%s' to logical core %u", Name, LogicalCore);
+    }
+
+    Function();
+}
+
+#ifdef MPLATFORM_LINUX
+
+#include <sched.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+static void FutexWait(std::atomic<uint32_t>* Address, uint32_t Expected)
+{
+    // Returns right away if the value already changed, callers recheck in a loop anyway
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(Address), FUTEX_WAIT_PRIVATE, Expected, nullptr, nullptr, 0);
+}
+
+static void FutexWake(std::atomic<uint32_t>* Address, uint32_t Count)
+{
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(Address), FUTEX_WAKE_PRIVATE, Count, nullptr, nullptr, 0);
+}
+
+void* PlatformThread::ThreadProc(void* Parameter)
+{
+    static_cast<PlatformThread*>(Parameter)->Run();
+    return nullptr;
+}
+
+bool PlatformThread::Start(std::function<void()> inFunction, const char* inName, uint32_t inLogicalCore)
+{
+    if (bRunning)
+    {
+        return false;
+    }
+
+    Function = std::move(inFunction);
+    std::strncpy(Name, inName ? inName : "", PLATFORM_THREAD_NAME_LENGTH - 1);
+    LogicalCore = inLogicalCore;
+
+    const int Result = pthread_create(&Handle, nullptr, &PlatformThread::ThreadProc, this);
+    if (Result != 0)
+    {
+        MlokError("Failed to create thread '%s', error %d", Name, Result);
+        return false;
+    }
+
+    bRunning = true;
+    return true;
+}
+
+void PlatformThread::Join()
+{
+    if (!bRunning)
+    {
+        return;
+    }
+
+    pthread_join(Handle, nullptr);
+    bRunning = false;
+}
+
+void PlatformThread::SetCurrentName(const char* Name)
+{
+    // The kernel limit is 16 bytes with the terminator
+    char Truncated[16] = {};
+    std::strncpy(Truncated, Name, sizeof(Truncated) - 1);
+    pthread_setname_np(pthread_self(), Truncated);
+}
+
+bool PlatformThread::SetCurrentAffinity(uint32_t LogicalCore)
+{
+    if (LogicalCore >= CPU_SETSIZE)
+    {
+        return false;
+    }
+
+    cpu_set_t Set;
+    CPU_ZERO(&Set);
+    CPU_SET(LogicalCore, &Set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(Set), &Set) == 0;
+}
+
+uint64_t PlatformThread::GetCurrentId()
+{
+    return static_cast<uint64_t>(syscall(SYS_gettid));
+}
+
+PlatformMutex::PlatformMutex()
+    : State(0)
+{
+}
+
+PlatformMutex::~PlatformMutex()
+{
+}
+
+void PlatformMutex::Lock()
+{
+    uint32_t Expected = 0;
+    if (State.compare_exchange_strong(Expected, 1, std::memory_order_acquire, std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    // Critical sections are short, the owner is likely to be done before a syscall would be
+    for (uint32_t i = 0; i < PLATFORM_MUTEX_SPIN_COUNT; ++i)
+    {
+        Platform::SpinPause();
+        Expected = 0;
+        if (State.load(std::memory_order_relaxed) == 0 &&
+            State.compare_exchange_weak(Expected, 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+
+    // Drepper's "Futexes Are Tricky" mutex: 2 tells Unlock that someone may be sleeping
+    while (State.exchange(2, std::memory_order_acquire) != 0)
+    {
+        FutexWait(&State, 2);
+    }
+}
+
+bool PlatformMutex::TryLock()
+{
+    uint32_t Expected = 0;
+    return State.compare_exchange_strong(Expected, 1, std::memory_order_acquire, std::memory_order_relaxed);
+}
+
+void PlatformMutex::Unlock()
+{
+    if (State.exchange(0, std::memory_order_release) == 2)
+    {
+        FutexWake(&State, 1);
+    }
+}
+
+PlatformSemaphore::PlatformSemaphore(uint32_t InitialCount)
+    : Count(InitialCount), Waiters(0)
+{
+}
+
+PlatformSemaphore::~PlatformSemaphore()
+{
+}
+
+void PlatformSemaphore::Wait()
+{
+    for (;;)
+    {
+        if (TryWait())
+        {
+            return;
+        }
+
+        // Sequentially consistent with Post: either it sees the waiter, or the futex sees the new count
+        Waiters.fetch_add(1);
+        FutexWait(&Count, 0);
+        Waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+bool PlatformSemaphore::TryWait()
+{
+    uint32_t Current = Count.load(std::memory_order_relaxed);
+    while (Current > 0)
+    {
+        if (Count.compare_exchange_weak(Current, Current - 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PlatformSemaphore::Post(uint32_t inCount)
+{
+    Count.fetch_add(inCount);
+    if (Waiters.load() > 0)
+    {
+        FutexWake(&Count, inCount);
+    }
+}
+
+#endif // MPLATFORM_LINUX
+
+#ifdef MPLATFORM_WINDOWS
+
+DWORD WINAPI PlatformThread::ThreadProc(LPVOID Parameter)
+{
+    static_cast<PlatformThread*>(Parameter)->Run();
+    return 0;
+}
+
+bool PlatformThread::Start(std::function<void()> inFunction, const char* inName, uint32_t inLogicalCore)
+{
+    if (bRunning)
+    {
+        return false;
+    }
+
+    Function = std::move(inFunction);
+    strncpy_s(Name, inName ? inName : "", PLATFORM_THREAD_NAME_LENGTH - 1);
+    LogicalCore = inLogicalCore;
+
+    Handle = CreateThread(nullptr, 0, &PlatformThread::ThreadProc, this, 0, nullptr);
+    if (Handle == nullptr)
+    {
+        MlokError("Failed to create thread '%s', error %lu", Name, GetLastError());
+        return false;
+    }
+
+    bRunning = true;
+    return true;
+}
+
+void PlatformThread::Join()
+{
+    if (!bRunning)
+    {
+        return;
+    }
+
+    WaitForSingleObject(Handle, INFINITE);
+    CloseHandle(Handle);
+    Handle = nullptr;
+    bRunning = false;
+}
+
+void PlatformThread::SetCurrentName(const char* Name)
+{
+    // SetThreadDescription needs Windows 10 1607, look it up instead of failing to load on older systems
+    typedef HRESULT (WINAPI *PFN_SetThreadDescription)(HANDLE, PCWSTR);
+    static PFN_SetThreadDescription SetDescription = reinterpret_cast<PFN_SetThreadDescription>(
+        reinterpret_cast<void*>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription")));
+    if (!SetDescription)
+    {
+        return;
+    }
+
+    wchar_t WideName[PLATFORM_THREAD_NAME_LENGTH] = {};
+    MultiByteToWideChar(CP_UTF8, 0, Name, -1, WideName, PLATFORM_THREAD_NAME_LENGTH - 1);
+    SetDescription(GetCurrentThread(), WideName);
+}
+
+bool PlatformThread::SetCurrentAffinity(uint32_t LogicalCore)
+{
+    // Processor group 0 only
+    if (LogicalCore >= 64)
+    {
+        return false;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << LogicalCore) != 0;
+}
+
+uint64_t PlatformThread::GetCurrentId()
+{
+    return static_cast<uint64_t>(GetCurrentThreadId());
+}
+
+PlatformMutex::PlatformMutex()
+{
+    InitializeSRWLock(&Handle);
+}
+
+PlatformMutex::~PlatformMutex()
+{
+}
+
+void PlatformMutex::Lock()
+{
+    AcquireSRWLockExclusive(&Handle);
+}
+
+bool PlatformMutex::TryLock()
+{
+    return TryAcquireSRWLockExclusive(&Handle) != 0;
+}
+
+void PlatformMutex::Unlock()
+{
+    ReleaseSRWLockExclusive(&Handle);
+}
+
+PlatformSemaphore::PlatformSemaphore(uint32_t InitialCount)
+{
+    Handle = CreateSemaphoreW(nullptr, static_cast<LONG>(InitialCount), LONG_MAX, nullptr);
+}
+
+PlatformSemaphore::~PlatformSemaphore()
+{
+    if (Handle)
+    {
+        CloseHandle(Handle);
+    }
+}
+
+void PlatformSemaphore::Wait()
+{
+    WaitForSingleObject(Handle, INFINITE);
+}
+
+bool PlatformSemaphore::TryWait()
+{
+    return WaitForSingleObject(Handle, 0) == WAIT_OBJECT_0;
+}
+
+void PlatformSemaphore::Post(uint32_t Count)
+{
+    ReleaseSemaphore(Handle, static_cast<LONG>(Count), nullptr);
+}
+
+#endif // MPLATFORM_WINDOWS
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "Defines.h"
+
+#include <atomic>
+#include <functional>
+
+#ifdef MPLATFORM_WINDOWS
+    #include <windows.h>
+#endif
+
+#ifdef MPLATFORM_LINUX
+    #include <pthread.h>
+#endif
+
+#define PLATFORM_THREAD_ANY_CORE 0xFFFFFFFF
+#define PLATFORM_THREAD_NAME_LENGTH 32  // Linux shows the first 15 characters
+#define PLATFORM_MUTEX_SPIN_COUNT 64    // Tries before a contended lock goes to the kernel
+
+// OS thread with a name that shows up in debuggers and profilers, optionally pinned to a logical core
+// (an OS processor number, see CpuTopology::PinOrder)
+class MAPI PlatformThread
+{
+    public:
+        PlatformThread() = default;
+        ~PlatformThread();
+
+        PlatformThread(const PlatformThread&) = delete;
+        PlatformThread& operator=(const PlatformThread&) = delete;
+
+        bool Start(std::function<void()> Function, const char* Name, uint32_t LogicalCore = PLATFORM_THREAD_ANY_CORE);
+        void Join();
+        bool IsRunning() const;
+
+        static void SetCurrentName(const char* Name);
+        static bool SetCurrentAffinity(uint32_t LogicalCore);
+        static uint64_t GetCurrentId();
+
+    private:
+        void Run();
+
+    #ifdef MPLATFORM_WINDOWS
+        static DWORD WINAPI ThreadProc(LPVOID Parameter);
+        HANDLE Handle = nullptr;
+    #endif
+    #ifdef MPLATFORM_LINUX
+        static void* ThreadProc(void* Parameter);
+        pthread_t Handle;
+    #endif
+
+        // Read by the new thread before it calls Function
+        std::function<void()> Function;
+        char Name[PLATFORM_THREAD_NAME_LENGTH] = {};
+        uint32_t LogicalCore = PLATFORM_THREAD_ANY_CORE;
+        bool bRunning = false;
+};
+
+// Sleeps in the kernel only when contended (a futex on Linux, SRW lock on Windows).
+// The lower case aliases let std::lock_guard and std::unique_lock hold it.
+class MAPI PlatformMutex
+{
+    public:
+        PlatformMutex();
+        ~PlatformMutex();
+
+        PlatformMutex(const PlatformMutex&) = delete;
+        PlatformMutex& operator=(const PlatformMutex&) = delete;
+
+        void Lock();
+        bool TryLock();
+        void Unlock();
+
+        void lock() { Lock(); }
+        bool try_lock() { return TryLock(); }
+        void unlock() { Unlock(); }
+
+    private:
+    #ifdef MPLATFORM_WINDOWS
+        SRWLOCK Handle;
+    #endif
+    #ifdef MPLATFORM_LINUX
+        std::atomic<uint32_t> State;  // 0 unlocked, 1 locked, 2 locked with sleepers
+    #endif
+};
+
+// Counting semaphore, Post never blocks. A futex on Linux, a kernel semaphore on Windows.
+class MAPI PlatformSemaphore
+{
+    public:
+        explicit PlatformSemaphore(uint32_t InitialCount = 0);
+        ~PlatformSemaphore();
+
+        PlatformSemaphore(const PlatformSemaphore&) = delete;
+        PlatformSemaphore& operator=(const PlatformSemaphore&) = delete;
+
+        void Wait();
+        bool TryWait();
+        void Post(uint32_t Count = 1);
+
+    private:
+    #ifdef MPLATFORM_WINDOWS
+        HANDLE Handle;
+    #endif
+    #ifdef MPLATFORM_LINUX
+        std::atomic<uint32_t> Count;
+        std::atomic<uint32_t> Waiters;
+    #endif
+};
+
+// Atomic access to plain integers, e.g. counters that live in memory shared with code that doesn't
+// know about std::atomic. Everything is sequentially consistent unless the name says otherwise.
+#ifdef _MSC_VER
+    #include <intrin.h>
+
+MINLINE uint32_t AtomicLoadAcquire(const volatile uint32_t* Ptr)
+{
+    const uint32_t Value = *Ptr;
+    _ReadWriteBarrier();
+    return Value;
+}
+
+MINLINE uint64_t AtomicLoadAcquire(const volatile uint64_t* Ptr)
+{
+    const uint64_t Value = *Ptr;
+    _ReadWriteBarrier();
+    return Value;
+}
+
+MINLINE void AtomicStoreRelease(volatile uint32_t* Ptr, uint32_t Value)
+{
+    _ReadWriteBarrier();
+    *Ptr = Value;
+}
+
+MINLINE void AtomicStoreRelease(volatile uint64_t* Ptr, uint64_t Value)
+{
+    _ReadWriteBarrier();
+    *Ptr = Value;
+}
+
+MINLINE uint32_t AtomicFetchAdd(volatile uint32_t* Ptr, uint32_t Value)
+{
+    return static_cast<uint32_t>(_InterlockedExchangeAdd(reinterpret_cast<volatile long*>(Ptr), static_cast<long>(Value)));
+}
+
+MINLINE uint64_t AtomicFetchAdd(volatile uint64_t* Ptr, uint64_t Value)
+{
+    return static_cast<uint64_t>(_InterlockedExchangeAdd64(reinterpret_cast<volatile long long*>(Ptr), static_cast<long long>(Value)));
+}
+
+MINLINE bool AtomicCompareExchange(volatile uint32_t* Ptr, uint32_t* Expected, uint32_t Desired)
+{
+    const uint32_t Previous = static_cast<uint32_t>(_InterlockedCompareExchange(reinterpret_cast<volatile long*>(Ptr), static_cast<long>(Desired), static_cast<long>(*Expected)));
+    const bool bSwapped = Previous == *Expected;
+    *Expected = Previous;
+    return bSwapped;
+}
+
+MINLINE bool AtomicCompareExchange(volatile uint64_t* Ptr, uint64_t* Expected, uint64_t Desired)
+{
+    const uint64_t Previous = static_cast<uint64_t>(_InterlockedCompareExchange64(reinterpret_cast<volatile long long*>(Ptr), static_cast<long long>(Desired), static_cast<long long>(*Expected)));
+    const bool bSwapped = Previous == *Expected;
+    *Expected = Previous;
+    return bSwapped;
+}
+#else
+template<typename T>
+MINLINE T AtomicLoadAcquire(const volatile T* Ptr)
+{
+    return __atomic_load_n(Ptr, __ATOMIC_ACQUIRE);
+}
+
+template<typename T>
+MINLINE void AtomicStoreRelease(volatile T* Ptr, T Value)
+{
+    __atomic_store_n(Ptr, Value, __ATOMIC_RELEASE);
+}
+
+template<typename T>
+MINLINE T AtomicFetchAdd(volatile T* Ptr, T Value)
+{
+    return __atomic_fetch_add(Ptr, Value, __ATOMIC_SEQ_CST);
+}
+
+template<typename T>
+MINLINE bool AtomicCompareExchange(volatile T* Ptr, T* Expected, T Desired)
+{
+    return __atomic_compare_exchange_n(Ptr, Expected, Desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+#endif
@@ -0,0 +1,111 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_PLATFORM
+
+#include "Platform.h"
+#include "PlatformTsc.h"
+
+#include "core/Logger.h"
+
+// Accuracy: reading the OS clock is off by about a microsecond, so the 20 ms startup calibration gets the rate
+// to roughly 50 ppm, seconds a day on its own. RefineTsc re-measures the rate over everything since startup,
+// under 1 ppm after a second and shrinking from there, and slews out the offset accumulated so far over the
+// next interval. While PumpMessages keeps running the TSC time stays within tens of microseconds of the OS clock.
+#define TSC_CALIBRATION_MS 20
+#define TSC_REFINE_INTERVAL_NS 1000000000ull
+
+void Platform::CalibrateTsc()
+{
+    bUseTsc = false;
+
+#ifdef MLOK_TSC_CLOCK_AVAILABLE
+    if (!HasInvariantTsc())
+    {
+        MlokInfo("Invariant TSC isn't available, using the OS monotonic clock");
+        return;
+    }
+
+    // Measure the TSC rate against the OS clock, both read back to back on each end of a short sleep
+    const uint64_t StartNs = GetOsTimeNs();
+    const uint64_t StartTsc = ReadTsc();
+    PlatformSleep(TSC_CALIBRATION_MS);
+    const uint64_t EndNs = GetOsTimeNs();
+    const uint64_t EndTsc = ReadTsc();
+
+    if (EndTsc <= StartTsc || EndNs <= StartNs)
+    {
+        MlokWarning("TSC calibration failed, using the OS monotonic clock");
+        return;
+    }
+
+    TscCalibrationTsc = StartTsc;
+    TscCalibrationNs = StartNs;
+    TscLastRefineNs = EndNs;
+
+    TscSequence.store(0, std::memory_order_relaxed);
+    TscMultiplier.store(((EndNs - StartNs) << 32) / (EndTsc - StartTsc), std::memory_order_relaxed);
+    TscBase.store(EndTsc, std::memory_order_relaxed);
+    TscBaseNs.store(EndNs, std::memory_order_relaxed);
+    bUseTsc = true;
+
+    MlokInfo("Using TSC clock at %.3f MHz", (EndTsc - StartTsc) * 1000.0 / (EndNs - StartNs));
+#endif
+}
+
+void Platform::RefineTsc()
+{
+#ifdef MLOK_TSC_CLOCK_AVAILABLE
+    if (!bUseTsc)
+    {
+        return;
+    }
+
+    const uint64_t NowNs = GetOsTimeNs();
+    if (NowNs - TscLastRefineNs < TSC_REFINE_INTERVAL_NS)
+    {
+        return;
+    }
+    const uint64_t NowTsc = ReadTsc();
+    TscLastRefineNs = NowNs;
+
+    // The new mapping starts where the current one is now, so the TSC time never jumps
+    const uint64_t NowTscNs = GetTscTimeNs();
+    const double Rate = static_cast<double>(NowNs - TscCalibrationNs) / static_cast<double>(NowTsc - TscCalibrationTsc);
+
+    // Run slightly fast or slow until the next refine to make up the offset, at most by half the interval
+    const double Interval = static_cast<double>(TSC_REFINE_INTERVAL_NS);
+    double Offset = static_cast<double>(NowNs) - static_cast<double>(NowTscNs);
+    Offset = Offset < -Interval / 2 ? -Interval / 2 : (Offset > Interval / 2 ? Interval / 2 : Offset);
+    const uint64_t Multiplier = static_cast<uint64_t>(Rate * (Interval + Offset) / Interval * 4294967296.0);
+
+    const uint32_t Sequence = TscSequence.load(std::memory_order_relaxed);
+    TscSequence.store(Sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    TscMultiplier.store(Multiplier, std::memory_order_relaxed);
+    TscBase.store(NowTsc, std::memory_order_relaxed);
+    TscBaseNs.store(NowTscNs, std::memory_order_relaxed);
+    TscSequence.store(Sequence + 2, std::memory_order_release);
+#endif
+}
+
+uint64_t Platform::GetTscTimeNs() const
+{
+#ifdef MLOK_TSC_CLOCK_AVAILABLE
+    uint32_t Sequence;
+    uint64_t Base;
+    uint64_t BaseNs;
+    uint64_t Multiplier;
+    do
+    {
+        Sequence = TscSequence.load(std::memory_order_acquire);
+        Base = TscBase.load(std::memory_order_relaxed);
+        BaseNs = TscBaseNs.load(std::memory_order_relaxed);
+        Multiplier = TscMultiplier.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((Sequence & 1) != 0 || Sequence != TscSequence.load(std::memory_order_relaxed));
+
+    // Another core's TSC may be a few ticks behind the one that set the base
+    const uint64_t Now = ReadTsc();
+    return BaseNs + MulShift32(Now > Base ? Now - Base : 0, Multiplier);
+#else
+    return 0;
+#endif
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Defines.h"
+
+// TSC backed clock, enabled with MLOK_TSC_CLOCK on x86-64. Only used when the CPU reports an invariant TSC,
+// which ticks at a constant rate across power states and is synchronized between cores.
+#if defined(MLOK_TSC_CLOCK) && (defined(__x86_64__) || defined(_M_X64))
+    #define MLOK_TSC_CLOCK_AVAILABLE 1
+
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+        #include <x86intrin.h>
+    #endif
+
+MINLINE uint64_t ReadTsc()
+{
+    return __rdtsc();
+}
+
+MINLINE bool HasInvariantTsc()
+{
+    uint32_t Regs[4] = {};
+#ifdef _MSC_VER
+    __cpuid(reinterpret_cast<int*>(Regs), 0x80000000);
+    if (Regs[0] < 0x80000007)
+    {
+        return false;
+    }
+    __cpuid(reinterpret_cast<int*>(Regs), 0x80000007);
+#else
+    if (__get_cpuid_max(0x80000000, nullptr) < 0x80000007)
+    {
+        return false;
+    }
+    __get_cpuid(0x80000007, &Regs[0], &Regs[1], &Regs[2], &Regs[3]);
+#endif
+    return (Regs[3] & (1u << 8)) != 0;
+}
+
+// (Value * Multiplier) >> 32 without overflowing, Multiplier is a 32.32 fixed point
+MINLINE uint64_t MulShift32(uint64_t Value, uint64_t Multiplier)
+{
+#ifdef _MSC_VER
+    uint64_t High;
+    const uint64_t Low = _umul128(Value, Multiplier, &High);
+    return (High << 32) | (Low >> 32);
+#else
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(Value) * Multiplier) >> 32);
+#endif
+}
+#endif
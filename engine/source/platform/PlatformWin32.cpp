@@ -1,3 +1,5 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_PLATFORM
+
 #include "Platform.h"
 
 #ifdef MPLATFORM_WINDOWS
@@ -23,7 +25,8 @@ Platform* Platform::Get()
 bool Platform::Startup(size_t* outMemReq, void* Ptr,
                        const std::string& ApplicationName,
                        int32_t X, int32_t Y, 
-                       int32_t Width, int32_t Height)
+                       int32_t Width, int32_t Height,
+                       bool bHeadless)
 {
     *outMemReq = sizeof(Platform);
     if (Ptr == nullptr)
@@ -31,7 +34,19 @@ bool Platform::Startup(size_t* outMemReq, void* Ptr,
         return true;
     }
 
-    Instance = static_cast<Platform*>(Ptr);
+    Instance = new (Ptr) Platform();
+    Instance->bHeadless = bHeadless;
+
+    QueryPerformanceCounter(&Instance->StartTime);
+
+    Instance->CalibrateTsc();
+
+    Instance->SleepTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+
+    if (bHeadless)
+    {
+        return true;
+    }
     
     Instance->hInstance = GetModuleHandleA(0);
     LPCSTR WindowClass = "MlokWindowClass";
@@ -91,16 +106,35 @@ bool Platform::Startup(size_t* outMemReq, void* Ptr,
     int32_t ShowWindowCommandFlags = bShouldActivate ? SW_SHOW : SW_SHOWNOACTIVATE;
     ShowWindow(Instance->hWnd, ShowWindowCommandFlags);
 
-    LARGE_INTEGER Frequency;
-    QueryPerformanceFrequency(&Frequency);
-    Instance->ClockFrequency = 1.f / (double)Frequency.QuadPart;
-    QueryPerformanceCounter(&Instance->StartTime);
+#ifdef MLOK_RAW_MOUSE_INPUT
+    RAWINPUTDEVICE MouseDevice;
+    MouseDevice.usUsagePage = 0x01; // HID_USAGE_PAGE_GENERIC
+    MouseDevice.usUsage = 0x02;     // HID_USAGE_GENERIC_MOUSE
+    MouseDevice.dwFlags = 0;
+    MouseDevice.hwndTarget = Instance->hWnd;
+    if (!RegisterRawInputDevices(&MouseDevice, 1, sizeof(MouseDevice)))
+    {
+        MlokWarning("Failed to register raw mouse input, falling back to cursor motion");
+    }
+#endif
 
     return true;
 }
 
 void Platform::Shutdown()
 {
+    // Startup runs as a startup graph step, it never ran if an earlier step failed
+    if (!Instance)
+    {
+        return;
+    }
+
+    if (Instance->SleepTimer)
+    {
+        CloseHandle(Instance->SleepTimer);
+        Instance->SleepTimer = nullptr;
+    }
+
     if (Instance->hWnd)
     {
         DestroyWindow(Instance->hWnd);
@@ -112,9 +146,19 @@ void Platform::Shutdown()
 
 bool Platform::PumpMessages()
 {
+    RefineTsc();
+
+    if (bHeadless)
+    {
+        return true;
+    }
+
     MSG Message;
     while(PeekMessageA(&Message, nullptr, 0, 0, PM_REMOVE))
     {
+        // Input messages are stamped with the time they were dequeued, GetMessageTime only has ms resolution
+        MessageTimestamp = GetAbsoluteTime();
+
         TranslateMessage(&Message);
         DispatchMessageA(&Message);
     }
@@ -123,6 +167,11 @@ bool Platform::PumpMessages()
 }
 
 
+bool Platform::IsHeadless() const
+{
+    return bHeadless;
+}
+
 void* Platform::PlatformAllocate(size_t Size, bool bAligned)
 {
     return malloc(Size);
@@ -170,11 +219,39 @@ void Platform::ConsoleWriteError(const std::string& Message, uint8_t Color)
     WriteConsoleA(ConsoleHandle, Message.c_str(), Message.length(), NumberWritten, nullptr);
 }
 
-double Platform::GetAbsoluteTime()
+uint64_t Platform::GetAbsoluteTimeNs()
+{
+    if (bUseTsc)
+    {
+        return GetTscTimeNs();
+    }
+
+    return GetOsTimeNs();
+}
+
+uint64_t Platform::GetOsTimeNs()
 {
+    // Performance counter ticks per second, fixed at boot
+    static const uint64_t ClockFrequency = []()
+    {
+        LARGE_INTEGER Frequency;
+        QueryPerformanceFrequency(&Frequency);
+        return static_cast<uint64_t>(Frequency.QuadPart);
+    }();
+
     LARGE_INTEGER NowTime;
     QueryPerformanceCounter(&NowTime);
-    return (double)NowTime.QuadPart * ClockFrequency;
+
+    // Split the conversion, Counter * 1e9 would overflow after a few days of uptime
+    const uint64_t Counter = static_cast<uint64_t>(NowTime.QuadPart);
+    const uint64_t Seconds = Counter / ClockFrequency;
+    const uint64_t Remainder = Counter % ClockFrequency;
+    return Seconds * 1000000000ull + Remainder * 1000000000ull / ClockFrequency;
+}
+
+double Platform::GetAbsoluteTime()
+{
+    return static_cast<double>(GetAbsoluteTimeNs()) * 1e-9;
 }
 
 void Platform::PlatformSleep(uint64_t ms)
@@ -182,7 +259,35 @@ void Platform::PlatformSleep(uint64_t ms)
     Sleep(ms);
 }
 
-void Platform::GetRequiredExtensionNames(std::vector<const char*>& OutExtensions) const
+void Platform::SleepUntilNs(uint64_t AbsoluteTimeNs)
+{
+    const uint64_t Now = GetAbsoluteTimeNs();
+    if (AbsoluteTimeNs <= Now)
+    {
+        return;
+    }
+    const uint64_t Remaining = AbsoluteTimeNs - Now;
+
+    if (SleepTimer)
+    {
+        LARGE_INTEGER DueTime;
+        DueTime.QuadPart = -static_cast<LONGLONG>(Remaining / 100); // Relative, in 100 ns units
+        if (SetWaitableTimerEx(SleepTimer, &DueTime, 0, nullptr, nullptr, nullptr, 0))
+        {
+            WaitForSingleObject(SleepTimer, INFINITE);
+            return;
+        }
+    }
+
+    Sleep(static_cast<DWORD>(Remaining / 1000000));
+}
+
+void Platform::SpinPause()
+{
+    YieldProcessor();
+}
+
+void Platform::GetRequiredExtensionNames(std::vector<const char*>& OutExtensions)
 {
     OutExtensions.push_back("VK_KHR_win32_surface");
 }
@@ -277,7 +382,7 @@ LRESULT Platform::Win32ProcessMessage(HWND hWnd, uint32_t Message, WPARAM wParam
                     Key = bExtended ? KEY_RCONTROL : KEY_LCONTROL;
                 }
 
-                InputSystem::Get()->ProcessKey(Key, bPressed);
+                InputSystem::Get()->ProcessKey(Key, bPressed, Instance->MessageTimestamp);
             }
             break;
         case WM_MOUSEMOVE:
@@ -285,9 +390,24 @@ LRESULT Platform::Win32ProcessMessage(HWND hWnd, uint32_t Message, WPARAM wParam
                 int32_t XPos = GET_X_LPARAM(lParam);
                 int32_t YPos = GET_Y_LPARAM(lParam);
                 
-                InputSystem::Get()->ProcessMouseMove(XPos, YPos);
+                InputSystem::Get()->ProcessMouseMove(XPos, YPos, Instance->MessageTimestamp);
+            }
+            break;
+#ifdef MLOK_RAW_MOUSE_INPUT
+        case WM_INPUT:
+            {
+                RAWINPUT RawInput;
+                UINT Size = sizeof(RawInput);
+                if (GetRawInputData(reinterpret_cast<HRAWINPUT>(lParam), RID_INPUT, &RawInput, &Size, sizeof(RAWINPUTHEADER)) != static_cast<UINT>(-1) &&
+                    RawInput.header.dwType == RIM_TYPEMOUSE && !(RawInput.data.mouse.usFlags & MOUSE_MOVE_ABSOLUTE))
+                {
+                    InputSystem::Get()->ProcessMouseRawMotion(static_cast<float>(RawInput.data.mouse.lLastX),
+                                                              static_cast<float>(RawInput.data.mouse.lLastY),
+                                                              Instance->MessageTimestamp);
+                }
             }
             break;
+#endif // MLOK_RAW_MOUSE_INPUT
         case WM_MOUSEWHEEL:
             {
                 int32_t WheelDelta = GET_WHEEL_DELTA_WPARAM(wParam);
@@ -295,7 +415,7 @@ LRESULT Platform::Win32ProcessMessage(HWND hWnd, uint32_t Message, WPARAM wParam
                 {
                     WheelDelta = (WheelDelta < 0) ? -1 : 1;
                     
-                    InputSystem::Get()->ProcessMouseWheel(WheelDelta);
+                    InputSystem::Get()->ProcessMouseWheel(WheelDelta, Instance->MessageTimestamp);
                 }
             }
             break;
@@ -327,7 +447,7 @@ LRESULT Platform::Win32ProcessMessage(HWND hWnd, uint32_t Message, WPARAM wParam
                     break;
                 }
 
-                InputSystem::Get()->ProcessMouseButton(Button, bPressed);
+                InputSystem::Get()->ProcessMouseButton(Button, bPressed, Instance->MessageTimestamp);
             }
             break;
         default:
@@ -0,0 +1,211 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_RENDERER
+
+#include "RenderStats.h"
+
+#include "core/Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+RenderStats* RenderStats::Instance = nullptr;
+
+static const char* CounterNames[] = { "draw_calls", "triangles", "pipeline_binds", "descriptor_binds", "upload_bytes", "submits",
+                                      "input_vertices", "input_primitives", "vertex_invocations", "clipping_primitives", "fragment_invocations" };
+static_assert(sizeof(CounterNames) / sizeof(CounterNames[0]) == static_cast<size_t>(RenderCounter::RENDER_COUNTER_MAX), "A name per render counter");
+
+MINLINE bool IsPipelineStatistic(size_t Counter)
+{
+    return Counter >= static_cast<size_t>(RENDER_COUNTER_FIRST_PIPELINE_STATISTIC);
+}
+
+RenderStats* RenderStats::Get()
+{
+    return Instance;
+}
+
+bool RenderStats::Initialize(size_t* outMemReq, void* Ptr, const RenderStatsConfig& Config)
+{
+    *outMemReq = sizeof(RenderStats);
+    if (Ptr == nullptr)
+    {
+        return true;
+    }
+
+    Instance = new (Ptr) RenderStats();
+    Instance->bEnabled = Config.bEnabled;
+    Instance->bLogReport = Config.bLogReport;
+    Instance->ReportInterval = static_cast<uint64_t>(Config.ReportIntervalSeconds * 1e9);
+    Instance->bPipelineStatistics.store(false, std::memory_order_relaxed);
+    Instance->CsvFile = nullptr;
+
+    for (std::atomic<uint64_t>& Counter : Instance->Current)
+    {
+        Counter.store(0, std::memory_order_relaxed);
+    }
+    std::memset(&Instance->LastFrame, 0, sizeof(RenderStatsFrame));
+
+    if (Instance->bEnabled && !Config.CsvPath.empty())
+    {
+        // Kept across runs so they can be compared, the header is only written to a new file. Time is since startup,
+        // rows of a run share its wall clock start
+        Instance->RunStart = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+
+        FILE* Csv = std::fopen(Config.CsvPath.c_str(), "a");
+        if (!Csv)
+        {
+            MlokWarning("Failed to open render stats CSV file %s", Config.CsvPath.c_str());
+        }
+        else
+        {
+            std::fseek(Csv, 0, SEEK_END);
+            if (std::ftell(Csv) == 0)
+            {
+                std::fputs("run_start_ms,time_s,frames", Csv);
+                for (const char* Name : CounterNames)
+                {
+                    std::fprintf(Csv, ",%s_avg,%s_max", Name, Name);
+                }
+                std::fputc('\n', Csv);
+            }
+            Instance->CsvFile = Csv;
+        }
+    }
+
+    Instance->ResetWindow(0);
+
+    return true;
+}
+
+void RenderStats::Shutdown()
+{
+    if (!Instance)
+    {
+        return;
+    }
+
+    if (Instance->CsvFile)
+    {
+        std::fclose(static_cast<FILE*>(Instance->CsvFile));
+        Instance->CsvFile = nullptr;
+    }
+
+    Instance->~RenderStats();
+    Instance = nullptr;
+}
+
+void RenderStats::Add(RenderCounter Counter, uint64_t Value)
+{
+    if (bEnabled)
+    {
+        Current[static_cast<size_t>(Counter)].fetch_add(Value, std::memory_order_relaxed);
+    }
+}
+
+void RenderStats::EndFrame(uint64_t NowNs)
+{
+    if (!bEnabled)
+    {
+        return;
+    }
+
+    std::lock_guard<PlatformMutex> Lock(Mutex);
+
+    if (WindowStart == 0)
+    {
+        WindowStart = NowNs;
+    }
+
+    for (size_t i = 0; i < static_cast<size_t>(RenderCounter::RENDER_COUNTER_MAX); ++i)
+    {
+        const uint64_t Count = Current[i].exchange(0, std::memory_order_relaxed);
+        LastFrame.Counts[i] = Count;
+        WindowTotals[i] += Count;
+        WindowMax[i] = std::max(WindowMax[i], Count);
+    }
+    ++WindowFrames;
+
+    if (ReportInterval > 0 && NowNs - WindowStart >= ReportInterval)
+    {
+        Report(NowNs);
+        ResetWindow(NowNs);
+    }
+}
+
+void RenderStats::SetPipelineStatisticsAvailable(bool bAvailable)
+{
+    bPipelineStatistics.store(bAvailable, std::memory_order_relaxed);
+}
+
+bool RenderStats::HasPipelineStatistics() const
+{
+    return bPipelineStatistics.load(std::memory_order_relaxed);
+}
+
+void RenderStats::GetLastFrame(RenderStatsFrame* OutFrame) const
+{
+    std::lock_guard<PlatformMutex> Lock(Mutex);
+    *OutFrame = LastFrame;
+}
+
+void RenderStats::GetSummary(RenderCounter Counter, RenderCounterSummary* OutSummary) const
+{
+    const size_t Index = static_cast<size_t>(Counter);
+
+    std::lock_guard<PlatformMutex> Lock(Mutex);
+    OutSummary->FrameCount = WindowFrames;
+    OutSummary->Total = WindowTotals[Index];
+    OutSummary->MaxPerFrame = WindowMax[Index];
+    OutSummary->AveragePerFrame = WindowFrames > 0 ? static_cast<double>(WindowTotals[Index]) / WindowFrames : 0.0;
+}
+
+const char* RenderStats::GetCounterName(RenderCounter Counter)
+{
+    const size_t Index = static_cast<size_t>(Counter);
+    return Index < static_cast<size_t>(RenderCounter::RENDER_COUNTER_MAX) ? CounterNames[Index] : "unknown";
+}
+
+void RenderStats::Report(uint64_t NowNs)
+{
+    const double WindowSeconds = (NowNs - WindowStart) * 1e-9;
+    const bool bStatistics = HasPipelineStatistics();
+
+    if (bLogReport && WindowFrames > 0)
+    {
+        MlokInfo("Render stats over %.1f s: %u frames, per frame:", WindowSeconds, WindowFrames);
+        for (size_t i = 0; i < static_cast<size_t>(RenderCounter::RENDER_COUNTER_MAX); ++i)
+        {
+            if (IsPipelineStatistic(i) && !bStatistics)
+            {
+                continue;
+            }
+
+            MlokInfo("    %-22s avg %12.1f  max %12llu", CounterNames[i],
+                     static_cast<double>(WindowTotals[i]) / WindowFrames, static_cast<unsigned long long>(WindowMax[i]));
+        }
+    }
+
+    if (CsvFile)
+    {
+        FILE* Csv = static_cast<FILE*>(CsvFile);
+        std::fprintf(Csv, "%llu,%.3f,%u", static_cast<unsigned long long>(RunStart), NowNs * 1e-9, WindowFrames);
+        for (size_t i = 0; i < static_cast<size_t>(RenderCounter::RENDER_COUNTER_MAX); ++i)
+        {
+            const double Average = WindowFrames > 0 ? static_cast<double>(WindowTotals[i]) / WindowFrames : 0.0;
+            std::fprintf(Csv, ",%.2f,%llu", Average, static_cast<unsigned long long>(WindowMax[i]));
+        }
+        std::fputc('\n', Csv);
+        std::fflush(Csv);
+    }
+}
+
+void RenderStats::ResetWindow(uint64_t NowNs)
+{
+    std::memset(WindowTotals, 0, sizeof(WindowTotals));
+    std::memset(WindowMax, 0, sizeof(WindowMax));
+    WindowFrames = 0;
+    WindowStart = NowNs;
+}
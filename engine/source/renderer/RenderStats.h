@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Defines.h"
+
+#include "platform/PlatformThread.h"
+
+#include <atomic>
+
+enum class RenderCounter
+{
+    RENDER_COUNTER_DRAW_CALLS,
+    RENDER_COUNTER_TRIANGLES,               // Assuming triangle lists
+    RENDER_COUNTER_PIPELINE_BINDS,
+    RENDER_COUNTER_DESCRIPTOR_BINDS,        // Descriptor sets bound
+    RENDER_COUNTER_UPLOAD_BYTES,            // Written to GPU buffers from the CPU
+    RENDER_COUNTER_SUBMITS,                 // Queue submissions
+
+    // Pipeline statistics queries, only when the device supports them. They arrive with the GPU timestamps,
+    // a few frames late, and are added to the frame that ends next.
+    RENDER_COUNTER_INPUT_VERTICES,
+    RENDER_COUNTER_INPUT_PRIMITIVES,
+    RENDER_COUNTER_VERTEX_INVOCATIONS,
+    RENDER_COUNTER_CLIPPING_PRIMITIVES,     // Primitives that survived clipping
+    RENDER_COUNTER_FRAGMENT_INVOCATIONS,
+
+    RENDER_COUNTER_MAX
+};
+
+#define RENDER_COUNTER_FIRST_PIPELINE_STATISTIC RenderCounter::RENDER_COUNTER_INPUT_VERTICES
+
+typedef struct RenderStatsConfig
+{
+    bool bEnabled = true;
+    double ReportIntervalSeconds = 10.0;    // Length of the rolling window, 0 never reports
+    bool bLogReport = true;
+    std::string CsvPath;                    // A row per window is appended when set, earlier runs are kept for automated regression checks
+} RenderStatsConfig;
+
+typedef struct RenderStatsFrame
+{
+    uint64_t Counts[static_cast<size_t>(RenderCounter::RENDER_COUNTER_MAX)];
+} RenderStatsFrame;
+
+typedef struct RenderCounterSummary
+{
+    uint32_t FrameCount;
+    double AveragePerFrame;
+    uint64_t MaxPerFrame;
+    uint64_t Total;
+} RenderCounterSummary;
+
+// Engine-wide render counters. Any thread adds to the frame being recorded, the thread that draws ends
+// frames and every window of ReportIntervalSeconds is logged and appended to the CSV file.
+class MAPI RenderStats
+{
+    public:
+        static RenderStats* Get();
+
+        static bool Initialize(size_t* outMemReq, void* Ptr, const RenderStatsConfig& Config = RenderStatsConfig());
+        static void Shutdown();
+
+        void Add(RenderCounter Counter, uint64_t Value = 1);
+
+        // Called once per drawn frame by the renderer
+        void EndFrame(uint64_t NowNs);
+
+        // Set by the backend once it knows whether the pipeline statistics counters will be filled
+        void SetPipelineStatisticsAvailable(bool bAvailable);
+        bool HasPipelineStatistics() const;
+
+        // Counts of the last frame that ended
+        void GetLastFrame(RenderStatsFrame* OutFrame) const;
+        // Of the current window
+        void GetSummary(RenderCounter Counter, RenderCounterSummary* OutSummary) const;
+
+        static const char* GetCounterName(RenderCounter Counter);
+
+    private:
+        void Report(uint64_t NowNs);
+        void ResetWindow(uint64_t NowNs);
+
+        std::atomic<uint64_t> Current[static_cast<size_t>(RenderCounter::RENDER_COUNTER_MAX)];  // Since the last EndFrame
+
+        // Written by EndFrame, read by the getters from any thread
+        mutable PlatformMutex Mutex;
+        RenderStatsFrame LastFrame;
+        uint64_t WindowTotals[static_cast<size_t>(RenderCounter::RENDER_COUNTER_MAX)];
+        uint64_t WindowMax[static_cast<size_t>(RenderCounter::RENDER_COUNTER_MAX)];
+        uint32_t WindowFrames;
+        uint64_t WindowStart;       // 0 before the first frame
+        uint64_t ReportInterval;
+
+        std::atomic<bool> bPipelineStatistics;
+        bool bEnabled;
+        bool bLogReport;
+        void* CsvFile;              // FILE*, nullptr when the CSV dump is off
+        uint64_t RunStart;          // Unix time in ms, the first CSV column
+
+        static RenderStats* Instance;
+};
@@ -0,0 +1,116 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_RENDERER
+
+#include "RenderThread.h"
+
+#include "RendererFrontend.h"
+#include "core/Logger.h"
+#include "core/Profiler.h"
+#include "platform/Platform.h"
+
+#include <algorithm>
+#include <mutex>
+
+bool RenderThread::Start(uint32_t MaxQueuedFrames)
+{
+    if (bRunning)
+    {
+        return true;
+    }
+
+    QueueCapacity = std::clamp<uint32_t>(MaxQueuedFrames, 1, RENDER_THREAD_MAX_QUEUED_FRAMES);
+    QueueHead = 0;
+    QueueCount = 0;
+
+    // Left over from a previous run
+    while (QueuedPackets.TryWait())
+    {
+    }
+    while (FreeSlots.TryWait())
+    {
+    }
+    FreeSlots.Post(QueueCapacity);
+
+    if (!Thread.Start([this]() { Run(); }, "Mlok Render"))
+    {
+        return false;
+    }
+    bRunning = true;
+
+    MlokInfo("Render thread started, %u queued frames", QueueCapacity);
+    return true;
+}
+
+void RenderThread::Stop()
+{
+    if (!bRunning)
+    {
+        return;
+    }
+
+    // Only the main thread submits, so this post comes after every packet's
+    QueuedPackets.Post();
+
+    Thread.Join();
+    bRunning = false;
+
+    MlokInfo("Render thread stopped");
+}
+
+uint64_t RenderThread::Submit(const RenderPacket& Packet)
+{
+    uint64_t WaitedNs = 0;
+
+    if (!FreeSlots.TryWait())
+    {
+        const uint64_t WaitStart = Platform::Get()->GetAbsoluteTimeNs();
+        FreeSlots.Wait();
+        WaitedNs = Platform::Get()->GetAbsoluteTimeNs() - WaitStart;
+    }
+
+    {
+        std::lock_guard<PlatformMutex> Lock(QueueMutex);
+        Queue[(QueueHead + QueueCount) % RENDER_THREAD_MAX_QUEUED_FRAMES] = Packet;
+        ++QueueCount;
+    }
+    QueuedPackets.Post();
+
+    return WaitedNs;
+}
+
+bool RenderThread::IsRunning() const
+{
+    return bRunning;
+}
+
+void RenderThread::Run()
+{
+    for (;;)
+    {
+        QueuedPackets.Wait();
+
+        RenderPacket Packet;
+        {
+            std::lock_guard<PlatformMutex> Lock(QueueMutex);
+            if (QueueCount == 0)
+            {
+                return; // Only the post from Stop is left, everything is drawn
+            }
+
+            // The slot is released only after drawing, so a full queue also means the render thread is busy
+            Packet = Queue[QueueHead];
+            MLOK_PROFILE_COUNTER("Queued render frames", QueueCount);
+        }
+
+        if (!Renderer::Get()->DrawFrame(&Packet))
+        {
+            MlokError("Render thread failed to draw a frame");
+        }
+
+        {
+            std::lock_guard<PlatformMutex> Lock(QueueMutex);
+            QueueHead = (QueueHead + 1) % RENDER_THREAD_MAX_QUEUED_FRAMES;
+            --QueueCount;
+        }
+        FreeSlots.Post();
+    }
+}
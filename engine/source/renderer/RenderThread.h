@@ -0,0 +1,38 @@
+#pragma once
+
+#include "RendererTypes.inl"
+
+#include "platform/PlatformThread.h"
+
+#define RENDER_THREAD_MAX_QUEUED_FRAMES 2
+
+// Runs Renderer::DrawFrame on its own thread. The main thread hands packets over through a bounded queue:
+// while the render thread draws frame N, the main thread simulates frame N + 1 (and N + 2 with two queued frames).
+class RenderThread
+{
+    public:
+        // MaxQueuedFrames 1 is double buffering, 2 is triple buffering
+        bool Start(uint32_t MaxQueuedFrames);
+        // Draws whatever is still queued and joins the thread
+        void Stop();
+
+        // Blocks while the queue is full, returns the time spent waiting in nanoseconds
+        uint64_t Submit(const RenderPacket& Packet);
+
+        bool IsRunning() const;
+
+    private:
+        void Run();
+
+        PlatformThread Thread;
+        PlatformMutex QueueMutex;
+        PlatformSemaphore QueuedPackets;    // One post per submitted packet, plus one from Stop
+        PlatformSemaphore FreeSlots;        // Starts at the capacity, a slot comes back once its packet is drawn
+
+        RenderPacket Queue[RENDER_THREAD_MAX_QUEUED_FRAMES];
+        uint32_t QueueHead = 0;
+        uint32_t QueueCount = 0;
+        uint32_t QueueCapacity = 0;
+
+        bool bRunning = false;
+};
@@ -1,13 +1,17 @@
 #pragma once
 
 #include "RendererTypes.inl"
+#include "core/StartupGraph.h"
 
 class RendererBackend
 {
     public:
         virtual ~RendererBackend() {};
 
-        virtual bool Initialize(const std::string& AppName, const uint32_t FramebufferWidth, const uint32_t FramebufferHeight) = 0;
+        // Adds the initialization steps to Graph, the backend is ready once the graph has run.
+        // Steps that need the window depend on WindowStep.
+        virtual void AddInitializeSteps(StartupGraph& Graph, StartupStepId WindowStep,
+                                        const std::string& AppName, const uint32_t FramebufferWidth, const uint32_t FramebufferHeight) = 0;
         virtual void Shutdown() = 0;
 
         virtual void OnResized(uint16_t NewWidth, uint16_t Height) = 0;
@@ -1,11 +1,30 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_RENDERER
+
 #include "RendererFrontend.h"
 
 #include "renderer/vulkan/VulkanBackend.h"
+#include "renderer/null/NullBackend.h"
 #include "core/Logger.h"
+#include "core/Profiler.h"
+#include "core/FrameStats.h"
+#include "platform/Platform.h"
+#include "RenderStats.h"
 #include "math/MathTypes.h"
 
 Renderer* Renderer::Instance = nullptr;
 
+static size_t GetBackendMemoryRequirement(RendererBackendType BackendType)
+{
+    switch (BackendType)
+    {
+        case RendererBackendType::RENDERER_BACKEND_NULL:
+            return sizeof(NullBackend);
+        case RendererBackendType::RENDERER_BACKEND_VULKAN:
+        default:
+            return VulkanBackend::GetMemoryRequirement();
+    }
+}
+
 Renderer* Renderer::Get()
 {
     return Instance;
@@ -13,20 +32,45 @@ Renderer* Renderer::Get()
 
 bool Renderer::Initialize(size_t* outMemReq, void* Ptr,
                           const std::string& AppName, 
-                          const uint32_t FramebufferWidth, const uint32_t FramebufferHeight)
+                          const uint32_t FramebufferWidth, const uint32_t FramebufferHeight,
+                          RendererBackendType BackendType,
+                          StartupGraph* Graph, StartupStepId WindowStep)
 {    
-    *outMemReq = sizeof(Renderer);
+    const size_t BackendOffset = AlignUp(sizeof(Renderer), MLOK_CACHE_LINE_SIZE);
+
+    *outMemReq = BackendOffset + GetBackendMemoryRequirement(BackendType);
     if (Ptr == nullptr)
     {
         return true;
     }
 
-    Instance = static_cast<Renderer*>(Ptr);
+    // The atomic and the backend pointer need their constructors to run
+    Instance = new (Ptr) Renderer();
+
+    void* BackendMemory = static_cast<uint8_t*>(Ptr) + BackendOffset;
+    switch (BackendType)
+    {
+        case RendererBackendType::RENDERER_BACKEND_NULL:
+            Instance->Backend.reset(new (BackendMemory) NullBackend());
+            break;
+        case RendererBackendType::RENDERER_BACKEND_VULKAN:
+        default:
+            Instance->Backend.reset(new (BackendMemory) VulkanBackend());
+            break;
+    }
+
+    if (Graph)
+    {
+        Instance->Backend->AddInitializeSteps(*Graph, WindowStep, AppName, FramebufferWidth, FramebufferHeight);
+        return true;
+    }
 
-    Instance->Backend = std::make_unique<VulkanBackend>(); // TODO: make some more flexible way to choose renderer backend
-    if (!Instance->Backend->Initialize(AppName, FramebufferWidth, FramebufferHeight))
+    StartupGraph BackendStartup;
+    Instance->Backend->AddInitializeSteps(BackendStartup, STARTUP_GRAPH_INVALID_STEP, AppName, FramebufferWidth, FramebufferHeight);
+    if (!BackendStartup.Run())
     {
         MlokFatal("Renderer backend failed to initialize. Shutting down...");
+        Shutdown();
         return false;
     }
 
@@ -35,11 +79,18 @@ bool Renderer::Initialize(size_t* outMemReq, void* Ptr,
 
 void Renderer::Shutdown()
 {
+    if (!Instance)
+    {
+        return;
+    }
+
     if (Instance->Backend)
     {
         Instance->Backend->Shutdown();
     }
 
+    // Also destroys the backend, whose objects were all released by its Shutdown
+    Instance->~Renderer();
     Instance = nullptr;
 }
 
@@ -47,7 +98,7 @@ void Renderer::OnResized(uint16_t NewWidth, uint16_t NewHeight)
 {
     if (Backend)
     {
-        Backend->OnResized(NewWidth, NewHeight);
+        PendingResize.store((1ull << 32) | (static_cast<uint64_t>(NewWidth) << 16) | NewHeight, std::memory_order_release);
     }
     else
     {
@@ -57,20 +108,36 @@ void Renderer::OnResized(uint16_t NewWidth, uint16_t NewHeight)
 
 bool Renderer::DrawFrame(RenderPacket* Packet)
 {
+    MLOK_PROFILE_SCOPE("Renderer::DrawFrame");
+
+    const uint64_t Resize = PendingResize.exchange(0, std::memory_order_acquire);
+    if (Resize != 0 && Backend)
+    {
+        Backend->OnResized(static_cast<uint16_t>(Resize >> 16), static_cast<uint16_t>(Resize));
+    }
+
+    FrameStats::Get()->BeginRenderFrame(Packet->FrameIndex);
+
+    bool bResult = true;
     if (BeginFrame(Packet->DeltaTime))
     {
         Backend->UpdateGlobalState(Mat4_I(), Mat4_I(), {}, { 1.f, 1.f, 1.f, 1.f }, 0);
 
-        bool bResult = EndFrame(Packet->DeltaTime);
+        bResult = EndFrame(Packet->DeltaTime);
 
-        if (!bResult)
+        if (bResult)
+        {
+            RenderStats::Get()->EndFrame(Platform::Get()->GetAbsoluteTimeNs());
+        }
+        else
         {
             MlokError("Renderer EndFrame failed. Shutting down...");
-            return false;
         }
     }
 
-    return true;
+    FrameStats::Get()->EndRenderFrame();
+
+    return bResult;
 }
 
 bool Renderer::BeginFrame(float DeltaTime)
@@ -2,22 +2,32 @@
 
 #include "RendererTypes.inl"
 #include "RendererBackend.h"
+#include "core/MlokMemory.h"
+
+#include <atomic>
 
 class Renderer
 {
     public:
         static Renderer* Get();
 
+        // With a Graph the backend only adds its steps to it and is ready once the graph has run,
+        // without one it is initialized right away
         static bool Initialize(size_t* outMemReq, void* Ptr,
                                const std::string& AppName, 
-                               const uint32_t FramebufferWidth, const uint32_t FramebufferHeight);
+                               const uint32_t FramebufferWidth, const uint32_t FramebufferHeight,
+                               RendererBackendType BackendType = RendererBackendType::RENDERER_BACKEND_VULKAN,
+                               StartupGraph* Graph = nullptr, StartupStepId WindowStep = STARTUP_GRAPH_INVALID_STEP);
         static void Shutdown();
 
+        // Safe to call from any thread, the backend picks the new size up on the next DrawFrame
         void OnResized(uint16_t NewWidth, uint16_t NewHeight);
         bool DrawFrame(RenderPacket* Packet);
 
     private:
-        std::unique_ptr<RendererBackend> Backend;
+        PlacementPtr<RendererBackend> Backend; // Lives right behind the Renderer in its memory
+
+        std::atomic<uint64_t> PendingResize { 0 }; // Bit 32 marks a pending resize, width and height below it
 
         bool BeginFrame(float DeltaTime);
         bool EndFrame(float DeltaTime);
@@ -3,9 +3,18 @@
 #include "Defines.h"
 #include "math/MathTypes.h"
 
+enum class RendererBackendType
+{
+    RENDERER_BACKEND_VULKAN,
+    RENDERER_BACKEND_NULL       // Renders nothing, for headless runs
+};
+
 typedef struct RenderPacket
 {
     float DeltaTime;
+    float InterpolationAlpha;   // Progress between the last two simulation ticks, [0, 1)
+    uint64_t SimulationTick;    // Latest simulated tick
+    uint64_t FrameIndex;        // Of the main thread frame that built the packet
 } RenderPacket;
 
 typedef struct GlobalUniformObject
@@ -0,0 +1,41 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_RENDERER
+
+#include "NullBackend.h"
+
+#include "core/Logger.h"
+
+void NullBackend::AddInitializeSteps(StartupGraph& Graph, StartupStepId WindowStep,
+                                     const std::string& AppName, const uint32_t FramebufferWidth, const uint32_t FramebufferHeight)
+{
+    FrameCount = 0;
+
+    Graph.AddStep("Null renderer", [FramebufferWidth, FramebufferHeight]()
+    {
+        MlokInfo("Null Renderer Backend initialized (%ux%u)", FramebufferWidth, FramebufferHeight);
+        return true;
+    });
+}
+
+void NullBackend::Shutdown()
+{
+    MlokInfo("Null Renderer Backend shut down after %llu frames", FrameCount);
+}
+
+void NullBackend::OnResized(uint16_t NewWidth, uint16_t NewHeight)
+{
+}
+
+bool NullBackend::BeginFrame(float DeltaTime)
+{
+    return true;
+}
+
+bool NullBackend::EndFrame(float DeltaTime)
+{
+    FrameCount++;
+    return true;
+}
+
+void NullBackend::UpdateGlobalState(Mat4 Projection, Mat4 View, Vec3 ViewPosition, Vec4 AmbientColor, int32_t Mode)
+{
+}
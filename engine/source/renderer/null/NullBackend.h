@@ -0,0 +1,20 @@
+#pragma once
+
+#include "renderer/RendererBackend.h"
+#include "math/MathTypes.h"
+
+// Accepts every call and renders nothing. Used in headless mode, so the frame loop runs
+// without a GPU, a display or a Vulkan loader.
+class NullBackend : public RendererBackend
+{
+    public:
+        virtual void AddInitializeSteps(StartupGraph& Graph, StartupStepId WindowStep,
+                                        const std::string& AppName, const uint32_t FramebufferWidth, const uint32_t FramebufferHeight) override;
+        virtual void Shutdown() override;
+
+        virtual void OnResized(uint16_t NewWidth, uint16_t NewHeight) override;
+        virtual bool BeginFrame(float DeltaTime) override;
+        virtual bool EndFrame(float DeltaTime) override;
+
+        virtual void UpdateGlobalState(Mat4 Projection, Mat4 View, Vec3 ViewPosition, Vec4 AmbientColor, int32_t Mode) override;
+};
@@ -1,3 +1,5 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_VULKAN
+
 #include "VulkanBackend.h"
 VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 
@@ -5,17 +7,55 @@ VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE
 #include "core/Logger.h"
 #include "core/MlokUtils.h"
 #include "core/Asserts.h"
+#include "core/FrameStats.h"
+#include "core/Profiler.h"
+#include "renderer/RenderStats.h"
 
 #include "VulkanUtils.h"
 
 #include <memory>
+#include <mutex>
 
 VKAPI_ATTR VkBool32 VKAPI_CALL VkDebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT MessageSeverity,
                                                VkDebugUtilsMessageSeverityFlagsEXT MessageTypes,
                                                const VkDebugUtilsMessengerCallbackDataEXT* CallbackData,
                                                void* UserData);
 
-bool VulkanBackend::Initialize(const std::string& AppName, const uint32_t FramebufferWidth, const uint32_t FramebufferHeight)
+// Offsets from the backend itself, every object starts on its own cache line
+typedef struct VulkanBackendLayout
+{
+    size_t Device;
+    size_t Swapchain;
+    size_t MainRenderPass;
+    size_t ObjectShader;
+    size_t Total;
+} VulkanBackendLayout;
+
+static VulkanBackendLayout GetBackendLayout()
+{
+    VulkanBackendLayout Layout;
+
+    size_t Offset = AlignUp(sizeof(VulkanBackend), MLOK_CACHE_LINE_SIZE);
+    Layout.Device = Offset;
+    Offset += AlignUp(sizeof(VulkanDevice), MLOK_CACHE_LINE_SIZE);
+    Layout.Swapchain = Offset;
+    Offset += AlignUp(sizeof(VulkanSwapchain), MLOK_CACHE_LINE_SIZE);
+    Layout.MainRenderPass = Offset;
+    Offset += AlignUp(sizeof(VulkanRenderPass), MLOK_CACHE_LINE_SIZE);
+    Layout.ObjectShader = Offset;
+    Offset += AlignUp(sizeof(VulkanObjectShader), MLOK_CACHE_LINE_SIZE);
+    Layout.Total = Offset;
+
+    return Layout;
+}
+
+size_t VulkanBackend::GetMemoryRequirement()
+{
+    return GetBackendLayout().Total;
+}
+
+void VulkanBackend::AddInitializeSteps(StartupGraph& Graph, StartupStepId WindowStep,
+                                       const std::string& AppName, const uint32_t FramebufferWidth, const uint32_t FramebufferHeight)
 {
     Context.Allocator = nullptr;
 
@@ -24,6 +64,55 @@ bool VulkanBackend::Initialize(const std::string& AppName, const uint32_t Frameb
     CachedFramebufferWidth  = 0;
     CachedFramebufferHeight = 0;
 
+    Context.ObjectShader.reset(new (reinterpret_cast<uint8_t*>(this) + GetBackendLayout().ObjectShader) VulkanObjectShader());
+
+    // SPIR-V reads only need the disk and run on the I/O thread right away, instance creation doesn't need
+    // the window, both overlap window creation
+    ShaderCodeTask = Context.ObjectShader->LoadStageCodeAsync();
+    const StartupStepId InstanceStep = Graph.AddStep("Vulkan instance", [this, AppName]() { return InitializeInstance(AppName); });
+
+    const StartupStepId SurfaceStep = Graph.AddStep("Vulkan surface", [this]() { return CreateSurface(); }, { InstanceStep, WindowStep });
+    const StartupStepId DeviceStep = Graph.AddStep("Vulkan device", [this]() { return CreateDevice(); }, { SurfaceStep });
+    const StartupStepId SwapchainStep = Graph.AddStep("Vulkan swapchain", [this]() { return CreateSwapchain(); }, { DeviceStep });
+
+    const StartupStepId RenderPassStep = Graph.AddStep("Vulkan render pass", [this]()
+    {
+        if (!CreateMainRenderPass())
+        {
+            return false;
+        }
+
+        Context.pSwapchain->RegenerateFramebuffers(Context.pMainRenderPass.get());
+        return true;
+    }, { SwapchainStep });
+
+    // Pipeline compilation is the slowest part, command buffers and sync objects are created next to it
+    const StartupStepId CommandBuffersStep = Graph.AddStep("Vulkan command buffers", [this]()
+    {
+        CreateCommandBuffers();
+        CreateSyncObjects();
+        return true;
+    }, { SwapchainStep });
+
+    const StartupStepId ObjectShaderStep = Graph.AddStep("Vulkan object shader", [this]()
+    {
+        if (!ShaderCodeTask.Get())
+        {
+            MlokFatal("Failed to read the Vulkan Object Shader code");
+            return false;
+        }
+        return CreateObjectShader();
+    }, { RenderPassStep });
+
+    // Submits to the graphics queue, so it waits for the steps that may upload
+    Graph.AddStep("Vulkan GPU timestamps", [this]()
+    {
+        return Context.GpuProfiler.Create(&Context, Context.pSwapchain->GetMaxFramesInFlight());
+    }, { CommandBuffersStep, ObjectShaderStep });
+}
+
+bool VulkanBackend::InitializeInstance(const std::string& AppName)
+{
     auto vkGetInstanceProcAddr = dl.getProcAddress<PFN_vkGetInstanceProcAddr>("vkGetInstanceProcAddr");
     VULKAN_HPP_DEFAULT_DISPATCHER.init(vkGetInstanceProcAddr);
 
@@ -31,7 +120,7 @@ bool VulkanBackend::Initialize(const std::string& AppName, const uint32_t Frameb
 
     std::vector<const char*> RequiredExtensions;
     RequiredExtensions.push_back("VK_KHR_surface");
-    Platform::Get()->GetRequiredExtensionNames(RequiredExtensions);
+    Platform::GetRequiredExtensionNames(RequiredExtensions);
 
 #ifndef NDEBUG
     RequiredExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -87,82 +176,88 @@ bool VulkanBackend::Initialize(const std::string& AppName, const uint32_t Frameb
     }
 #endif
 
-    if (!CreateSurface())
-    {
-        return false;
-    }
+    return true;
+}
 
-    if (!CreateDevice())
+void VulkanBackend::Shutdown()
+{
+    // A startup that failed before the object shader step leaves the reads running, they write into the stages
+    if (ShaderCodeTask.IsValid())
     {
-         return false;
+        ShaderCodeTask.Get();
     }
 
-    if (!CreateSwapchain())
+    // Also null when startup failed before the device step
+    if (Context.pDevice)
     {
-        return false;
+        Context.pDevice->LogicalDevice.waitIdle();
     }
 
-    if (!CreateMainRenderPass())
+    Context.GpuProfiler.Destroy();
+
+    // Every object below may be missing when a startup step failed, Application::Create shuts down anyway
+    if (Context.pDevice)
     {
-        return false;
-    }
+        MlokInfo("Destroying Vulkan Object Shader...");
+        Context.ObjectShader->Destroy();
+
+        MlokInfo("Destroying Vulkan Sync Objects...");
+        auto DestroySemaphore = [&](vk::Semaphore& SemaphoreToDestroy) {
+            if (SemaphoreToDestroy) Context.pDevice->LogicalDevice.destroySemaphore(SemaphoreToDestroy, Context.Allocator);
+        };
+        std::for_each(Context.ImageAvailableSemaphores.begin(),
+                      Context.ImageAvailableSemaphores.end(),
+                      DestroySemaphore);
+        Context.ImageAvailableSemaphores.clear();
+        std::for_each(Context.QueueCompleteSemaphores.begin(),
+                      Context.QueueCompleteSemaphores.end(),
+                      DestroySemaphore);
+        Context.QueueCompleteSemaphores.clear();
+        Context.InFlightFences.clear();
+        Context.ImagesInFlight.clear();
+
+        MlokInfo("Freeing Vulkan CommandBuffers...");
+        Context.GraphicsCommandBuffers.clear();
+
+        if (Context.pSwapchain)
+        {
+            MlokInfo("Destroying Vulkan Framebuffers...");
+            Context.pSwapchain->DestroyFramebuffers();
+        }
 
-    Context.pSwapchain->RegenerateFramebuffers(Context.pMainRenderPass.get());
+        if (Context.pMainRenderPass)
+        {
+            MlokInfo("Destroying Main Render Pass...");
+            Context.pMainRenderPass->Destroy();
+        }
 
-    CreateCommandBuffers();
+        if (Context.pSwapchain)
+        {
+            MlokInfo("Destroying Vulkan Swapchain...");
+            Context.pSwapchain->Destroy();
+        }
 
-    CreateSyncObjects();
+        MlokInfo("Destroying Vulkan Device...");
+        Context.pDevice->Destroy();
+    }
 
-    if (!CreateObjectShader())
+    if (!Context.pInstance)
     {
-        return false;
+        return;
     }
 
-    return true;
-}
-
-void VulkanBackend::Shutdown()
-{
-    Context.pDevice->LogicalDevice.waitIdle();
-
-    MlokInfo("Destroying Vulkan Object Shader...");
-    Context.ObjectShader->Destroy();
-
-    MlokInfo("Destroying Vulkan Sync Objects...");
-    auto DestroySemaphore = [&](vk::Semaphore& SemaphoreToDestroy) {
-        if (SemaphoreToDestroy) Context.pDevice->LogicalDevice.destroySemaphore(SemaphoreToDestroy, Context.Allocator);
-    };    
-    std::for_each(Context.ImageAvailableSemaphores.begin(),
-                  Context.ImageAvailableSemaphores.end(),
-                  DestroySemaphore);
-    Context.ImageAvailableSemaphores.clear();    
-    std::for_each(Context.QueueCompleteSemaphores.begin(),
-                  Context.QueueCompleteSemaphores.end(),
-                  DestroySemaphore);
-    Context.QueueCompleteSemaphores.clear();
-    Context.InFlightFences.clear();
-    Context.ImagesInFlight.clear();
-
-    MlokInfo("Freeing Vulkan CommandBuffers...");
-    Context.GraphicsCommandBuffers.clear();
-
-    MlokInfo("Destroying Vulkan Framebuffers...");
-    Context.pSwapchain->DestroyFramebuffers();
-
-    MlokInfo("Destroying Main Render Pass...");
-    Context.pMainRenderPass->Destroy();
-
-    MlokInfo("Destroying Vulkan Swapchain...");
-    Context.pSwapchain->Destroy();
-
-    MlokInfo("Destroying Vulkan Device...");
-    Context.pDevice->Destroy();
-
-    MlokInfo("Destroying Vulkan Surface...");
-    Context.pInstance->destroySurfaceKHR(Context.Surface, Context.Allocator);
+    if (Context.Surface)
+    {
+        MlokInfo("Destroying Vulkan Surface...");
+        Context.pInstance->destroySurfaceKHR(Context.Surface, Context.Allocator);
+    }
 
 #ifndef NDEBUG
     MlokInfo("Destroying Vulkan Debugger...");
+    if (Platform* CurrentPlatform = Platform::Get())
+    {
+        Context.DebugFilter.Tick(CurrentPlatform->GetAbsoluteTime(), true);
+    }
     if (Context.DebugMessenger)
     {
         Context.pInstance->destroyDebugUtilsMessengerEXT(Context.DebugMessenger, Context.Allocator);
@@ -184,6 +279,8 @@ void VulkanBackend::OnResized(uint16_t NewWidth, uint16_t NewHeight)
 
 bool VulkanBackend::BeginFrame(float DeltaTime)
 {
+    MLOK_PROFILE_SCOPE("VulkanBackend::BeginFrame");
+
     if (Context.bRecreatingSwapchain)
     {
         vk::Result Result = Context.pDevice->LogicalDevice.waitIdle();
@@ -197,6 +294,10 @@ bool VulkanBackend::BeginFrame(float DeltaTime)
         return false;
     }
 
+#ifndef NDEBUG
+    Context.DebugFilter.Tick(Platform::Get()->GetAbsoluteTime());
+#endif
+
     if (Context.FramebufferSizeGeneration != Context.FramebufferSizeLastGeneration)
     {
         vk::Result Result = Context.pDevice->LogicalDevice.waitIdle();
@@ -215,16 +316,29 @@ bool VulkanBackend::BeginFrame(float DeltaTime)
         return false;
     }
 
-    if (!Context.InFlightFences[Context.CurrentFrame].Wait(UINT64_MAX))
+    const uint64_t WaitStart = Platform::Get()->GetAbsoluteTimeNs();
+
     {
-        MlokWarning("In flight fence wait failure");
-        return false;
+        MLOK_PROFILE_SCOPE("Wait for frame fence");
+        if (!Context.InFlightFences[Context.CurrentFrame].Wait(UINT64_MAX))
+        {
+            MlokWarning("In flight fence wait failure");
+            return false;
+        }
     }
 
-    if (!Context.pSwapchain->AcquireNextImageIndex(UINT64_MAX, 
-                                                  Context.ImageAvailableSemaphores[Context.CurrentFrame], 
-                                                  VK_NULL_HANDLE, 
-                                                  &Context.ImageIndex))
+    bool bAcquired = false;
+    {
+        MLOK_PROFILE_SCOPE("Acquire swapchain image");
+        bAcquired = Context.pSwapchain->AcquireNextImageIndex(UINT64_MAX, 
+                                                              Context.ImageAvailableSemaphores[Context.CurrentFrame], 
+                                                              VK_NULL_HANDLE, 
+                                                              &Context.ImageIndex);
+    }
+
+    FrameStats::Get()->AddRenderBlockedTime(Platform::Get()->GetAbsoluteTimeNs() - WaitStart);
+
+    if (!bAcquired)
     {
         return false;
     }
@@ -233,6 +347,8 @@ bool VulkanBackend::BeginFrame(float DeltaTime)
     CommandBuffer.Reset();
     CommandBuffer.Begin(false, false, false);
 
+    Context.GpuProfiler.BeginFrame(&CommandBuffer, Context.CurrentFrame);
+
     vk::Viewport Viewport {};
     Viewport.setX(0.f)
             .setY(static_cast<float>(Context.FramebufferHeight))
@@ -251,6 +367,7 @@ bool VulkanBackend::BeginFrame(float DeltaTime)
     Context.pMainRenderPass->SetWidth(Context.FramebufferWidth);
     Context.pMainRenderPass->SetHeight(Context.FramebufferHeight);
 
+    CommandBuffer.BeginZone("Main render pass");
     Context.pMainRenderPass->Begin(&CommandBuffer, *Context.pSwapchain->GetFramebuffer(Context.ImageIndex).Get());
 
     return true;
@@ -258,15 +375,23 @@ bool VulkanBackend::BeginFrame(float DeltaTime)
 
 bool VulkanBackend::EndFrame(float DeltaTime)
 {
+    MLOK_PROFILE_SCOPE("VulkanBackend::EndFrame");
+
     auto& CommandBuffer = Context.GraphicsCommandBuffers[Context.ImageIndex];
 
     Context.pMainRenderPass->End(&CommandBuffer);
+    CommandBuffer.EndZone();
+
+    Context.GpuProfiler.EndFrame(&CommandBuffer);
 
     CommandBuffer.End();
 
     if (Context.ImagesInFlight[Context.ImageIndex])
     {
+        MLOK_PROFILE_SCOPE("Wait for image fence");
+        const uint64_t WaitStart = Platform::Get()->GetAbsoluteTimeNs();
         Context.ImagesInFlight[Context.ImageIndex]->Wait(UINT64_MAX);
+        FrameStats::Get()->AddRenderBlockedTime(Platform::Get()->GetAbsoluteTimeNs() - WaitStart);
     }
 
     Context.ImagesInFlight[Context.ImageIndex] = &Context.InFlightFences[Context.CurrentFrame];
@@ -284,19 +409,30 @@ bool VulkanBackend::EndFrame(float DeltaTime)
               .setPWaitSemaphores(&Context.ImageAvailableSemaphores[Context.CurrentFrame])
               .setWaitDstStageMask(PipelineStageFlags);
 
-    vk::Result SubmitResult = Context.pDevice->GetGraphicsQueue().submit(1, &SubmitInfo, *Context.InFlightFences[Context.CurrentFrame].Get());
+    vk::Result SubmitResult = vk::Result::eSuccess;
+    {
+        MLOK_PROFILE_SCOPE("Queue submit");
+        SubmitResult = Context.pDevice->GetGraphicsQueue().submit(1, &SubmitInfo, *Context.InFlightFences[Context.CurrentFrame].Get());
+    }
     if (SubmitResult != vk::Result::eSuccess)
     {
         MlokError("Failed to submit Graphics Queue: %s", VulkanUtils::VulkanResultString(SubmitResult, true).c_str());
         return false;
     }
+    RenderStats::Get()->Add(RenderCounter::RENDER_COUNTER_SUBMITS);
 
     CommandBuffer.UpdateSubmitted();
 
-    Context.pSwapchain->Present(Context.pDevice->GetGraphicsQueue(),
-                                Context.pDevice->GetPresentQueue(),
-                                Context.QueueCompleteSemaphores[Context.CurrentFrame],
-                                Context.ImageIndex);
+    // Present blocks in FIFO mode when the swapchain is full
+    {
+        MLOK_PROFILE_SCOPE("Present");
+        const uint64_t PresentStart = Platform::Get()->GetAbsoluteTimeNs();
+        Context.pSwapchain->Present(Context.pDevice->GetGraphicsQueue(),
+                                    Context.pDevice->GetPresentQueue(),
+                                    Context.QueueCompleteSemaphores[Context.CurrentFrame],
+                                    Context.ImageIndex);
+        FrameStats::Get()->AddRenderBlockedTime(Platform::Get()->GetAbsoluteTimeNs() - PresentStart);
+    }
 
     FrameCount++;
 
@@ -333,13 +469,24 @@ bool VulkanBackend::CreateDebugger()
 
     uint32_t MessageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT |
                                VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT; 
-                               // | VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT
-                               // | VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT;
+
+    // Info and verbose layer output only when the Vulkan log category asks for it
+    if (Logger::IsEnabled(LogCategory::LOG_CATEGORY_VULKAN, LogLevel::LOG_LEVEL_INFO))
+    {
+        MessageSeverity |= VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT;
+    }
+    if (Logger::IsEnabled(LogCategory::LOG_CATEGORY_VULKAN, LogLevel::LOG_LEVEL_VERBOSE))
+    {
+        MessageSeverity |= VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT;
+    }
+
+    Context.DebugFilter.Initialize(VulkanDebugFilterConfig());
                                
     vk::DebugUtilsMessengerCreateInfoEXT DebugCreateInfo {};
     DebugCreateInfo.setMessageSeverity(vk::DebugUtilsMessageSeverityFlagsEXT(MessageSeverity))
                    .setMessageType(vk::DebugUtilsMessageTypeFlagBitsEXT::eGeneral | vk::DebugUtilsMessageTypeFlagBitsEXT::ePerformance | vk::DebugUtilsMessageTypeFlagBitsEXT::eValidation)
-                   .setPfnUserCallback(VkDebugCallback);
+                   .setPfnUserCallback(VkDebugCallback)
+                   .setPUserData(&Context.DebugFilter);
     
     const auto& CreateResult = Context.pInstance->createDebugUtilsMessengerEXT(DebugCreateInfo, Context.Allocator);
     
@@ -371,7 +518,7 @@ bool VulkanBackend::CreateSurface()
 bool VulkanBackend::CreateDevice()
 {
     MlokInfo("Creating Vulkan Device...");
-    Context.pDevice = std::make_unique<VulkanDevice>(&Context);  
+    Context.pDevice.reset(new (reinterpret_cast<uint8_t*>(this) + GetBackendLayout().Device) VulkanDevice(&Context));  
     if (Context.pDevice->LogicalDevice)
     {  
         VULKAN_HPP_DEFAULT_DISPATCHER.init(Context.pDevice->LogicalDevice);
@@ -384,7 +531,7 @@ bool VulkanBackend::CreateDevice()
 bool VulkanBackend::CreateSwapchain()
 {
     MlokInfo("Creating Vulkan Swapchain...");
-    Context.pSwapchain = std::make_unique<VulkanSwapchain>(&Context, Context.FramebufferWidth, Context.FramebufferHeight);
+    Context.pSwapchain.reset(new (reinterpret_cast<uint8_t*>(this) + GetBackendLayout().Swapchain) VulkanSwapchain(&Context, Context.FramebufferWidth, Context.FramebufferHeight));
     MlokInfo("Vulkan Swapchain created.");
 
     return true;
@@ -393,10 +540,10 @@ bool VulkanBackend::CreateSwapchain()
 bool VulkanBackend::CreateMainRenderPass()
 {
     MlokInfo("Creating Main Render Pass...");
-    Context.pMainRenderPass = std::make_unique<VulkanRenderPass>(&Context,
-                                                                 0.f, 0.f, Context.FramebufferWidth, Context.FramebufferHeight,
-                                                                 0.1f, 0.1f, 0.25f, 1.f,
-                                                                 1.f, 0);
+    Context.pMainRenderPass.reset(new (reinterpret_cast<uint8_t*>(this) + GetBackendLayout().MainRenderPass) VulkanRenderPass(&Context,
+                                                                                                                            0.f, 0.f, Context.FramebufferWidth, Context.FramebufferHeight,
+                                                                                                                            0.1f, 0.1f, 0.25f, 1.f,
+                                                                                                                            1.f, 0));
     MlokInfo("Main Render Pass created.");
 
     return true;
@@ -443,7 +590,11 @@ void VulkanBackend::CreateSyncObjects()
 bool VulkanBackend::CreateObjectShader()
 {
     MlokInfo("Creating Vulkan Object Shader...");
-    Context.ObjectShader = std::make_unique<VulkanObjectShader>(&Context);
+    if (!Context.ObjectShader->Create(&Context))
+    {
+        MlokFatal("Failed to create Vulkan Object Shader");
+        return false;
+    }
     MlokInfo("Vulkan Object Shader created.");
 
     return true;
@@ -506,20 +657,33 @@ VKAPI_ATTR VkBool32 VKAPI_CALL VkDebugCallback(VkDebugUtilsMessageSeverityFlagBi
                                                const VkDebugUtilsMessengerCallbackDataEXT* CallbackData,
                                                void* UserData)
 {
+    VulkanDebugFilter* Filter = static_cast<VulkanDebugFilter*>(UserData);
+    if (Filter)
+    {
+        // Startup steps and the render thread can report at the same time, and the window may not exist yet
+        static std::mutex FilterMutex;
+        std::lock_guard<std::mutex> Lock(FilterMutex);
+
+        if (!Filter->Filter(CallbackData, Platform::Get() ? Platform::Get()->GetAbsoluteTime() : 0.0))
+        {
+            return VK_FALSE;
+        }
+    }
+
     switch (MessageSeverity)
     {
         default:
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
-            MlokError(CallbackData->pMessage);
+            MlokError("%s", CallbackData->pMessage);
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
-            MlokWarning(CallbackData->pMessage);
+            MlokWarning("%s", CallbackData->pMessage);
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
-            MlokInfo(CallbackData->pMessage);
+            MlokInfo("%s", CallbackData->pMessage);
             break;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
-            MlokVerbose(CallbackData->pMessage);
+            MlokVerbose("%s", CallbackData->pMessage);
             break;
     }
     
@@ -5,10 +5,17 @@
 #include "VulkanContext.h"
 #include "math/MathTypes.h"
 
+#include "core/Task.h"
+
+// Must be placed at the start of a GetMemoryRequirement sized block, the objects it keeps
+// for its whole lifetime are constructed right behind it
 class VulkanBackend : public RendererBackend
 {
     public:
-        virtual bool Initialize(const std::string& AppName, const uint32_t FramebufferWidth, const uint32_t FramebufferHeight) override;
+        static size_t GetMemoryRequirement();
+
+        virtual void AddInitializeSteps(StartupGraph& Graph, StartupStepId WindowStep,
+                                        const std::string& AppName, const uint32_t FramebufferWidth, const uint32_t FramebufferHeight) override;
         virtual void Shutdown() override;
 
         virtual void OnResized(uint16_t NewWidth, uint16_t NewHeight) override;
@@ -23,10 +30,14 @@ class VulkanBackend : public RendererBackend
         uint32_t CachedFramebufferWidth { 0 };
         uint32_t CachedFramebufferHeight { 0 };
 
+        // SPIR-V reads started with the startup steps, overlapping window and device creation
+        Task<bool> ShaderCodeTask;
+
         // Dynamic loader for ext calls
         vk::DynamicLoader dl;
 
     private:
+        bool InitializeInstance(const std::string& AppName);
         bool CreateInstance(const vk::InstanceCreateInfo& CreateInfo);
         bool CreateDebugger();
         bool CreateSurface();
@@ -1,3 +1,5 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_VULKAN
+
 #include "VulkanBuffer.h"
 
 #include "VulkanContext.h"
@@ -6,6 +8,7 @@
 
 #include "core/Logger.h"
 #include "platform/Platform.h"
+#include "renderer/RenderStats.h"
 
 VulkanBuffer::VulkanBuffer()
 {
@@ -230,6 +233,8 @@ void VulkanBuffer::LoadData(size_t Offset, size_t Size, vk::MemoryMapFlags Flags
     Platform::Get()->PlatformCopyMemory(pData, Data, Size); // TODO: create some static wrapper in MemorySystem
     
     Context->pDevice->LogicalDevice.unmapMemory(Memory);
+
+    RenderStats::Get()->Add(RenderCounter::RENDER_COUNTER_UPLOAD_BYTES, Size);
 }
 
 void VulkanBuffer::Copy(VulkanContext* Context,
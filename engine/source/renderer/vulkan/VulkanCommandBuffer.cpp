@@ -3,6 +3,7 @@
 #include "VulkanContext.h"
 
 #include "core/Asserts.h"
+#include "renderer/RenderStats.h"
 
 VulkanCommandBuffer::VulkanCommandBuffer(VulkanContext* inContext,
                                          vk::CommandPool CommandPool,
@@ -116,12 +117,57 @@ void VulkanCommandBuffer::UpdateInRenderPass()
 void VulkanCommandBuffer::Reset()
 {
     State = VulkanCommandBufferState::eReady;
+    ZoneDepth = 0;
+}
+
+void VulkanCommandBuffer::Draw(uint32_t VertexCount, uint32_t InstanceCount, uint32_t FirstVertex, uint32_t FirstInstance)
+{
+    Handle.draw(VertexCount, InstanceCount, FirstVertex, FirstInstance);
+    RenderStats::Get()->Add(RenderCounter::RENDER_COUNTER_DRAW_CALLS);
+    RenderStats::Get()->Add(RenderCounter::RENDER_COUNTER_TRIANGLES, static_cast<uint64_t>(VertexCount / 3) * InstanceCount);
+}
+
+void VulkanCommandBuffer::DrawIndexed(uint32_t IndexCount, uint32_t InstanceCount, uint32_t FirstIndex,
+                                      int32_t VertexOffset, uint32_t FirstInstance)
+{
+    Handle.drawIndexed(IndexCount, InstanceCount, FirstIndex, VertexOffset, FirstInstance);
+    RenderStats::Get()->Add(RenderCounter::RENDER_COUNTER_DRAW_CALLS);
+    RenderStats::Get()->Add(RenderCounter::RENDER_COUNTER_TRIANGLES, static_cast<uint64_t>(IndexCount / 3) * InstanceCount);
+}
+
+void VulkanCommandBuffer::BeginZone(const char* Name)
+{
+    const uint32_t Zone = Context->GpuProfiler.BeginZone(this, Name);
+    if (ZoneDepth < VULKAN_COMMAND_BUFFER_MAX_ZONE_DEPTH)
+    {
+        ZoneStack[ZoneDepth] = Zone;
+    }
+    else
+    {
+        // Too deep to remember, the zone is left open and its frame gets skipped on read back
+        M_ASSERT_MSG(false, "GPU zones nested too deep");
+    }
+    ++ZoneDepth;
+}
+
+void VulkanCommandBuffer::EndZone()
+{
+    if (ZoneDepth == 0)
+    {
+        return;
+    }
+
+    --ZoneDepth;
+    if (ZoneDepth < VULKAN_COMMAND_BUFFER_MAX_ZONE_DEPTH)
+    {
+        Context->GpuProfiler.EndZone(this, ZoneStack[ZoneDepth]);
+    }
 }
 
 void VulkanCommandBuffer::AllocateAndBeginSingleUse(VulkanContext* inContext, vk::CommandPool CommandPool)
 {
     const bool bIsPrimary = true; // Always primary when is single use
-    Allocate(Context, CommandPool, bIsPrimary);
+    Allocate(inContext, CommandPool, bIsPrimary);
     Begin(true, false, false);
 }
 
@@ -134,6 +180,7 @@ void VulkanCommandBuffer::EndSingleUse(vk::CommandPool CommandPool, vk::Queue Qu
               .setPCommandBuffers(&Handle);
 
     Queue.submit({ SubmitInfo });
+    RenderStats::Get()->Add(RenderCounter::RENDER_COUNTER_SUBMITS);
     Queue.waitIdle();
     
     Free();
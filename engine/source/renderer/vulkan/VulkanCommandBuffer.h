@@ -2,6 +2,8 @@
 
 #include "VulkanTypes.inl"
 
+#define VULKAN_COMMAND_BUFFER_MAX_ZONE_DEPTH 8
+
 class VulkanContext;
 
 enum class VulkanCommandBufferState
@@ -47,10 +49,22 @@ class VulkanCommandBuffer
         void AllocateAndBeginSingleUse(VulkanContext* Context, vk::CommandPool CommandPool);
         void EndSingleUse(vk::CommandPool CommandPool, vk::Queue Queue);
 
+        // Record the draw and count it in RenderStats
+        void Draw(uint32_t VertexCount, uint32_t InstanceCount = 1, uint32_t FirstVertex = 0, uint32_t FirstInstance = 0);
+        void DrawIndexed(uint32_t IndexCount, uint32_t InstanceCount = 1, uint32_t FirstIndex = 0,
+                         int32_t VertexOffset = 0, uint32_t FirstInstance = 0);
+
+        // Named GPU timestamp zone around the commands recorded in between, see VulkanGpuProfiler. Zones nest.
+        void BeginZone(const char* Name);
+        void EndZone();
+
     private:
         VulkanContext* Context; // Cached pointer to backend context
         vk::CommandPool OwningCommandPool;
 
         vk::CommandBuffer Handle;
         VulkanCommandBufferState State;
+
+        uint32_t ZoneStack[VULKAN_COMMAND_BUFFER_MAX_ZONE_DEPTH];
+        uint32_t ZoneDepth = 0;
 };
\ No newline at end of file
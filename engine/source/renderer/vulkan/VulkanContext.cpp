@@ -1,3 +1,5 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_VULKAN
+
 #include "VulkanContext.h"
 
 #include "core/Logger.h"
@@ -7,8 +7,12 @@
 #include "VulkanRenderPass.h"
 #include "VulkanCommandBuffer.h"
 #include "VulkanFence.h"
+#include "VulkanDebugFilter.h"
+#include "VulkanGpuProfiler.h"
 #include "shaders/VulkanObjectShader.h"
 
+#include "core/MlokMemory.h"
+
 #include <memory>
 
 class VulkanContext
@@ -19,11 +23,13 @@ class VulkanContext
         vk::SurfaceKHR Surface;
 #ifndef NDEBUG
         vk::DebugUtilsMessengerEXT DebugMessenger;
+        VulkanDebugFilter DebugFilter;
 #endif
         
-        std::unique_ptr<VulkanDevice> pDevice;
-        std::unique_ptr<VulkanSwapchain> pSwapchain;
-        std::unique_ptr<VulkanRenderPass> pMainRenderPass;
+        // Placed right behind the backend in the Renderer's memory
+        PlacementPtr<VulkanDevice> pDevice;
+        PlacementPtr<VulkanSwapchain> pSwapchain;
+        PlacementPtr<VulkanRenderPass> pMainRenderPass;
 
         std::vector<VulkanCommandBuffer> GraphicsCommandBuffers;
 
@@ -33,7 +39,9 @@ class VulkanContext
         std::vector<VulkanFence> InFlightFences;
         std::vector<VulkanFence*> ImagesInFlight;
 
-        std::unique_ptr<VulkanObjectShader> ObjectShader;
+        PlacementPtr<VulkanObjectShader> ObjectShader;
+
+        VulkanGpuProfiler GpuProfiler;
 
         uint32_t FramebufferWidth;
         uint32_t FramebufferHeight;
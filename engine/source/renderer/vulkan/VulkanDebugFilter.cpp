@@ -0,0 +1,190 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_VULKAN
+
+#include "VulkanDebugFilter.h"
+
+#include "core/Logger.h"
+
+#include <cctype>
+#include <cstring>
+
+MINLINE uint64_t HashMessageId(const char* Str)
+{
+    // FNV-1a
+    uint64_t Hash = 14695981039346656037ull;
+    while (Str && *Str)
+    {
+        Hash ^= static_cast<uint8_t>(*Str++);
+        Hash *= 1099511628211ull;
+    }
+    return Hash;
+}
+
+// FNV-1a of the text with numbers left out, so the same message about different objects (handles, addresses,
+// indices) hashes the same
+MINLINE uint64_t HashMessageText(const char* Str)
+{
+    uint64_t Hash = 14695981039346656037ull;
+    while (Str && *Str)
+    {
+        if (Str[0] == '0' && (Str[1] == 'x' || Str[1] == 'X'))
+        {
+            Str += 2;
+            while (std::isxdigit(static_cast<unsigned char>(*Str)))
+            {
+                ++Str;
+            }
+            continue;
+        }
+
+        if (std::isdigit(static_cast<unsigned char>(*Str)))
+        {
+            ++Str;
+            continue;
+        }
+
+        Hash ^= static_cast<uint8_t>(*Str++);
+        Hash *= 1099511628211ull;
+    }
+    return Hash;
+}
+
+void VulkanDebugFilter::Initialize(const VulkanDebugFilterConfig& inConfig)
+{
+    Config = inConfig;
+
+    std::memset(Entries, 0, sizeof(Entries));
+    EntryCount = 0;
+
+    SecondStart = 0.0;
+    PrintedThisSecond = 0;
+
+    IntervalStart = 0.0;
+    IntervalSuppressed = 0;
+    IntervalRateLimited = 0;
+}
+
+bool VulkanDebugFilter::Filter(const VkDebugUtilsMessengerCallbackDataEXT* CallbackData, double Now)
+{
+    if (IntervalStart == 0.0)
+    {
+        IntervalStart = Now;
+        SecondStart = Now;
+    }
+
+    Tick(Now);
+
+    // Some layers leave the ID name empty, the key is then the ID number alone. Loader and other non-validation
+    // messages often report 0 as well, those are told apart by their text with the numbers stripped, as it
+    // embeds object handles and addresses. The start of the text is shown as the name.
+    const char* Name = CallbackData->pMessageIdName ? CallbackData->pMessageIdName : CallbackData->pMessage;
+    uint64_t Key = 0;
+    if (CallbackData->pMessageIdName || CallbackData->messageIdNumber != 0)
+    {
+        Key = HashMessageId(CallbackData->pMessageIdName) ^ static_cast<uint32_t>(CallbackData->messageIdNumber);
+    }
+    else
+    {
+        Key = HashMessageText(CallbackData->pMessage);
+    }
+    if (Key == 0)
+    {
+        Key = 1;
+    }
+
+    Entry* MessageEntry = FindOrAdd(Key, Name);
+    if (MessageEntry)
+    {
+        ++MessageEntry->TotalCount;
+        ++MessageEntry->IntervalCount;
+
+        if (Config.MaxRepeatsPerId > 0 && MessageEntry->IntervalCount > Config.MaxRepeatsPerId)
+        {
+            ++MessageEntry->SuppressedCount;
+            ++IntervalSuppressed;
+            return false;
+        }
+    }
+
+    if (Now - SecondStart >= 1.0)
+    {
+        SecondStart = Now;
+        PrintedThisSecond = 0;
+    }
+
+    if (Config.MaxMessagesPerSecond > 0 && PrintedThisSecond >= Config.MaxMessagesPerSecond)
+    {
+        if (MessageEntry)
+        {
+            ++MessageEntry->SuppressedCount;
+        }
+        ++IntervalRateLimited;
+        return false;
+    }
+
+    ++PrintedThisSecond;
+    return true;
+}
+
+void VulkanDebugFilter::Tick(double Now, bool bForce)
+{
+    if (!bForce && Now - IntervalStart < Config.SummaryIntervalSeconds)
+    {
+        return;
+    }
+
+    if (IntervalSuppressed > 0 || IntervalRateLimited > 0)
+    {
+        MlokWarning("Vulkan debug messages suppressed in the last %.1f s: %llu repeated, %llu over the %u/s cap",
+                    Now - IntervalStart, IntervalSuppressed, IntervalRateLimited, Config.MaxMessagesPerSecond);
+
+        for (Entry& MessageEntry : Entries)
+        {
+            if (MessageEntry.Key != 0 && MessageEntry.SuppressedCount > 0)
+            {
+                MlokWarning("    %s: %u suppressed, %llu total", MessageEntry.Name, MessageEntry.SuppressedCount, MessageEntry.TotalCount);
+            }
+        }
+    }
+
+    for (Entry& MessageEntry : Entries)
+    {
+        MessageEntry.IntervalCount = 0;
+        MessageEntry.SuppressedCount = 0;
+    }
+
+    IntervalStart = Now;
+    IntervalSuppressed = 0;
+    IntervalRateLimited = 0;
+}
+
+VulkanDebugFilter::Entry* VulkanDebugFilter::FindOrAdd(uint64_t Key, const char* Name)
+{
+    const uint32_t Mask = VULKAN_DEBUG_FILTER_TABLE_SIZE - 1;
+    uint32_t Slot = static_cast<uint32_t>(Key) & Mask;
+
+    for (uint32_t Probe = 0; Probe < VULKAN_DEBUG_FILTER_TABLE_SIZE; ++Probe, Slot = (Slot + 1) & Mask)
+    {
+        Entry& Candidate = Entries[Slot];
+        if (Candidate.Key == Key)
+        {
+            return &Candidate;
+        }
+
+        if (Candidate.Key == 0)
+        {
+            // Keep the table sparse enough for short probes, the rest is only rate limited
+            if (EntryCount >= VULKAN_DEBUG_FILTER_TABLE_SIZE * 3 / 4)
+            {
+                return nullptr;
+            }
+
+            Candidate.Key = Key;
+            std::strncpy(Candidate.Name, Name ? Name : "Unknown", VULKAN_DEBUG_FILTER_NAME_LENGTH - 1);
+            Candidate.Name[VULKAN_DEBUG_FILTER_NAME_LENGTH - 1] = '\0';
+            ++EntryCount;
+            return &Candidate;
+        }
+    }
+
+    return nullptr;
+}
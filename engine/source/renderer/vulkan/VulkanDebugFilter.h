@@ -0,0 +1,51 @@
+#pragma once
+
+#include "VulkanTypes.inl"
+
+#define VULKAN_DEBUG_FILTER_TABLE_SIZE 256 // Must be a power of two
+#define VULKAN_DEBUG_FILTER_NAME_LENGTH 64
+
+typedef struct VulkanDebugFilterConfig
+{
+    uint32_t MaxMessagesPerSecond = 20;     // Global cap of printed messages, 0 disables the cap
+    uint32_t MaxRepeatsPerId = 3;           // Printed messages with the same ID per summary interval, 0 disables deduplication
+    double SummaryIntervalSeconds = 5.0;    // How often suppressed counters are reported
+} VulkanDebugFilterConfig;
+
+// Deduplicates and rate limits validation layer messages, so a per-frame error doesn't flood the log.
+// Messages are keyed by their message ID, suppressed ones are only counted and reported in a periodic summary.
+class VulkanDebugFilter
+{
+    public:
+        void Initialize(const VulkanDebugFilterConfig& inConfig);
+
+        // Returns true if the message should be printed
+        bool Filter(const VkDebugUtilsMessengerCallbackDataEXT* CallbackData, double Now);
+
+        // Prints the summary when the interval has passed, bForce prints whatever was suppressed so far
+        void Tick(double Now, bool bForce = false);
+
+    private:
+        typedef struct Entry
+        {
+            uint64_t Key;               // 0 marks a free slot
+            uint64_t TotalCount;
+            uint32_t IntervalCount;     // Messages seen during the current summary interval
+            uint32_t SuppressedCount;   // Of them suppressed
+            char Name[VULKAN_DEBUG_FILTER_NAME_LENGTH];    // The ID name, or the start of the message text without one
+        } Entry;
+
+        Entry* FindOrAdd(uint64_t Key, const char* Name);
+
+        VulkanDebugFilterConfig Config;
+
+        Entry Entries[VULKAN_DEBUG_FILTER_TABLE_SIZE];
+        uint32_t EntryCount;
+
+        double SecondStart;
+        uint32_t PrintedThisSecond;
+
+        double IntervalStart;
+        uint64_t IntervalSuppressed;
+        uint64_t IntervalRateLimited;
+};
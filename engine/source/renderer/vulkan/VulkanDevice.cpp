@@ -1,3 +1,5 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_VULKAN
+
 #include "VulkanDevice.h"
 
 #include "core/Logger.h"
@@ -116,6 +118,7 @@ void VulkanDevice::Destroy()
     if (GraphicsCommandPool)
     {
         LogicalDevice.destroyCommandPool(GraphicsCommandPool, Context->Allocator);
+        GraphicsCommandPool = nullptr;
     }
 
     MlokInfo("Destroying Logical Device...");
@@ -58,6 +58,10 @@ class VulkanDevice
 
         vk::CommandPool& GetGraphicsCommandPool() { return GraphicsCommandPool; }
 
+        const vk::PhysicalDeviceProperties& GetProperties() const { return Properties; }
+        // Every supported feature is enabled on the logical device
+        const vk::PhysicalDeviceFeatures& GetFeatures() const { return Features; }
+
         vk::PhysicalDevice PhysicalDevice;
         vk::Device LogicalDevice;
 
@@ -1,3 +1,5 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_VULKAN
+
 #include "VulkanFence.h"
 
 #include "VulkanContext.h"
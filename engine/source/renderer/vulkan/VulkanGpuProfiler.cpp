@@ -0,0 +1,330 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_VULKAN
+
+#include "VulkanGpuProfiler.h"
+
+#include "VulkanContext.h"
+#include "VulkanCommandBuffer.h"
+#include "VulkanUtils.h"
+
+#include "core/Logger.h"
+#include "core/FrameStats.h"
+#include "core/Profiler.h"
+#include "renderer/RenderStats.h"
+
+#include <algorithm>
+
+// Results come back in the order of the bits
+static const vk::QueryPipelineStatisticFlags PipelineStatisticFlags = vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+                                                                      vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+                                                                      vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+                                                                      vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+                                                                      vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations;
+
+static const RenderCounter PipelineStatisticCounters[VULKAN_GPU_PROFILER_PIPELINE_STATISTICS] = {
+    RenderCounter::RENDER_COUNTER_INPUT_VERTICES,
+    RenderCounter::RENDER_COUNTER_INPUT_PRIMITIVES,
+    RenderCounter::RENDER_COUNTER_VERTEX_INVOCATIONS,
+    RenderCounter::RENDER_COUNTER_CLIPPING_PRIMITIVES,
+    RenderCounter::RENDER_COUNTER_FRAGMENT_INVOCATIONS
+};
+
+bool VulkanGpuProfiler::Create(VulkanContext* inContext, uint32_t FramesInFlight)
+{
+    Context = inContext;
+    bTimestamps = false;
+    bPipelineStatistics = false;
+
+    Frames.assign(FramesInFlight, FrameQueries {});
+    CurrentSlot = 0;
+    FrameZone = VULKAN_GPU_PROFILER_INVALID_ZONE;
+
+    bTimestamps = CreateTimestamps(Context->pDevice->GetProperties(), FramesInFlight);
+    bPipelineStatistics = CreatePipelineStatistics(FramesInFlight);
+
+    RenderStats::Get()->SetPipelineStatisticsAvailable(bPipelineStatistics);
+    return true;
+}
+
+bool VulkanGpuProfiler::CreateTimestamps(const vk::PhysicalDeviceProperties& Properties, uint32_t FramesInFlight)
+{
+    const std::vector<vk::QueueFamilyProperties> QueueFamilies = Context->pDevice->PhysicalDevice.getQueueFamilyProperties();
+    const uint32_t GraphicsFamily = static_cast<uint32_t>(Context->pDevice->GetGraphicsQueueIndex());
+    const uint32_t ValidBits = GraphicsFamily < QueueFamilies.size() ? QueueFamilies[GraphicsFamily].timestampValidBits : 0;
+
+    if (ValidBits == 0 || Properties.limits.timestampPeriod <= 0.f)
+    {
+        MlokWarning("The graphics queue doesn't support timestamps, GPU times won't be measured");
+        return false;
+    }
+
+    NsPerTick = static_cast<double>(Properties.limits.timestampPeriod);
+    TimestampMask = ValidBits >= 64 ? ~0ull : (1ull << ValidBits) - 1;
+
+    vk::QueryPoolCreateInfo PoolInfo {};
+    PoolInfo.setQueryType(vk::QueryType::eTimestamp)
+            .setQueryCount(FramesInFlight * VULKAN_GPU_PROFILER_MAX_QUERIES);
+
+    const auto& PoolResult = Context->pDevice->LogicalDevice.createQueryPool(PoolInfo, Context->Allocator);
+    if (!VulkanUtils::ResultIsSuccess(PoolResult.result))
+    {
+        MlokWarning("Failed to create the timestamp query pool: %s", VulkanUtils::VulkanResultString(PoolResult.result, true).c_str());
+        return false;
+    }
+    QueryPool = PoolResult.value;
+
+    if (!Calibrate())
+    {
+        Context->pDevice->LogicalDevice.destroyQueryPool(QueryPool, Context->Allocator);
+        QueryPool = nullptr;
+        return false;
+    }
+
+    MlokInfo("GPU timestamps: %u valid bits, %.3f ns per tick", ValidBits, NsPerTick);
+    return true;
+}
+
+bool VulkanGpuProfiler::CreatePipelineStatistics(uint32_t FramesInFlight)
+{
+    if (!Context->pDevice->GetFeatures().pipelineStatisticsQuery)
+    {
+        MlokInfo("The device doesn't support pipeline statistics queries, those render counters stay empty");
+        return false;
+    }
+
+    vk::QueryPoolCreateInfo PoolInfo {};
+    PoolInfo.setQueryType(vk::QueryType::ePipelineStatistics)
+            .setQueryCount(FramesInFlight)
+            .setPipelineStatistics(PipelineStatisticFlags);
+
+    const auto& PoolResult = Context->pDevice->LogicalDevice.createQueryPool(PoolInfo, Context->Allocator);
+    if (!VulkanUtils::ResultIsSuccess(PoolResult.result))
+    {
+        MlokWarning("Failed to create the pipeline statistics query pool: %s", VulkanUtils::VulkanResultString(PoolResult.result, true).c_str());
+        return false;
+    }
+    StatisticsPool = PoolResult.value;
+
+    return true;
+}
+
+void VulkanGpuProfiler::Destroy()
+{
+    if (QueryPool)
+    {
+        Context->pDevice->LogicalDevice.destroyQueryPool(QueryPool, Context->Allocator);
+        QueryPool = nullptr;
+    }
+
+    if (StatisticsPool)
+    {
+        Context->pDevice->LogicalDevice.destroyQueryPool(StatisticsPool, Context->Allocator);
+        StatisticsPool = nullptr;
+    }
+
+    Frames.clear();
+    bTimestamps = false;
+    bPipelineStatistics = false;
+}
+
+void VulkanGpuProfiler::BeginFrame(VulkanCommandBuffer* CommandBuffer, uint32_t FrameSlot)
+{
+    if ((!bTimestamps && !bPipelineStatistics) || FrameSlot >= Frames.size())
+    {
+        return;
+    }
+
+    // The slot's fence was waited on, its previous frame is done
+    ReadBack(FrameSlot);
+
+    CurrentSlot = FrameSlot;
+    Frames[FrameSlot].ZoneCount = 0;
+    Frames[FrameSlot].bSubmitted = false;
+    Frames[FrameSlot].bStatisticsQuery = false;
+
+    if (bTimestamps)
+    {
+        CommandBuffer->Get()->resetQueryPool(QueryPool, GetFirstQuery(FrameSlot), VULKAN_GPU_PROFILER_MAX_QUERIES);
+    }
+
+    if (bPipelineStatistics)
+    {
+        // Covers the whole command buffer, render passes included
+        CommandBuffer->Get()->resetQueryPool(StatisticsPool, FrameSlot, 1);
+        CommandBuffer->Get()->beginQuery(StatisticsPool, FrameSlot, vk::QueryControlFlags());
+        Frames[FrameSlot].bStatisticsQuery = true;
+    }
+
+    FrameZone = BeginZone(CommandBuffer, "GPU frame");
+}
+
+void VulkanGpuProfiler::EndFrame(VulkanCommandBuffer* CommandBuffer)
+{
+    if ((!bTimestamps && !bPipelineStatistics) || CurrentSlot >= Frames.size())
+    {
+        return;
+    }
+
+    EndZone(CommandBuffer, FrameZone);
+    FrameZone = VULKAN_GPU_PROFILER_INVALID_ZONE;
+
+    if (Frames[CurrentSlot].bStatisticsQuery)
+    {
+        CommandBuffer->Get()->endQuery(StatisticsPool, CurrentSlot);
+    }
+
+    Frames[CurrentSlot].bSubmitted = true;
+    Frames[CurrentSlot].SubmitNs = Profiler::GetTimeNs();
+}
+
+uint32_t VulkanGpuProfiler::BeginZone(VulkanCommandBuffer* CommandBuffer, const char* Name)
+{
+    if (!bTimestamps)
+    {
+        return VULKAN_GPU_PROFILER_INVALID_ZONE;
+    }
+
+    FrameQueries& Frame = Frames[CurrentSlot];
+    if (Frame.ZoneCount >= VULKAN_GPU_PROFILER_MAX_ZONES)
+    {
+        return VULKAN_GPU_PROFILER_INVALID_ZONE;
+    }
+
+    const uint32_t Zone = Frame.ZoneCount++;
+    Frame.ZoneNames[Zone] = Name;
+    CommandBuffer->Get()->writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, QueryPool, GetFirstQuery(CurrentSlot) + Zone * 2);
+    return Zone;
+}
+
+void VulkanGpuProfiler::EndZone(VulkanCommandBuffer* CommandBuffer, uint32_t Zone)
+{
+    if (!bTimestamps || Zone == VULKAN_GPU_PROFILER_INVALID_ZONE)
+    {
+        return;
+    }
+
+    CommandBuffer->Get()->writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, QueryPool, GetFirstQuery(CurrentSlot) + Zone * 2 + 1);
+}
+
+bool VulkanGpuProfiler::Calibrate()
+{
+    vk::CommandPool Pool = Context->pDevice->GetGraphicsCommandPool();
+    vk::Queue Queue = Context->pDevice->GetGraphicsQueue();
+
+    VulkanCommandBuffer CommandBuffer {};
+    CommandBuffer.AllocateAndBeginSingleUse(Context, Pool);
+    CommandBuffer.Get()->resetQueryPool(QueryPool, 0, 1);
+    CommandBuffer.Get()->writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, QueryPool, 0);
+
+    // The timestamp is written somewhere between the submit and the end of the wait, the middle is off by at
+    // most half of that. VK_EXT_calibrated_timestamps would be exact but isn't available everywhere. This is only
+    // the starting point, ReadBackTimestamps corrects drift afterwards.
+    const uint64_t SubmitNs = Profiler::GetTimeNs();
+    CommandBuffer.EndSingleUse(Pool, Queue);
+    const uint64_t DoneNs = Profiler::GetTimeNs();
+
+    uint64_t Ticks = 0;
+    const vk::Result Result = Context->pDevice->LogicalDevice.getQueryPoolResults(QueryPool, 0, 1, sizeof(Ticks), &Ticks, sizeof(Ticks),
+                                                                                   vk::QueryResultFlagBits::e64 | vk::QueryResultFlagBits::eWait);
+    if (!VulkanUtils::ResultIsSuccess(Result))
+    {
+        MlokWarning("Failed to read the calibration timestamp: %s", VulkanUtils::VulkanResultString(Result, true).c_str());
+        return false;
+    }
+
+    ReferenceTicks = Ticks & TimestampMask;
+    ReferenceNs = SubmitNs + (DoneNs - SubmitNs) / 2;
+    return true;
+}
+
+void VulkanGpuProfiler::ReadBack(uint32_t FrameSlot)
+{
+    FrameQueries& Frame = Frames[FrameSlot];
+    if (!Frame.bSubmitted)
+    {
+        return;
+    }
+    Frame.bSubmitted = false;
+
+    if (Frame.ZoneCount > 0)
+    {
+        ReadBackTimestamps(FrameSlot);
+    }
+
+    if (Frame.bStatisticsQuery)
+    {
+        ReadBackPipelineStatistics(FrameSlot);
+    }
+}
+
+void VulkanGpuProfiler::ReadBackTimestamps(uint32_t FrameSlot)
+{
+    const FrameQueries& Frame = Frames[FrameSlot];
+    const uint64_t ReadBackNs = Profiler::GetTimeNs();
+
+    // No wait flag: a frame that never got submitted reports not ready instead of blocking
+    uint64_t Ticks[VULKAN_GPU_PROFILER_MAX_QUERIES];
+    const uint32_t QueryCount = Frame.ZoneCount * 2;
+    const vk::Result Result = Context->pDevice->LogicalDevice.getQueryPoolResults(QueryPool, GetFirstQuery(FrameSlot), QueryCount,
+                                                                                   QueryCount * sizeof(uint64_t), Ticks, sizeof(uint64_t),
+                                                                                   vk::QueryResultFlagBits::e64);
+    if (Result != vk::Result::eSuccess)
+    {
+        return;
+    }
+
+    // Zone 0 is the frame, it starts first
+    const uint64_t FrameStartTicks = Ticks[0] & TimestampMask;
+    const uint64_t FrameDurationNs = static_cast<uint64_t>(static_cast<double>(((Ticks[1] & TimestampMask) - FrameStartTicks) & TimestampMask) * NsPerTick);
+    uint64_t FrameStartNs = ReferenceNs + static_cast<uint64_t>(static_cast<double>((FrameStartTicks - ReferenceTicks) & TimestampMask) * NsPerTick);
+
+    // Advancing by GPU ticks alone carries the drift between the clocks forward. The frame ran after it was
+    // submitted and finished before its fence let this read back happen, re-anchor when it falls outside that.
+    if (FrameStartNs < Frame.SubmitNs)
+    {
+        FrameStartNs = Frame.SubmitNs;
+    }
+    else if (FrameStartNs + FrameDurationNs > ReadBackNs)
+    {
+        FrameStartNs = ReadBackNs - std::min(FrameDurationNs, ReadBackNs - Frame.SubmitNs);
+    }
+
+    ReferenceTicks = FrameStartTicks;
+    ReferenceNs = FrameStartNs;
+
+    Profiler* CpuProfiler = Profiler::Get();
+    for (uint32_t Zone = 0; Zone < Frame.ZoneCount; ++Zone)
+    {
+        const uint64_t StartTicks = Ticks[Zone * 2] & TimestampMask;
+        const uint64_t EndTicks = Ticks[Zone * 2 + 1] & TimestampMask;
+        const uint64_t DurationNs = static_cast<uint64_t>(static_cast<double>((EndTicks - StartTicks) & TimestampMask) * NsPerTick);
+
+        if (Zone == 0)
+        {
+            FrameStats::Get()->SetGpuFrameTime(DurationNs);
+        }
+
+        if (CpuProfiler)
+        {
+            const uint64_t StartNs = FrameStartNs + static_cast<uint64_t>(static_cast<double>((StartTicks - FrameStartTicks) & TimestampMask) * NsPerTick);
+            CpuProfiler->RecordGpuZone(Frame.ZoneNames[Zone], StartNs, StartNs + DurationNs);
+        }
+    }
+}
+
+void VulkanGpuProfiler::ReadBackPipelineStatistics(uint32_t FrameSlot)
+{
+    // All counters of one query are a single result
+    uint64_t Counts[VULKAN_GPU_PROFILER_PIPELINE_STATISTICS];
+    const vk::Result Result = Context->pDevice->LogicalDevice.getQueryPoolResults(StatisticsPool, FrameSlot, 1, sizeof(Counts), Counts,
+                                                                                   sizeof(Counts), vk::QueryResultFlagBits::e64);
+    if (Result != vk::Result::eSuccess)
+    {
+        return;
+    }
+
+    RenderStats* Stats = RenderStats::Get();
+    for (uint32_t i = 0; i < VULKAN_GPU_PROFILER_PIPELINE_STATISTICS; ++i)
+    {
+        Stats->Add(PipelineStatisticCounters[i], Counts[i]);
+    }
+}
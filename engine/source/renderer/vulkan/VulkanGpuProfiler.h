@@ -0,0 +1,79 @@
+#pragma once
+
+#include "VulkanTypes.inl"
+
+#define VULKAN_GPU_PROFILER_MAX_QUERIES 64  // Timestamps per frame in flight, two per zone
+#define VULKAN_GPU_PROFILER_MAX_ZONES (VULKAN_GPU_PROFILER_MAX_QUERIES / 2)
+#define VULKAN_GPU_PROFILER_INVALID_ZONE 0xFFFFFFFF
+#define VULKAN_GPU_PROFILER_PIPELINE_STATISTICS 5   // Counters in a pipeline statistics query, see Create
+
+class VulkanContext;
+class VulkanCommandBuffer;
+
+// Timestamp queries, a range of the pool per frame in flight. A frame reads back the results its slot got the
+// last time around, after the slot's fence was waited on, so reading never stalls the CPU and times arrive
+// MaxFramesInFlight frames late. Every frame is a "GPU frame" zone, its length goes to FrameStats and all zones
+// go to the CPU profiler's GPU track. Queue families without timestamp support just record nothing.
+// When the device has pipelineStatisticsQuery, every frame also runs one pipeline statistics query read back
+// the same way into the RenderStats counters.
+class VulkanGpuProfiler
+{
+    public:
+        VulkanGpuProfiler() = default;
+        VulkanGpuProfiler(const VulkanGpuProfiler&) = delete;
+        VulkanGpuProfiler& operator=(const VulkanGpuProfiler&) = delete;
+
+        // Needs the graphics queue to itself, it submits once to line GPU ticks up with the CPU clock
+        bool Create(VulkanContext* Context, uint32_t FramesInFlight);
+        void Destroy();
+
+        bool HasTimestamps() const { return bTimestamps; }
+        bool HasPipelineStatistics() const { return bPipelineStatistics; }
+
+        // Right after the command buffer begins, outside any render pass
+        void BeginFrame(VulkanCommandBuffer* CommandBuffer, uint32_t FrameSlot);
+        // Before the command buffer ends
+        void EndFrame(VulkanCommandBuffer* CommandBuffer);
+
+        // Name must outlive the profiler. Returns VULKAN_GPU_PROFILER_INVALID_ZONE once the frame is out of queries.
+        uint32_t BeginZone(VulkanCommandBuffer* CommandBuffer, const char* Name);
+        void EndZone(VulkanCommandBuffer* CommandBuffer, uint32_t Zone);
+
+    private:
+        typedef struct FrameQueries
+        {
+            const char* ZoneNames[VULKAN_GPU_PROFILER_MAX_ZONES];
+            uint32_t ZoneCount;
+            bool bSubmitted;        // Its queries were recorded, there is something to read back
+            bool bStatisticsQuery;  // The pipeline statistics query was begun and ended
+            uint64_t SubmitNs;      // CPU profiler time before the frame was submitted, the GPU can't have started it earlier
+        } FrameQueries;
+
+        bool CreateTimestamps(const vk::PhysicalDeviceProperties& Properties, uint32_t FramesInFlight);
+        bool CreatePipelineStatistics(uint32_t FramesInFlight);
+        bool Calibrate();
+        void ReadBack(uint32_t FrameSlot);
+        void ReadBackTimestamps(uint32_t FrameSlot);
+        void ReadBackPipelineStatistics(uint32_t FrameSlot);
+        uint32_t GetFirstQuery(uint32_t FrameSlot) const { return FrameSlot * VULKAN_GPU_PROFILER_MAX_QUERIES; }
+
+        VulkanContext* Context = nullptr; // Cached pointer to backend context
+
+        vk::QueryPool QueryPool;
+        vk::QueryPool StatisticsPool;   // One query per frame in flight
+        std::vector<FrameQueries> Frames;
+        uint32_t CurrentSlot = 0;
+        uint32_t FrameZone = VULKAN_GPU_PROFILER_INVALID_ZONE;
+
+        double NsPerTick = 0.0;         // VkPhysicalDeviceLimits::timestampPeriod
+        uint64_t TimestampMask = 0;     // From the queue family's timestampValidBits
+
+        // A GPU tick and the CPU profiler time it happened at, moved forward every frame so that timestamps
+        // narrower than 64 bits don't wrap between them. The two clocks drift apart, so every frame is also kept
+        // between its submission and its read back on the CPU clock, which bounds the error by that window
+        uint64_t ReferenceTicks = 0;
+        uint64_t ReferenceNs = 0;
+
+        bool bTimestamps = false;
+        bool bPipelineStatistics = false;
+};
@@ -1,3 +1,5 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_VULKAN
+
 #include "VulkanPipeline.h"
 
 #include "VulkanContext.h"
@@ -6,6 +8,7 @@
 #include "VulkanUtils.h"
 
 #include "core/Logger.h"
+#include "renderer/RenderStats.h"
 
 #include "math/MathTypes.h"
 
@@ -186,5 +189,6 @@ void VulkanPipeline::Bind(VulkanCommandBuffer* CommandBuffer, vk::PipelineBindPo
     if (CommandBuffer && CommandBuffer->Get())
     {
         CommandBuffer->Get()->bindPipeline(BindPoint, Handle);
+        RenderStats::Get()->Add(RenderCounter::RENDER_COUNTER_PIPELINE_BINDS);
     }
 }
\ No newline at end of file
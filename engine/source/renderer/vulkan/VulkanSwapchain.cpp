@@ -1,3 +1,5 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_VULKAN
+
 #include "VulkanSwapchain.h"
 
 #include "VulkanContext.h"
@@ -232,6 +234,12 @@ void VulkanSwapchain::CreateInternal(VulkanContext* inContext, uint32_t Width, u
 
 void VulkanSwapchain::DestroyInternal()
 {
+    // The destructor calls Destroy again
+    if (!Handle)
+    {
+        return;
+    }
+
     Context->pDevice->LogicalDevice.waitIdle();
     
     DepthAttachment->Destroy();
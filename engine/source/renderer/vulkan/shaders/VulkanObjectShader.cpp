@@ -1,3 +1,5 @@
+#define MLOK_LOG_CATEGORY LogCategory::LOG_CATEGORY_VULKAN
+
 #include "VulkanObjectShader.h"
 
 #include "renderer/vulkan/VulkanContext.h"
@@ -9,8 +11,13 @@
 
 #include "platform/FileSystem.h"
 
+#include "renderer/RenderStats.h"
+
 #define BUILTIN_SHADER_NAME_OBJECT "Builtin.ObjectShader"
 
+static const char* ObjectShaderStageTypeStrs[OBJECT_SHADER_STAGE_COUNT] = { "vert", "frag" };
+static const vk::ShaderStageFlagBits ObjectShaderStageTypes[OBJECT_SHADER_STAGE_COUNT] = { vk::ShaderStageFlagBits::eVertex, vk::ShaderStageFlagBits::eFragment };
+
 VulkanShaderStage::VulkanShaderStage(VulkanContext* inContext,
                                      std::string Name,
                                      std::string TypeStr,
@@ -25,16 +32,8 @@ VulkanShaderStage::~VulkanShaderStage()
     Destroy();
 }
 
-bool VulkanShaderStage::Create(VulkanContext* inContext,
-                               std::string Name,
-                               std::string TypeStr,
-                               vk::ShaderStageFlagBits ShaderStageFlag)
+bool VulkanShaderStage::LoadCode(const std::string& Name, const std::string& TypeStr)
 {
-    if (Context != inContext)
-    {
-        Context = inContext;
-    }
-
     std::string Filename = MlokUtils::StringFormat("assets/shaders/%s.%s.spv", Name.c_str(), TypeStr.c_str());
 
     FileHandle File { Filename };
@@ -45,16 +44,34 @@ bool VulkanShaderStage::Create(VulkanContext* inContext,
     }
 
     size_t FileSize = 0;
-    std::vector<char> FileBuffer; // TODO: custom allocator
-    if (!File.ReadAllBytes(FileBuffer, &FileSize))
+    if (!File.ReadAllBytes(Code, &FileSize))
     {
         MlokError("Unable to read shader module: %s", Filename.c_str());
+        Code.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool VulkanShaderStage::Create(VulkanContext* inContext,
+                               std::string Name,
+                               std::string TypeStr,
+                               vk::ShaderStageFlagBits ShaderStageFlag)
+{
+    if (Context != inContext)
+    {
+        Context = inContext;
+    }
+
+    if (Code.empty() && !LoadCode(Name, TypeStr))
+    {
         return false;
     }
 
     CreateInfo = vk::ShaderModuleCreateInfo {};
-    CreateInfo.setCodeSize(FileSize)
-              .setPCode(reinterpret_cast<uint32_t*>(FileBuffer.data()));
+    CreateInfo.setCodeSize(Code.size())
+              .setPCode(reinterpret_cast<uint32_t*>(Code.data()));
 
     const auto& CreateResult = Context->pDevice->LogicalDevice.createShaderModule(CreateInfo, Context->Allocator);
     if (!VulkanUtils::ResultIsSuccess(CreateResult.result))
@@ -65,6 +82,10 @@ bool VulkanShaderStage::Create(VulkanContext* inContext,
 
     Handle = CreateResult.value;
 
+    // The driver keeps its own copy
+    Code.clear();
+    Code.shrink_to_fit();
+
     StageCreateInfo = vk::PipelineShaderStageCreateInfo {};
     StageCreateInfo.setStage(ShaderStageFlag)
                    .setModule(Handle)
@@ -93,6 +114,35 @@ VulkanObjectShader::~VulkanObjectShader()
     Destroy();
 }
 
+Task<bool> VulkanObjectShader::LoadStageCodeAsync()
+{
+    std::vector<Task<bool>> Loads;
+    for (uint32_t i = 0; i < OBJECT_SHADER_STAGE_COUNT; ++i)
+    {
+        VulkanShaderStage* Stage = &Stages[i];
+        const char* TypeStr = ObjectShaderStageTypeStrs[i];
+        Loads.push_back(RunTask(TaskThread::TASK_THREAD_IO, [Stage, TypeStr]()
+        {
+            if (!Stage->LoadCode(BUILTIN_SHADER_NAME_OBJECT, TypeStr))
+            {
+                MlokError("Unable to read %s shader code for '%s'", TypeStr, BUILTIN_SHADER_NAME_OBJECT);
+                return false;
+            }
+            return true;
+        }));
+    }
+
+    return WhenAll(Loads).Then(TaskThread::TASK_THREAD_ANY, [Loads]()
+    {
+        bool bSuccess = true;
+        for (const Task<bool>& Load : Loads)
+        {
+            bSuccess = Load.Get() && bSuccess;
+        }
+        return bSuccess;
+    });
+}
+
 bool VulkanObjectShader::Create(VulkanContext* inContext)
 {
     if (Context != inContext)
@@ -100,14 +150,11 @@ bool VulkanObjectShader::Create(VulkanContext* inContext)
         Context = inContext;
     }
 
-    std::string StageTypeStrs[OBJECT_SHADER_STAGE_COUNT] = { "vert", "frag" };
-    vk::ShaderStageFlagBits StageTypes[OBJECT_SHADER_STAGE_COUNT] = { vk::ShaderStageFlagBits::eVertex, vk::ShaderStageFlagBits::eFragment };
-
     for (uint32_t i = 0; i < OBJECT_SHADER_STAGE_COUNT; ++i)
     {
-        if (!Stages[i].Create(Context, BUILTIN_SHADER_NAME_OBJECT, StageTypeStrs[i], StageTypes[i]))
+        if (!Stages[i].Create(Context, BUILTIN_SHADER_NAME_OBJECT, ObjectShaderStageTypeStrs[i], ObjectShaderStageTypes[i]))
         {
-            MlokError("Unable to create %s shader module for '%s'", StageTypeStrs[i].c_str(), BUILTIN_SHADER_NAME_OBJECT);
+            MlokError("Unable to create %s shader module for '%s'", ObjectShaderStageTypeStrs[i], BUILTIN_SHADER_NAME_OBJECT);
             return false;
         }
     }
@@ -236,6 +283,11 @@ bool VulkanObjectShader::Create(VulkanContext* inContext)
 
 void VulkanObjectShader::Destroy()
 {
+    if (!Context)
+    {
+        return;
+    }
+
     GlobalUniformBuffer.Destroy();
 
     Pipeline.Destroy();
@@ -248,6 +300,9 @@ void VulkanObjectShader::Destroy()
     {
         Stage.Destroy();
     }
+
+    // The destructor calls Destroy again
+    Context = nullptr;
 }
 
 void VulkanObjectShader::Use()
@@ -263,6 +318,7 @@ void VulkanObjectShader::UpdateGlobalState()
     auto GlobalDescriptor = GlobalDescriptorSets[ImageIndex];
 
     CommandBuffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics, Pipeline.GetLayout(), 0, 1, &GlobalDescriptor, 0, nullptr);
+    RenderStats::Get()->Add(RenderCounter::RENDER_COUNTER_DESCRIPTOR_BINDS);
 
     const uint32_t Range = static_cast<uint32_t>(sizeof(GlobalUniformObject));
     const uint64_t Offset = 0;
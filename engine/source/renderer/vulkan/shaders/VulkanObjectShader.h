@@ -5,6 +5,8 @@
 #include "renderer/vulkan/VulkanBuffer.h"
 #include "renderer/RendererTypes.inl"
 
+#include "core/Task.h"
+
 #include <array>
 
 class VulkanContext;
@@ -21,6 +23,10 @@ class VulkanShaderStage
 
         vk::ShaderModule* Get() { return &Handle; }
 
+        // Only reads the SPIR-V file, can run before the device exists
+        bool LoadCode(const std::string& Name, const std::string& TypeStr);
+
+        // Uses the code from LoadCode if it was called, reads the file otherwise
         bool Create(VulkanContext* Context,
                     std::string Name,
                     std::string TypeStr,
@@ -34,6 +40,8 @@ class VulkanShaderStage
         VulkanContext* Context; // Cached pointer to backend context
 
         vk::ShaderModule Handle;
+
+        std::vector<char> Code; // TODO: custom allocator
 };
 
 class VulkanObjectShader
@@ -43,6 +51,9 @@ class VulkanObjectShader
         VulkanObjectShader(VulkanContext* inContext);
         ~VulkanObjectShader();
 
+        // Reads the SPIR-V of every stage on the I/O thread, Create must not run before the task is done
+        Task<bool> LoadStageCodeAsync();
+
         bool Create(VulkanContext* inContext);
         void Destroy();
 
@@ -53,7 +64,7 @@ class VulkanObjectShader
         GlobalUniformObject& GetGlobalUBO() { return GlobalUBO; };
 
     private:
-        VulkanContext* Context; // Cached pointer to backend context
+        VulkanContext* Context = nullptr; // Cached pointer to backend context, null until Create
 
         std::array<VulkanShaderStage, OBJECT_SHADER_STAGE_COUNT> Stages;
 